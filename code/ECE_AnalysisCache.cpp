@@ -0,0 +1,333 @@
+/*
+Author: Botao Huang
+Class: ECE6122 (A)
+Last Date Modified: 10/19/2026
+Description:
+Code for the persistent engine analysis cache
+Each slot is guarded by a sequence counter (odd while being written) so any
+number of processes can read the mapped table without taking a lock
+*/
+
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include "ECE_AnalysisCache.h"
+
+// Slots probed from the home slot before giving up
+const uint64_t CACHE_PROBE_LIMIT = 8;
+// File identification
+const char CACHE_MAGIC[8] = { 'E', 'C', 'E', 'A', 'C', 'A', 'C', '1' };
+const uint32_t CACHE_VERSION = 1;
+
+// Every process holds a shared lock on this header byte while the cache is open
+const uint64_t CACHE_LOCK_OFFSET = 63;
+// Data word of a slot cleared after a torn write (key 0): skipped by the probe
+// sequence instead of ending it, and reusable by store
+const uint64_t CACHE_TOMBSTONE = ~0ULL;
+
+// File header (first 64 bytes of the file)
+struct ECE_AnalysisCache::FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t slotSize;
+    uint64_t slotCount;
+    uint32_t inUse;         // Set while opened, cleared by the last process to close
+    uint8_t reserved[36];
+};
+
+// Hash table slot, the atomics are lock free and address free so they work
+// across processes sharing the mapping
+struct ECE_AnalysisCache::Slot {
+    std::atomic<uint32_t> sequence;
+    uint32_t reserved;
+    std::atomic<uint64_t> key;
+    std::atomic<uint64_t> data;
+};
+
+namespace {
+    // Pack an entry into the slot data word
+    uint64_t encodeEntry(const AnalysisEntry& entry) {
+        return static_cast<uint64_t>(entry.move) |
+            (static_cast<uint64_t>(static_cast<uint16_t>(entry.score)) << 16) |
+            (static_cast<uint64_t>(entry.depth) << 32) |
+            (static_cast<uint64_t>(entry.flags) << 40);
+    }
+
+    // Unpack the slot data word
+    AnalysisEntry decodeEntry(uint64_t data) {
+        AnalysisEntry entry;
+        entry.move = static_cast<uint16_t>(data & 0xFFFF);
+        entry.score = static_cast<int16_t>((data >> 16) & 0xFFFF);
+        entry.depth = static_cast<uint8_t>((data >> 32) & 0xFF);
+        entry.flags = static_cast<uint8_t>((data >> 40) & 0xFF);
+        return entry;
+    }
+
+    // Key 0 marks an empty slot
+    uint64_t storedKey(uint64_t key) {
+        return key == 0 ? 1 : key;
+    }
+}
+
+// Constructor function
+ECE_AnalysisCache::ECE_AnalysisCache() : header(NULL), slots(NULL), slotMask(0),
+    lookups(0), hits(0), probes(0), probeHits(0), stores(0), lookupNanos(0), maxLookupNanos(0) {
+}
+
+// Destructor function
+ECE_AnalysisCache::~ECE_AnalysisCache() {
+    close();
+}
+
+// Open or create the cache file with the given number of slots (power of two)
+bool ECE_AnalysisCache::open(const std::string& path, uint64_t slotCount) {
+    close();
+
+    if (slotCount == 0 || (slotCount & (slotCount - 1)) != 0) {
+        std::cerr << "Analysis cache size must be a power of two" << std::endl;
+        return false;
+    }
+
+    // Map the header alone first, an existing cache keeps the size it was created with
+    if (!file.openReadWrite(path, sizeof(FileHeader))) {
+        return false;
+    }
+    header = reinterpret_cast<FileHeader*>(file.data());
+    bool created = std::memcmp(header->magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0;
+    if (!created) {
+        uint64_t existingCount = header->slotCount;
+        if (header->version != CACHE_VERSION || header->slotSize != sizeof(Slot) ||
+            existingCount == 0 || (existingCount & (existingCount - 1)) != 0 ||
+            file.size() < sizeof(FileHeader) + existingCount * sizeof(Slot)) {
+            std::cerr << "Analysis cache " << path << " has an incompatible layout" << std::endl;
+            close();
+            return false;
+        }
+        slotCount = existingCount;
+    }
+
+    // Only a new cache grows the file to hold its slots
+    if (created) {
+        file.close();
+        if (!file.openReadWrite(path, sizeof(FileHeader) + slotCount * sizeof(Slot))) {
+            header = NULL;
+            return false;
+        }
+        header = reinterpret_cast<FileHeader*>(file.data());
+        // Fresh file, the mapping is zero filled so every slot is already empty
+        header->version = CACHE_VERSION;
+        header->slotSize = sizeof(Slot);
+        header->slotCount = slotCount;
+        std::memcpy(header->magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    }
+
+    slots = reinterpret_cast<Slot*>(file.data() + sizeof(FileHeader));
+    slotMask = slotCount - 1;
+
+    // Alone with the file: no writer can be mid store. Slots can only be torn if
+    // the last process using the cache died without closing it
+    if (file.lockRange(CACHE_LOCK_OFFSET, 1, true, false)) {
+        if (header->inUse != 0) {
+            uint64_t reclaimed = reclaimTornSlots();
+            if (reclaimed > 0) {
+                std::cerr << "Analysis cache: cleared " << reclaimed << " slots left mid write" << std::endl;
+            }
+        }
+        header->inUse = 1;
+        file.unlockRange(CACHE_LOCK_OFFSET, 1);
+    }
+    file.lockRange(CACHE_LOCK_OFFSET, 1, false, true);
+    return true;
+}
+
+// Clear slots left mid write by a process that died (only while no other process has the file open)
+uint64_t ECE_AnalysisCache::reclaimTornSlots() {
+    uint64_t reclaimed = 0;
+    for (uint64_t i = 0; i <= slotMask; ++i) {
+        Slot& slot = slots[i];
+        uint32_t sequence = slot.sequence.load(std::memory_order_relaxed);
+        if ((sequence & 1) == 0) {
+            continue;
+        }
+        // Stores skipped the slot while it was odd, so entries further along
+        // its probe sequences must stay reachable: leave a tombstone, not a gap
+        slot.key.store(0, std::memory_order_relaxed);
+        slot.data.store(CACHE_TOMBSTONE, std::memory_order_relaxed);
+        slot.sequence.store(sequence + 1, std::memory_order_release);
+        reclaimed++;
+    }
+    return reclaimed;
+}
+
+// Unmap the cache
+void ECE_AnalysisCache::close() {
+    if (slots != NULL) {
+        file.flush();
+        file.unlockRange(CACHE_LOCK_OFFSET, 1);
+        // Last process out: every store finished, the next open need not look for torn slots
+        if (file.lockRange(CACHE_LOCK_OFFSET, 1, true, false)) {
+            header->inUse = 0;
+            file.flush();
+        }
+    }
+    file.close();
+    header = NULL;
+    slots = NULL;
+    slotMask = 0;
+}
+
+// Read a slot consistently, false if it was being written
+bool ECE_AnalysisCache::readSlot(const Slot& slot, uint64_t& key, uint64_t& data) const {
+    uint32_t before = slot.sequence.load(std::memory_order_acquire);
+    if (before & 1) {
+        return false;
+    }
+    key = slot.key.load(std::memory_order_relaxed);
+    data = slot.data.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slot.sequence.load(std::memory_order_relaxed) == before;
+}
+
+// Find a verdict for the key, searched to at least minDepth
+bool ECE_AnalysisCache::lookup(uint64_t key, int minDepth, AnalysisEntry& entry) {
+    if (slots == NULL) {
+        return false;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    bool found = find(key, minDepth, entry);
+
+    uint64_t nanos = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count());
+    lookups.fetch_add(1, std::memory_order_relaxed);
+    lookupNanos.fetch_add(nanos, std::memory_order_relaxed);
+    uint64_t currentMax = maxLookupNanos.load(std::memory_order_relaxed);
+    while (nanos > currentMax && !maxLookupNanos.compare_exchange_weak(currentMax, nanos)) {
+    }
+    if (found) {
+        hits.fetch_add(1, std::memory_order_relaxed);
+    }
+    return found;
+}
+
+// Same, for hints that do not replace a search (counted apart from lookups)
+bool ECE_AnalysisCache::lookupHint(uint64_t key, int minDepth, AnalysisEntry& entry) {
+    if (slots == NULL) {
+        return false;
+    }
+
+    bool found = find(key, minDepth, entry);
+    probes.fetch_add(1, std::memory_order_relaxed);
+    if (found) {
+        probeHits.fetch_add(1, std::memory_order_relaxed);
+    }
+    return found;
+}
+
+// Probe sequence search shared by lookup and lookupHint
+bool ECE_AnalysisCache::find(uint64_t key, int minDepth, AnalysisEntry& entry) const {
+    key = storedKey(key);
+    for (uint64_t probe = 0; probe < CACHE_PROBE_LIMIT; ++probe) {
+        const Slot& slot = slots[(key + probe) & slotMask];
+        uint64_t slotKey, data;
+
+        // Retry a few times if a writer is active on this slot
+        bool consistent = false;
+        for (int attempt = 0; attempt < 4 && !consistent; ++attempt) {
+            consistent = readSlot(slot, slotKey, data);
+        }
+        if (!consistent) {
+            continue;
+        }
+        if (slotKey == 0) {
+            if (data == CACHE_TOMBSTONE) {
+                continue;
+            }
+            return false; // Empty slot ends the probe sequence
+        }
+        if (slotKey == key) {
+            entry = decodeEntry(data);
+            return entry.depth >= minDepth;
+        }
+    }
+    return false;
+}
+
+// Store a verdict (keeps the deeper result if the key is already present)
+void ECE_AnalysisCache::store(uint64_t key, const AnalysisEntry& entry) {
+    if (slots == NULL) {
+        return;
+    }
+
+    key = storedKey(key);
+    Slot* target = NULL;
+    int targetDepth = 256;
+
+    // Same key first, then a cleared or the first empty slot, otherwise replace the shallowest entry
+    for (uint64_t probe = 0; probe < CACHE_PROBE_LIMIT; ++probe) {
+        Slot& slot = slots[(key + probe) & slotMask];
+        uint64_t slotKey, data;
+        if (!readSlot(slot, slotKey, data)) {
+            continue;
+        }
+        if (slotKey == key) {
+            if (decodeEntry(data).depth > entry.depth) {
+                return;
+            }
+            target = &slot;
+            break;
+        }
+        if (slotKey == 0 && data == CACHE_TOMBSTONE) {
+            // Reusable, but the key may still be further along
+            if (targetDepth >= 0) {
+                target = &slot;
+                targetDepth = -1;
+            }
+            continue;
+        }
+        if (slotKey == 0) {
+            if (targetDepth >= 0) {
+                target = &slot;
+            }
+            break;
+        }
+        int depth = decodeEntry(data).depth;
+        if (depth < targetDepth) {
+            target = &slot;
+            targetDepth = depth;
+        }
+    }
+    if (target == NULL) {
+        return;
+    }
+
+    // Claim the slot by making the sequence odd, another writer wins ties
+    uint32_t sequence = target->sequence.load(std::memory_order_relaxed);
+    if ((sequence & 1) || !target->sequence.compare_exchange_strong(sequence, sequence + 1, std::memory_order_acq_rel)) {
+        return;
+    }
+    target->key.store(key, std::memory_order_relaxed);
+    target->data.store(encodeEntry(entry), std::memory_order_relaxed);
+    target->sequence.store(sequence + 2, std::memory_order_release);
+
+    stores.fetch_add(1, std::memory_order_relaxed);
+}
+
+// Print hit rate and lookup latency
+void ECE_AnalysisCache::printStats(std::ostream& os) const {
+    uint64_t lookupCount = lookups.load();
+    uint64_t hitCount = hits.load();
+    double hitRate = lookupCount ? 100.0 * hitCount / lookupCount : 0.0;
+    double averageNanos = lookupCount ? static_cast<double>(lookupNanos.load()) / lookupCount : 0.0;
+    std::ios::fmtflags savedFlags = os.flags();
+    std::streamsize savedPrecision = os.precision();
+
+    os << "Analysis cache: " << lookupCount << " lookups, " << hitCount << " hits ("
+        << std::fixed << std::setprecision(1) << hitRate << "%), "
+        << stores.load() << " stores\n"
+        << "Hint probes: " << probes.load() << ", " << probeHits.load() << " hits\n"
+        << "Lookup latency: avg " << std::setprecision(0) << averageNanos << " ns, max "
+        << maxLookupNanos.load() << " ns" << std::endl;
+    os.flags(savedFlags);
+    os.precision(savedPrecision);
+}
@@ -0,0 +1,77 @@
+/*
+Author: Botao Huang
+Class: ECE6122 (A)
+Last Date Modified: 10/19/2026
+Description:
+Header file for the persistent engine analysis cache
+Memory mapped open addressing hash table keyed by position hash
+*/
+
+#ifndef ECE_ANALYSISCACHE_H
+#define ECE_ANALYSISCACHE_H
+
+#include <atomic>
+#include <string>
+#include <iostream>
+#include <cstdint>
+#include "ECE_MappedFile.h"
+
+// One cached engine verdict
+struct AnalysisEntry {
+    uint16_t move;    // Packed best move (chessPosition::packUciMove)
+    int16_t score;    // Centipawns (or mate distance) from the side to move
+    uint8_t depth;    // Search depth the verdict came from
+    uint8_t flags;    // ANALYSIS_FLAG_* bits
+};
+
+const uint8_t ANALYSIS_FLAG_MATE = 1;
+
+class ECE_AnalysisCache {
+private:
+    struct FileHeader;
+    struct Slot;
+
+    ECE_MappedFile file;
+    FileHeader* header;
+    Slot* slots;
+    uint64_t slotMask;
+
+    // Per process statistics
+    std::atomic<uint64_t> lookups;
+    std::atomic<uint64_t> hits;
+    std::atomic<uint64_t> probes;       // Hints (not counted as lookups)
+    std::atomic<uint64_t> probeHits;
+    std::atomic<uint64_t> stores;
+    std::atomic<uint64_t> lookupNanos;
+    std::atomic<uint64_t> maxLookupNanos;
+
+public:
+    ECE_AnalysisCache();
+    ~ECE_AnalysisCache();
+
+    // Open or create the cache file with the given number of slots (power of two)
+    bool open(const std::string& path, uint64_t slotCount);
+    void close();
+    bool isOpen() const { return slots != NULL; }
+
+    // Find a verdict for the key, searched to at least minDepth
+    bool lookup(uint64_t key, int minDepth, AnalysisEntry& entry);
+    // Same, for hints that do not replace a search (counted apart from lookups)
+    bool lookupHint(uint64_t key, int minDepth, AnalysisEntry& entry);
+    // Store a verdict (keeps the deeper result if the key is already present)
+    void store(uint64_t key, const AnalysisEntry& entry);
+
+    // Print hit rate and lookup latency
+    void printStats(std::ostream& os) const;
+
+private:
+    // Read a slot consistently, false if it was being written
+    bool readSlot(const Slot& slot, uint64_t& key, uint64_t& data) const;
+    // Probe sequence search shared by lookup and lookupHint
+    bool find(uint64_t key, int minDepth, AnalysisEntry& entry) const;
+    // Clear slots left mid write by a process that died (odd sequence), only
+    // while no other process has the file open
+    uint64_t reclaimTornSlots();
+};
+
+#endif
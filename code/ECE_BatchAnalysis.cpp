@@ -0,0 +1,324 @@
+/*
+Author: Botao Huang
+Class: ECE6122 (A)
+Last Date Modified: 10/19/2026
+Description:
+Headless batch analysis of EPD/FEN files
+Streams positions to a pool of engines and writes the verdicts in input
+order (CSV or binary), with a bounded number of positions in flight
+*/
+
+#include <string>
+#include <vector>
+#include <map>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+#include "ECE_EnginePool.h"
+#include "chessEpd.h"
+#include "chessPosition.h"
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#endif
+
+// Seconds between progress reports
+const int PROGRESS_PERIOD_SECONDS = 10;
+// Binary output identification
+const char BATCH_MAGIC[8] = { 'E', 'C', 'E', 'B', 'A', 'T', 'C', 'H' };
+const uint32_t BATCH_VERSION = 1;
+// Binary record flags
+const uint8_t BATCH_FLAG_MATE = 1;
+const uint8_t BATCH_FLAG_ERROR = 2;
+const uint8_t BATCH_FLAG_PREEMPTED = 4;
+
+// Command line settings
+struct BatchOptions {
+    std::string enginePath = "komodo.exe";
+    int engineCount = 0;              // 0: one per hardware thread
+    std::string inputPath = "-";
+    std::string outputPath = "-";
+    bool binary = false;
+    std::string limitKind = "depth";  // depth, nodes or movetime
+    uint64_t limitValue = 7;
+    size_t window = 0;                // positions in flight, 0: 4 per engine
+    int hashMb = 16;
+};
+
+// One finished position waiting for its turn in the output
+struct BatchResult {
+    std::string id;
+    std::string error;
+    AnalysisJobResult job;
+};
+
+// Print usage
+void printUsage() {
+    std::cerr << "Usage: ECE_BatchAnalysis --input positions.epd [--output results.csv] [--binary]\n"
+        << "       [--engine path] [--engines N] [--depth D | --nodes N | --movetime MS]\n"
+        << "       [--window N] [--hash MB]\n"
+        << "EPD operations acn (nodes) and acs (seconds) override the limit per position" << std::endl;
+}
+
+// Parse the command line
+bool parseOptions(int argc, char* argv[], BatchOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string option = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (option == "--input" && hasValue) options.inputPath = argv[++i];
+        else if (option == "--output" && hasValue) options.outputPath = argv[++i];
+        else if (option == "--binary") options.binary = true;
+        else if (option == "--engine" && hasValue) options.enginePath = argv[++i];
+        else if (option == "--engines" && hasValue) options.engineCount = std::atoi(argv[++i]);
+        else if ((option == "--depth" || option == "--nodes" || option == "--movetime") && hasValue) {
+            options.limitKind = option.substr(2);
+            options.limitValue = std::strtoull(argv[++i], NULL, 10);
+        }
+        else if (option == "--window" && hasValue) options.window = std::strtoul(argv[++i], NULL, 10);
+        else if (option == "--hash" && hasValue) options.hashMb = std::atoi(argv[++i]);
+        else return false;
+    }
+    return true;
+}
+
+// Search limit for one position (EPD acn/acs override the command line)
+std::string goCommandFor(const EpdRecord& record, const BatchOptions& options) {
+    std::string nodes = record.operation("acn");
+    std::string seconds = record.operation("acs");
+    if (!nodes.empty()) {
+        return "go nodes " + nodes;
+    }
+    if (!seconds.empty()) {
+        return "go movetime " + std::to_string(std::atoi(seconds.c_str()) * 1000);
+    }
+    return "go " + options.limitKind + " " + std::to_string(options.limitValue);
+}
+
+// Quote a CSV field
+std::string csvField(const std::string& text) {
+    std::string quoted = "\"";
+    for (char c : text) {
+        if (c == '"') quoted += '"';
+        quoted += c;
+    }
+    return quoted + "\"";
+}
+
+// Write one CSV row
+void writeCsv(std::ostream& out, uint64_t index, const BatchResult& result) {
+    const EngineAnalysis& analysis = result.job.analysis;
+    out << index << ',' << csvField(result.id) << ',';
+    if (!result.error.empty()) {
+        out << ",,,,,,," << csvField(result.error) << '\n';
+        return;
+    }
+    out << analysis.bestMove << ',' << (analysis.isMate ? "mate" : "cp") << ',' << analysis.score << ','
+        << analysis.depth << ',' << analysis.nodes << ',' << analysis.timeMs << ','
+        << analysis.pv << ",\n";
+}
+
+// Write one binary record (host byte order)
+void writeBinary(std::ostream& out, uint64_t index, const BatchResult& result) {
+    const EngineAnalysis& analysis = result.job.analysis;
+    uint8_t flags = 0;
+    if (analysis.isMate) flags |= BATCH_FLAG_MATE;
+    if (!result.error.empty()) flags |= BATCH_FLAG_ERROR;
+    if (result.job.preempted) flags |= BATCH_FLAG_PREEMPTED;
+
+    std::vector<uint16_t> pv;
+    std::istringstream pvStream(analysis.pv);
+    std::string move;
+    while (pvStream >> move && pv.size() < 0xFFFF) {
+        pv.push_back(chessPosition::packUciMove(move));
+    }
+
+    uint16_t bestMove = chessPosition::packUciMove(analysis.bestMove);
+    int32_t score = analysis.score;
+    uint8_t depth = static_cast<uint8_t>(analysis.depth > 255 ? 255 : analysis.depth);
+    uint32_t timeMs = static_cast<uint32_t>(analysis.timeMs);
+    uint64_t nodes = analysis.nodes;
+    uint16_t pvCount = static_cast<uint16_t>(pv.size());
+
+    out.write(reinterpret_cast<const char*>(&index), sizeof(index));
+    out.write(reinterpret_cast<const char*>(&bestMove), sizeof(bestMove));
+    out.write(reinterpret_cast<const char*>(&flags), sizeof(flags));
+    out.write(reinterpret_cast<const char*>(&depth), sizeof(depth));
+    out.write(reinterpret_cast<const char*>(&score), sizeof(score));
+    out.write(reinterpret_cast<const char*>(&timeMs), sizeof(timeMs));
+    out.write(reinterpret_cast<const char*>(&nodes), sizeof(nodes));
+    out.write(reinterpret_cast<const char*>(&pvCount), sizeof(pvCount));
+    if (pvCount > 0) {
+        out.write(reinterpret_cast<const char*>(&pv[0]), pvCount * sizeof(uint16_t));
+    }
+}
+
+// Main Entry Point
+int main(int argc, char* argv[])
+{
+    BatchOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage();
+        return -1;
+    }
+    if (options.engineCount <= 0) {
+        options.engineCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    if (options.window == 0) {
+        options.window = 4 * static_cast<size_t>(options.engineCount);
+    }
+
+    // Input and output streams
+    std::ifstream inputFile;
+    if (options.inputPath != "-") {
+        inputFile.open(options.inputPath);
+        if (!inputFile) {
+            std::cerr << "Cannot open " << options.inputPath << std::endl;
+            return -1;
+        }
+    }
+    std::istream& input = (options.inputPath == "-") ? std::cin : inputFile;
+
+    std::ofstream outputFile;
+    if (options.outputPath != "-") {
+        outputFile.open(options.outputPath, options.binary ? std::ios::binary : std::ios::out);
+        if (!outputFile) {
+            std::cerr << "Cannot create " << options.outputPath << std::endl;
+            return -1;
+        }
+    }
+    std::ostream& output = (options.outputPath == "-") ? std::cout : outputFile;
+#ifdef _WIN32
+    if (options.binary && options.outputPath == "-") {
+        // No "\r\n" translation, records are read back byte for byte
+        std::cout.flush();
+        _setmode(_fileno(stdout), _O_BINARY);
+    }
+#endif
+
+    if (options.binary) {
+        output.write(BATCH_MAGIC, sizeof(BATCH_MAGIC));
+        output.write(reinterpret_cast<const char*>(&BATCH_VERSION), sizeof(BATCH_VERSION));
+    }
+    else {
+        output << "index,id,bestmove,score_type,score,depth,nodes,time_ms,pv,error\n";
+    }
+
+    // One single threaded engine per core keeps every core busy
+    std::vector<std::pair<std::string, std::string>> engineOptions;
+    engineOptions.push_back(std::make_pair("Threads", "1"));
+    engineOptions.push_back(std::make_pair("Hash", std::to_string(options.hashMb)));
+    ECE_EnginePool pool;
+    if (!pool.start(options.enginePath, options.engineCount, engineOptions)) {
+        return -1;
+    }
+    std::cerr << "Analysing with " << options.engineCount << " engines, window " << options.window << std::endl;
+
+    // Reorder buffer shared by the reader, the engine callbacks and the writer
+    std::mutex bufferMutex;
+    std::condition_variable resultReady;
+    std::condition_variable slotFree;
+    std::map<uint64_t, BatchResult> finished;
+    uint64_t nextToWrite = 0;
+    uint64_t totalRead = 0;
+    bool inputDone = false;
+
+    auto startTime = std::chrono::steady_clock::now();
+
+    // Writer: emits results strictly in input order
+    std::thread writer([&]() {
+        auto lastReport = std::chrono::steady_clock::now();
+        std::unique_lock<std::mutex> lock(bufferMutex);
+        while (true) {
+            resultReady.wait_for(lock, std::chrono::seconds(1), [&] {
+                return finished.count(nextToWrite) > 0 || (inputDone && nextToWrite == totalRead);
+            });
+
+            while (finished.count(nextToWrite) > 0) {
+                BatchResult result = std::move(finished[nextToWrite]);
+                finished.erase(nextToWrite);
+                uint64_t index = nextToWrite++;
+                lock.unlock();
+                if (options.binary) writeBinary(output, index, result);
+                else writeCsv(output, index, result);
+                lock.lock();
+                slotFree.notify_one();
+            }
+
+            auto now = std::chrono::steady_clock::now();
+            if (now - lastReport >= std::chrono::seconds(PROGRESS_PERIOD_SECONDS)) {
+                double hours = std::chrono::duration<double>(now - startTime).count() / 3600.0;
+                std::cerr << nextToWrite << " positions, " << static_cast<uint64_t>(nextToWrite / hours)
+                    << " positions/hour, " << pool.queueDepth() << " queued" << std::endl;
+                lastReport = now;
+            }
+
+            if (inputDone && nextToWrite == totalRead) {
+                return;
+            }
+        }
+    });
+
+    // Reader: streams the file, blocking while the window is full
+    std::string line;
+    uint64_t lineNumber = 0;
+    while (std::getline(input, line)) {
+        lineNumber++;
+        EpdRecord record;
+        std::string error;
+        bool valid = parseEpdLine(line, record, error);
+        if (!valid && error.empty()) {
+            continue; // Blank or comment line
+        }
+
+        std::unique_lock<std::mutex> lock(bufferMutex);
+        slotFree.wait(lock, [&] { return totalRead - nextToWrite < options.window; });
+        uint64_t index = totalRead++;
+
+        if (!valid) {
+            BatchResult& result = finished[index];
+            result.id = "line " + std::to_string(lineNumber);
+            result.error = error;
+            resultReady.notify_one();
+            continue;
+        }
+        lock.unlock();
+
+        AnalysisJob job;
+        job.positionCommand = "position fen " + record.fen;
+        job.goCommand = goCommandFor(record, options);
+        job.priority = PRIORITY_BACKGROUND;
+        std::string id = record.id(std::to_string(lineNumber));
+        job.onComplete = [&, index, id](const AnalysisJobResult& jobResult) {
+            std::lock_guard<std::mutex> guard(bufferMutex);
+            BatchResult& result = finished[index];
+            result.id = id;
+            result.job = jobResult;
+            if (!jobResult.completed) {
+                result.error = "engine failure";
+            }
+            resultReady.notify_one();
+        };
+        pool.submit(job);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(bufferMutex);
+        inputDone = true;
+    }
+    resultReady.notify_one();
+    writer.join();
+    output.flush();
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    std::cerr << totalRead << " positions in " << seconds << " s ("
+        << static_cast<uint64_t>(seconds > 0 ? totalRead * 3600.0 / seconds : 0) << " positions/hour)" << std::endl;
+    pool.printStats(std::cerr);
+    return 0;
+}
@@ -1,7 +1,7 @@
 /*
 Author: Botao Huang
 Class: ECE6122 (A)
-Last Date Modified: 12/3/2024
+Last Date Modified: 10/19/2026
 Description:
 Code for communication with Komodo chess engine
 */
@@ -10,57 +10,89 @@ Code for communication with Komodo chess engine
 #include <string>
 #include <iostream>
 #include <stdexcept>
+#include <sstream>
+#include <algorithm>
 #include "ECE_ChessEngine.h"
+#include "chessPosition.h"
 
 // Constructor function for Chess Engine
-ECE_ChessEngine::ECE_ChessEngine() : hInputWrite(NULL), hInputRead(NULL), hOutputWrite(NULL), hOutputRead(NULL) {
-    SECURITY_ATTRIBUTES sa = { sizeof(SECURITY_ATTRIBUTES), NULL, TRUE };
-    CreatePipe(&hOutputRead, &hOutputWrite, &sa, 0);
-    CreatePipe(&hInputRead, &hInputWrite, &sa, 0);
+ECE_ChessEngine::ECE_ChessEngine() : hInputWrite(NULL), hInputRead(NULL), hOutputWrite(NULL), hOutputRead(NULL),
+    searchDepth(7), analysisCache(NULL), pendingKey(0), pendingFlipped(false), pendingKeyValid(false),
+    cachedResponsePending(false) {
+    ZeroMemory(&engineProcess, sizeof(engineProcess));
 }
 
 // Destructor function for Chess Engine
 ECE_ChessEngine::~ECE_ChessEngine() {
+    quit();
     CloseHandle(hInputWrite);
     CloseHandle(hInputRead);
     CloseHandle(hOutputWrite);
     CloseHandle(hOutputRead);
-    TerminateProcess(engineProcess.hProcess, 0);
     CloseHandle(engineProcess.hProcess);
     CloseHandle(engineProcess.hThread);
 }
 
 // Initialize Chess Engine
-void ECE_ChessEngine::InitializeEngine() {
+bool ECE_ChessEngine::InitializeEngine(const std::string& enginePath) {
     // Create pipes for input and output
     SECURITY_ATTRIBUTES sa = { sizeof(SECURITY_ATTRIBUTES), NULL, TRUE };
     CreatePipe(&hOutputRead, &hOutputWrite, &sa, 0);
     CreatePipe(&hInputRead, &hInputWrite, &sa, 0);
+    // Our ends must not leak into this (or any other) engine process
+    SetHandleInformation(hOutputRead, HANDLE_FLAG_INHERIT, 0);
+    SetHandleInformation(hInputWrite, HANDLE_FLAG_INHERIT, 0);
 
-    // Start the Komodo engine
+    // Start the engine
     STARTUPINFO si = { sizeof(STARTUPINFO) };
-    PROCESS_INFORMATION pi;
     si.dwFlags = STARTF_USESTDHANDLES;
     si.hStdInput = hInputRead;
     si.hStdOutput = hOutputWrite;
     si.hStdError = hOutputWrite;
 
-    // Path to Komodo executable
-    std::string enginePath = "komodo.exe";
-    if (!CreateProcess(NULL, const_cast<char*>(enginePath.c_str()), NULL, NULL, TRUE, 0, NULL, NULL, &si, &pi)) {
+    // Command line may carry arguments after the executable path
+    std::string commandLine = enginePath;
+    if (!CreateProcess(NULL, &commandLine[0], NULL, NULL, TRUE, 0, NULL, NULL, &si, &engineProcess)) {
         std::cerr << "Failed to start engine" << std::endl;
-        return;
+        ZeroMemory(&engineProcess, sizeof(engineProcess));
+        return false;
     }
 
-    CloseHandle(pi.hProcess);
-    CloseHandle(pi.hThread);
+    // The child owns these ends now, closing ours lets reads fail when it exits
+    CloseHandle(hOutputWrite);
+    CloseHandle(hInputRead);
+    hOutputWrite = NULL;
+    hInputRead = NULL;
+    return true;
 }
 
 // Send move command to the engine
 bool ECE_ChessEngine::sendMove(const std::string& strMove) {
     try {
+        cachedResponsePending = false;
+        pendingKeyValid = false;
+
+        // Consult the analysis cache before spawning a search
+        if (analysisCache != NULL) {
+            chessPosition position;
+            if (position.setFromMoveList(strMove)) {
+                pendingKey = position.canonicalKey(pendingFlipped);
+                pendingKeyValid = true;
+
+                AnalysisEntry entry;
+                if (analysisCache->lookup(pendingKey, searchDepth, entry)) {
+                    cachedResponseMove = chessPosition::unpackMove(entry.move);
+                    if (pendingFlipped) {
+                        cachedResponseMove = chessPosition::flipUciMove(cachedResponseMove);
+                    }
+                    cachedResponsePending = true;
+                    return true;
+                }
+            }
+        }
+
         sendCommand("position startpos moves " + strMove);
-        sendCommand("go depth 7"); // Ask the engine to calculate the best move
+        sendCommand("go depth " + std::to_string(searchDepth)); // Ask the engine to calculate the best move
         return true;
     } catch (const std::exception& e) {
         std::cerr << "";
@@ -69,12 +101,13 @@ bool ECE_ChessEngine::sendMove(const std::string& strMove) {
 }
 
 // Read response with buffer to ensure data consistancy
-std::string ECE_ChessEngine::readResponseWithBuffer(HANDLE hOutputRead, std::string& residualBuffer) {
+std::string ECE_ChessEngine::readResponseWithBuffer(HANDLE /*hOutputRead*/, std::string& residualBuffer) {
     char buffer[4096];
     DWORD bytesRead;
     std::string output;
 
-    if (ReadFile(hOutputRead, buffer, sizeof(buffer) - 1, &bytesRead, NULL) && bytesRead > 0) {
+    bool gotData = readPipe(buffer, sizeof(buffer) - 1, bytesRead) && bytesRead > 0;
+    if (gotData) {
         buffer[bytesRead] = '\0';
         output = residualBuffer + std::string(buffer); // Append residual buffer
         residualBuffer.clear();
@@ -86,7 +119,12 @@ std::string ECE_ChessEngine::readResponseWithBuffer(HANDLE hOutputRead, std::str
 
     // Handle incomplete lines by splitting at the last newline
     size_t lastNewline = output.find_last_of('\n');
-    if (lastNewline != std::string::npos && lastNewline < output.size() - 1) {
+    if (gotData && lastNewline == std::string::npos) {
+        // No complete line yet (e.g. "bestm" of a split "bestmove"), wait for more
+        residualBuffer = output;
+        output.clear();
+    }
+    else if (lastNewline != std::string::npos && lastNewline < output.size() - 1) {
         residualBuffer = output.substr(lastNewline + 1); // Store incomplete part
         output = output.substr(0, lastNewline + 1);
     }
@@ -124,12 +162,22 @@ std::string ECE_ChessEngine::extractBestMove(const std::string& response) {
 // Get response from the engine
 bool ECE_ChessEngine::getResponseMove(std::string& strMove) {
     try {
+        // Answered from the analysis cache, no search was started
+        if (cachedResponsePending) {
+            cachedResponsePending = false;
+            strMove = cachedResponseMove;
+            std::cout << "Engine Response: " << strMove << " (cached)" << std::endl;
+            return true;
+        }
+
         std::string response;
         std::string residualBuffer;
         bool bestmoveFound = false;
+        EngineAnalysis analysis;
 
         while (true) {
             response = readResponseWithBuffer(hOutputRead, residualBuffer);
+            parseInfoLines(response, analysis);
 
             // Check for "Cannot execute move" in the response
             if (response.find("Cannot execute move") != std::string::npos) {
@@ -156,8 +204,19 @@ bool ECE_ChessEngine::getResponseMove(std::string& strMove) {
                     return false;
                 }
 
+                metrics.onBestMove();
                 std::cout << "Engine Response: " << strMove << std::endl;
                 bestmoveFound = true;
+
+                // Write the verdict back for the next time this position comes up
+                if (analysisCache != NULL && pendingKeyValid) {
+                    AnalysisEntry entry;
+                    entry.move = chessPosition::packUciMove(pendingFlipped ? chessPosition::flipUciMove(strMove) : strMove);
+                    entry.score = static_cast<int16_t>(std::max(-32000, std::min(32000, analysis.score)));
+                    entry.depth = static_cast<uint8_t>(std::min(255, analysis.depth > 0 ? analysis.depth : searchDepth));
+                    entry.flags = analysis.isMate ? ANALYSIS_FLAG_MATE : 0;
+                    analysisCache->store(pendingKey, entry);
+                }
                 break;
             }
 
@@ -179,9 +238,32 @@ bool ECE_ChessEngine::getResponseMove(std::string& strMove) {
 
 // Send command to the engine
 void ECE_ChessEngine::sendCommand(const std::string& command) {
-    DWORD written;
-    WriteFile(hInputWrite, command.c_str(), command.length(), &written, NULL);
-    WriteFile(hInputWrite, "\n", 1, &written, NULL);
+    // Command and newline in one WriteFile
+    std::string line = command + "\n";
+    std::lock_guard<std::mutex> lock(writeMutex);
+    int64_t start = ECE_EngineMetrics::nowNs();
+    DWORD written = 0;
+    WriteFile(hInputWrite, line.c_str(), static_cast<DWORD>(line.length()), &written, NULL);
+    metrics.onWrite(start, written, command.compare(0, 2, "go") == 0);
+}
+
+// ReadFile on the engine output pipe
+bool ECE_ChessEngine::readPipe(char* buffer, DWORD capacity, DWORD& count) {
+    count = 0;
+    int64_t start = ECE_EngineMetrics::nowNs();
+    bool ok = ReadFile(hOutputRead, buffer, capacity, &count, NULL) != FALSE;
+    metrics.onRead(start, count);
+    return ok;
+}
+
+// Pipe traffic so far
+EngineIoStats ECE_ChessEngine::getIoStats() const {
+    EngineIoStats stats;
+    stats.readCalls = metrics.readCalls.load(std::memory_order_relaxed);
+    stats.bytesRead = metrics.bytesRead.load(std::memory_order_relaxed);
+    stats.writeCalls = metrics.writeCalls.load(std::memory_order_relaxed);
+    stats.bytesWritten = metrics.bytesWritten.load(std::memory_order_relaxed);
+    return stats;
 }
 
 // Receive response from the engine
@@ -190,10 +272,198 @@ std::string ECE_ChessEngine::readResponse() {
     char buffer[4096];
     DWORD read;
     std::string output;
-    if (ReadFile(hOutputRead, buffer, sizeof(buffer) - 1, &read, NULL) && read > 0) {
+    if (readPipe(buffer, sizeof(buffer) - 1, read) && read > 0) {
         buffer[read] = '\0';
         output = buffer;
     }
     std::cout << "Leave readResponse" << std::endl;
     return output;
 }
+
+// Consult (and fill) a persistent analysis cache around each search
+void ECE_ChessEngine::attachAnalysisCache(ECE_AnalysisCache* cache) {
+    analysisCache = cache;
+}
+
+// Switch the engine to UCI mode (waits for "uciok")
+bool ECE_ChessEngine::startUci() {
+    sendCommand("uci");
+    std::string line;
+    while (readLine(line)) {
+        if (line.compare(0, 5, "uciok") == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Send "setoption name <name> value <value>"
+void ECE_ChessEngine::setOption(const std::string& name, const std::string& value) {
+    sendCommand("setoption name " + name + " value " + value);
+}
+
+// Send "isready" and wait for "readyok"
+bool ECE_ChessEngine::waitReady() {
+    sendCommand("isready");
+    std::string line;
+    while (readLine(line)) {
+        if (line.compare(0, 7, "readyok") == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Send "ucinewgame" and wait until the engine is ready again
+bool ECE_ChessEngine::newGame() {
+    sendCommand("ucinewgame");
+    return waitReady();
+}
+
+// Run one search and wait for bestmove
+bool ECE_ChessEngine::analysePosition(const std::string& positionCommand, const std::string& goCommand, EngineAnalysis& analysis,
+    const InfoCallback& onInfo) {
+    startSearch(positionCommand, goCommand);
+    return waitBestMove(analysis, onInfo);
+}
+
+// Wait for the bestmove of a search begun with startSearch
+bool ECE_ChessEngine::waitBestMove(EngineAnalysis& analysis, const InfoCallback& onInfo,
+    const std::function<void()>& onBestMove) {
+    analysis = EngineAnalysis();
+    std::string line;
+    while (readLine(line)) {
+        if (line.compare(0, 9, "bestmove ") == 0) {
+            if (onBestMove) {
+                onBestMove();
+            }
+            metrics.onBestMove();
+            std::istringstream tokens(line.substr(9));
+            std::string token;
+            tokens >> analysis.bestMove;
+            if (tokens >> token && token == "ponder") {
+                tokens >> analysis.ponderMove;
+            }
+            return analysis.bestMove.length() == 4 || analysis.bestMove.length() == 5;
+        }
+        parseInfoLine(line, analysis);
+        if (onInfo && line.compare(0, 5, "info ") == 0 && line.find(" pv ") != std::string::npos) {
+            onInfo(analysis);
+        }
+    }
+
+    std::cerr << "Error: Engine did not produce a valid response." << std::endl;
+    return false;
+}
+
+// Ask a running search to finish now
+void ECE_ChessEngine::stopSearch() {
+    sendCommand("stop");
+}
+
+// Whether the engine process is still alive
+bool ECE_ChessEngine::isRunning() const {
+    return engineProcess.hProcess != NULL && WaitForSingleObject(engineProcess.hProcess, 0) == WAIT_TIMEOUT;
+}
+
+// Start a search without waiting for it
+void ECE_ChessEngine::startSearch(const std::string& positionCommand, const std::string& goCommand) {
+    sendCommand(positionCommand);
+    sendCommand(goCommand);
+}
+
+// Raw engine output for a dedicated reader thread
+size_t ECE_ChessEngine::readOutput(char* buffer, size_t capacity) {
+    // Hand out whatever readLine had already buffered first
+    if (!lineBuffer.empty()) {
+        size_t count = std::min(capacity, lineBuffer.size());
+        lineBuffer.copy(buffer, count);
+        lineBuffer.erase(0, count);
+        return count;
+    }
+    DWORD count = 0;
+    if (!readPipe(buffer, static_cast<DWORD>(capacity), count)) {
+        return 0;
+    }
+    return count;
+}
+
+// Ask the engine to exit
+void ECE_ChessEngine::quit() {
+    if (isRunning()) {
+        sendCommand("quit");
+        if (WaitForSingleObject(engineProcess.hProcess, 500) != WAIT_OBJECT_0) {
+            TerminateProcess(engineProcess.hProcess, 0);
+        }
+    }
+}
+
+// Read one complete line of engine output
+bool ECE_ChessEngine::readLine(std::string& line) {
+    while (true) {
+        size_t newline = lineBuffer.find('\n');
+        if (newline != std::string::npos) {
+            line.assign(lineBuffer, 0, newline);
+            lineBuffer.erase(0, newline + 1);
+            if (!line.empty() && line.back() == '\r') {
+                line.pop_back();
+            }
+            return true;
+        }
+
+        char buffer[4096];
+        DWORD count = 0;
+        if (!readPipe(buffer, sizeof(buffer), count) || count == 0) {
+            return false;
+        }
+        lineBuffer.append(buffer, count);
+    }
+}
+
+// Track the latest depth/score/pv reported by an "info" line
+void ECE_ChessEngine::parseInfoLine(const std::string& line, EngineAnalysis& analysis) {
+    if (line.compare(0, 5, "info ") != 0) {
+        return;
+    }
+    int64_t parseStart = ECE_EngineMetrics::nowNs();
+    uint64_t lineNps = 0;
+
+    std::istringstream tokens(line);
+    std::string token;
+    while (tokens >> token) {
+        if (token == "depth") {
+            tokens >> analysis.depth;
+        }
+        else if (token == "score") {
+            std::string kind;
+            tokens >> kind >> analysis.score;
+            analysis.isMate = (kind == "mate");
+        }
+        else if (token == "nodes") {
+            tokens >> analysis.nodes;
+        }
+        else if (token == "time") {
+            tokens >> analysis.timeMs;
+        }
+        else if (token == "nps") {
+            tokens >> lineNps;
+            analysis.nps = lineNps;
+        }
+        else if (token == "pv") {
+            // The principal variation runs to the end of the line
+            std::getline(tokens, analysis.pv);
+            size_t first = analysis.pv.find_first_not_of(' ');
+            analysis.pv.erase(0, first == std::string::npos ? analysis.pv.size() : first);
+        }
+    }
+    metrics.onInfoLine(parseStart, lineNps);
+}
+
+// Same for every line of a response chunk
+void ECE_ChessEngine::parseInfoLines(const std::string& response, EngineAnalysis& analysis) {
+    std::istringstream lines(response);
+    std::string line;
+    while (std::getline(lines, line)) {
+        parseInfoLine(line, analysis);
+    }
+}
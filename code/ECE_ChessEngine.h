@@ -1,7 +1,7 @@
 /*
 Author: Botao Huang
 Class: ECE6122 (A)
-Last Date Modified: 12/3/2024
+Last Date Modified: 10/19/2026
 Description:
 Header files for ECE chess engine
 Interact with Komodo engine, and get response from it
@@ -14,6 +14,38 @@ Interact with Komodo engine, and get response from it
 #include <string>
 #include <iostream>
 #include <stdexcept>
+#include <cstdint>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include "ECE_AnalysisCache.h"
+#include "ECE_EngineMetrics.h"
+
+// Verdict parsed from the engine's "info" and "bestmove" lines
+struct EngineAnalysis {
+    std::string bestMove;
+    std::string ponderMove;
+    int depth;
+    int score;        // Centipawns, or moves to mate when isMate
+    bool isMate;
+    uint64_t nodes;
+    uint64_t nps;
+    int timeMs;
+    std::string pv;   // Principal variation (space separated UCI moves)
+
+    EngineAnalysis() : depth(0), score(0), isMate(false), nodes(0), nps(0), timeMs(0) {}
+};
+
+// Called with the running analysis after every "info ... pv" line
+typedef std::function<void(const EngineAnalysis&)> InfoCallback;
+
+// Pipe traffic counters (one ReadFile/WriteFile is one call)
+struct EngineIoStats {
+    uint64_t readCalls;
+    uint64_t bytesRead;
+    uint64_t writeCalls;
+    uint64_t bytesWritten;
+};
 
 class ECE_ChessEngine {
 private:
@@ -21,17 +53,70 @@ private:
     HANDLE hOutputWrite, hOutputRead;
     PROCESS_INFORMATION engineProcess;
 
+    // Search depth requested from the engine
+    int searchDepth;
+    // Optional persistent analysis cache (not owned)
+    ECE_AnalysisCache* analysisCache;
+    // Canonical key of the position sent by the last sendMove
+    uint64_t pendingKey;
+    bool pendingFlipped;
+    bool pendingKeyValid;
+    // Set when sendMove was answered from the cache
+    bool cachedResponsePending;
+    std::string cachedResponseMove;
+    // Serializes writes ("stop" may come from another thread)
+    std::mutex writeMutex;
+    // Partial line carried between reads by readLine
+    std::string lineBuffer;
+    // I/O timing and traffic of this engine session
+    ECE_EngineMetrics metrics;
+
 public:
     ECE_ChessEngine();
-    ~ECE_ChessEngine();
+    virtual ~ECE_ChessEngine();
 
     // Basic functions
     // Initialize the communication with engine
-    void InitializeEngine();
-    // Send move to the engine
-    bool sendMove(const std::string& strMove);
+    bool InitializeEngine(const std::string& enginePath = "komodo.exe");
+    // Send move to the engine (virtual: a replay answers from a session log)
+    virtual bool sendMove(const std::string& strMove);
     // Get response from the engine
-    bool getResponseMove(std::string& strMove);
+    virtual bool getResponseMove(std::string& strMove);
+    // Consult (and fill) a persistent analysis cache around each search
+    void attachAnalysisCache(ECE_AnalysisCache* cache);
+    // Depth of the searches started by sendMove
+    int getSearchDepth() const { return searchDepth; }
+
+    // Engine control
+    // Switch the engine to UCI mode (waits for "uciok")
+    bool startUci();
+    // Send "setoption name <name> value <value>"
+    void setOption(const std::string& name, const std::string& value);
+    // Send "isready" and wait for "readyok"
+    bool waitReady();
+    // Send "ucinewgame" and wait until the engine is ready again
+    bool newGame();
+    // Run one search ("position ..." then "go ...") and wait for bestmove
+    bool analysePosition(const std::string& positionCommand, const std::string& goCommand, EngineAnalysis& analysis,
+        const InfoCallback& onInfo = InfoCallback());
+    // Wait for the bestmove of a search begun with startSearch; onBestMove runs
+    // as soon as the bestmove line is read
+    bool waitBestMove(EngineAnalysis& analysis, const InfoCallback& onInfo = InfoCallback(),
+        const std::function<void()>& onBestMove = std::function<void()>());
+    // Ask a running search to finish now (safe from another thread)
+    void stopSearch();
+    // Whether the engine process is still alive
+    bool isRunning() const;
+    // Start a search without waiting for it (output is read with readOutput)
+    void startSearch(const std::string& positionCommand, const std::string& goCommand);
+    // Raw engine output for a dedicated reader thread, 0 when the pipe closed
+    size_t readOutput(char* buffer, size_t capacity);
+    // Ask the engine to exit (terminated if it does not within 500 ms)
+    void quit();
+    // Pipe traffic so far
+    EngineIoStats getIoStats() const;
+    // Latency histograms and counters of this session
+    ECE_EngineMetrics& getMetrics() { return metrics; }
 
     // Helper functions
     // Read response with buffer to ensure data consistancy
@@ -44,8 +129,16 @@ public:
 private:
     // Send command to the engine
     void sendCommand(const std::string& command);
+    // ReadFile on the engine output pipe, counted in the metrics
+    bool readPipe(char* buffer, DWORD capacity, DWORD& count);
     // Receive response from the engine
     std::string readResponse();
+    // Read one complete line of engine output, false when the pipe closed
+    bool readLine(std::string& line);
+    // Track the latest depth/score/pv reported by an "info" line
+    void parseInfoLine(const std::string& line, EngineAnalysis& analysis);
+    // Same for every line of a response chunk
+    void parseInfoLines(const std::string& response, EngineAnalysis& analysis);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,141 @@
+/*
+Author: Botao Huang
+Class: ECE6122 (A)
+Last Date Modified: 10/19/2026
+Description:
+Engine round-trip benchmark
+Drives ECE_ChessEngine (normally against ECE_MockEngine) and reports
+round-trip latency percentiles, bytes parsed per second and pipe calls per move
+*/
+
+#include <string>
+#include <vector>
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+#include "ECE_ChessEngine.h"
+
+// Command line settings
+struct BenchOptions {
+    std::string enginePath = "ECE_MockEngine --think 0 --info-burst 20";
+    int moves = 1000;
+    int warmup = 20;
+    int gameLength = 80;          // Plies before the game restarts
+    std::string goCommand = "go depth 1";
+    bool gamePath = false;        // sendMove/getResponseMove instead of analysePosition
+};
+
+// Print usage
+void printUsage() {
+    std::cerr << "Usage: ECE_EngineBench [--engine \"path args\"] [--moves N] [--warmup N]\n"
+        << "       [--game-length PLIES] [--go \"go depth 1\"] [--game-path]" << std::endl;
+}
+
+// Parse the command line
+bool parseOptions(int argc, char* argv[], BenchOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string option = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (option == "--engine" && hasValue) options.enginePath = argv[++i];
+        else if (option == "--moves" && hasValue) options.moves = std::atoi(argv[++i]);
+        else if (option == "--warmup" && hasValue) options.warmup = std::atoi(argv[++i]);
+        else if (option == "--game-length" && hasValue) options.gameLength = std::atoi(argv[++i]);
+        else if (option == "--go" && hasValue) options.goCommand = argv[++i];
+        else if (option == "--game-path") options.gamePath = true;
+        else return false;
+    }
+    return options.moves > 0 && options.gameLength > 0;
+}
+
+// One round trip: position plus search, returns the engine's move ("" on failure)
+std::string roundTrip(ECE_ChessEngine& engine, const BenchOptions& options, const std::string& history) {
+    std::string move;
+    if (options.gamePath) {
+        // The path the 3D view uses; its console logging is muted
+        std::streambuf* console = std::cout.rdbuf(NULL);
+        engine.sendMove(history);
+        bool ok = engine.getResponseMove(move);
+        std::cout.rdbuf(console);
+        std::cout.clear();
+        return ok ? move : "";
+    }
+    EngineAnalysis analysis;
+    std::string positionCommand = history.empty() ? "position startpos" : "position startpos moves " + history;
+    return engine.analysePosition(positionCommand, options.goCommand, analysis) ? analysis.bestMove : "";
+}
+
+// Latency percentile (sorted input)
+double percentile(const std::vector<double>& sorted, double fraction) {
+    size_t index = static_cast<size_t>(fraction * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+// Main Entry Point
+int main(int argc, char* argv[])
+{
+    BenchOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage();
+        return -1;
+    }
+
+    ECE_ChessEngine engine;
+    if (!engine.InitializeEngine(options.enginePath) || !engine.startUci() || !engine.waitReady()) {
+        std::cerr << "Cannot start " << options.enginePath << std::endl;
+        return -1;
+    }
+
+    std::vector<double> latenciesUs;
+    latenciesUs.reserve(options.moves);
+    std::string history;
+    int ply = 0;
+    EngineIoStats before = engine.getIoStats();
+    auto benchStart = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < options.warmup + options.moves; ++i) {
+        if (i == options.warmup) {
+            before = engine.getIoStats();
+            benchStart = std::chrono::steady_clock::now();
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        std::string move = roundTrip(engine, options, history);
+        auto end = std::chrono::steady_clock::now();
+        if (move.empty()) {
+            std::cerr << "Engine failed after " << i << " moves" << std::endl;
+            return -1;
+        }
+        if (i >= options.warmup) {
+            latenciesUs.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+        }
+
+        // Play the engine's move, start over at game end
+        if (move == "0000" || move == "(none)" || ++ply >= options.gameLength) {
+            history.clear();
+            ply = 0;
+        }
+        else {
+            history += (history.empty() ? "" : " ") + move;
+        }
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - benchStart).count();
+    EngineIoStats after = engine.getIoStats();
+    std::sort(latenciesUs.begin(), latenciesUs.end());
+    double moves = static_cast<double>(latenciesUs.size());
+    uint64_t bytesRead = after.bytesRead - before.bytesRead;
+
+    std::cout << std::fixed << std::setprecision(1)
+        << "Engine:      " << options.enginePath << (options.gamePath ? " (game path)" : "") << "\n"
+        << "Moves:       " << latenciesUs.size() << " in " << seconds << " s\n"
+        << "Round trip:  p50 " << percentile(latenciesUs, 0.50) << " us, p99 " << percentile(latenciesUs, 0.99)
+        << " us, max " << latenciesUs.back() << " us\n"
+        << "Parsed:      " << bytesRead / seconds / 1e6 << " MB/s (" << bytesRead / moves << " bytes/move)\n"
+        << "Pipe calls:  " << (after.readCalls - before.readCalls) / moves << " reads/move, "
+        << (after.writeCalls - before.writeCalls) / moves << " writes/move" << std::endl;
+    engine.getMetrics().print(std::cout);
+    return 0;
+}
@@ -0,0 +1,253 @@
+/*
+Author: Botao Huang
+Class: ECE6122 (A)
+Last Date Modified: 10/19/2026
+Description:
+Code for engine I/O metrics
+*/
+
+#include <fstream>
+#include <iomanip>
+#include <ctime>
+#include "ECE_EngineMetrics.h"
+
+namespace {
+    // Position of the highest set bit (value > 0)
+    int highestBit(uint64_t value) {
+        int bit = 0;
+        for (int step = 32; step > 0; step /= 2) {
+            if (value >> step) {
+                value >>= step;
+                bit += step;
+            }
+        }
+        return bit;
+    }
+
+    // Raise an atomic maximum
+    void updateMax(std::atomic<uint64_t>& maximum, uint64_t value) {
+        uint64_t current = maximum.load(std::memory_order_relaxed);
+        while (value > current && !maximum.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+        }
+    }
+}
+
+// Constructor function
+ECE_Histogram::ECE_Histogram() {
+    reset();
+}
+
+// Values below 16 get their own bucket, above that 16 buckets per power of 2
+int ECE_Histogram::bucketIndex(uint64_t value) {
+    if (value < SUB_BUCKETS) {
+        return static_cast<int>(value);
+    }
+    int shift = highestBit(value) - 4;
+    return (shift + 1) * SUB_BUCKETS + static_cast<int>((value >> shift) & (SUB_BUCKETS - 1));
+}
+
+// Highest value that falls into a bucket
+uint64_t ECE_Histogram::bucketHigh(int index) {
+    if (index < SUB_BUCKETS) {
+        return static_cast<uint64_t>(index);
+    }
+    int shift = index / SUB_BUCKETS - 1;
+    uint64_t sub = static_cast<uint64_t>(SUB_BUCKETS + index % SUB_BUCKETS);
+    return ((sub + 1) << shift) - 1;
+}
+
+void ECE_Histogram::record(uint64_t value) {
+    buckets[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+    count.fetch_add(1, std::memory_order_relaxed);
+    total.fetch_add(value, std::memory_order_relaxed);
+    updateMax(maxValue, value);
+}
+
+void ECE_Histogram::reset() {
+    for (int i = 0; i < BUCKET_COUNT; ++i) {
+        buckets[i].store(0, std::memory_order_relaxed);
+    }
+    count.store(0, std::memory_order_relaxed);
+    total.store(0, std::memory_order_relaxed);
+    maxValue.store(0, std::memory_order_relaxed);
+}
+
+double ECE_Histogram::getMean() const {
+    uint64_t samples = getCount();
+    return samples ? static_cast<double>(total.load(std::memory_order_relaxed)) / samples : 0.0;
+}
+
+// Value at or below which the given fraction of the samples lie
+uint64_t ECE_Histogram::percentile(double fraction) const {
+    uint64_t samples = getCount();
+    if (samples == 0) {
+        return 0;
+    }
+    uint64_t target = static_cast<uint64_t>(fraction * samples + 0.5);
+    target = target < 1 ? 1 : target;
+    uint64_t seen = 0;
+    for (int i = 0; i < BUCKET_COUNT; ++i) {
+        seen += buckets[i].load(std::memory_order_relaxed);
+        if (seen >= target) {
+            uint64_t high = bucketHigh(i);
+            return high < getMax() ? high : getMax();
+        }
+    }
+    return getMax();
+}
+
+// Constructor function
+ECE_EngineMetrics::ECE_EngineMetrics() {
+    reset();
+}
+
+int64_t ECE_EngineMetrics::nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(MetricsClock::now().time_since_epoch()).count();
+}
+
+// A command was written to the engine
+void ECE_EngineMetrics::onWrite(int64_t startNs, uint64_t bytes, bool isGo) {
+    int64_t end = nowNs();
+    writeUs.record(static_cast<uint64_t>((end - startNs) / 1000));
+    writeCalls.fetch_add(1, std::memory_order_relaxed);
+    bytesWritten.fetch_add(bytes, std::memory_order_relaxed);
+    if (isGo) {
+        searchStartNs.store(end, std::memory_order_relaxed);
+        lastInfoNs.store(0, std::memory_order_relaxed);
+        awaitingFirstByte.store(true, std::memory_order_release);
+    }
+}
+
+// A ReadFile call returned
+void ECE_EngineMetrics::onRead(int64_t startNs, uint64_t bytes) {
+    int64_t end = nowNs();
+    readUs.record(static_cast<uint64_t>((end - startNs) / 1000));
+    readCalls.fetch_add(1, std::memory_order_relaxed);
+    bytesRead.fetch_add(bytes, std::memory_order_relaxed);
+    if (bytes > 0 && awaitingFirstByte.exchange(false, std::memory_order_acq_rel)) {
+        firstByteUs.record(static_cast<uint64_t>((end - searchStartNs.load(std::memory_order_relaxed)) / 1000));
+    }
+}
+
+// An info line was parsed (startNs: when parsing began)
+void ECE_EngineMetrics::onInfoLine(int64_t startNs, uint64_t nps) {
+    int64_t end = nowNs();
+    parseNs.record(static_cast<uint64_t>(end - startNs));
+    infoLines.fetch_add(1, std::memory_order_relaxed);
+    int64_t previous = lastInfoNs.exchange(startNs, std::memory_order_relaxed);
+    if (previous != 0) {
+        infoGapUs.record(static_cast<uint64_t>((startNs - previous) / 1000));
+    }
+    if (nps > 0) {
+        lastNps.store(nps, std::memory_order_relaxed);
+        updateMax(maxNps, nps);
+    }
+}
+
+// The search finished with a bestmove
+void ECE_EngineMetrics::onBestMove() {
+    int64_t start = searchStartNs.exchange(0, std::memory_order_relaxed);
+    if (start != 0) {
+        bestMoveUs.record(static_cast<uint64_t>((nowNs() - start) / 1000));
+        searches.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void ECE_EngineMetrics::reset() {
+    writeUs.reset();
+    readUs.reset();
+    firstByteUs.reset();
+    infoGapUs.reset();
+    bestMoveUs.reset();
+    parseNs.reset();
+    bytesRead.store(0);
+    readCalls.store(0);
+    bytesWritten.store(0);
+    writeCalls.store(0);
+    infoLines.store(0);
+    searches.store(0);
+    lastNps.store(0);
+    maxNps.store(0);
+    searchStartNs.store(0);
+    lastInfoNs.store(0);
+    awaitingFirstByte.store(false);
+}
+
+// Print counters and histogram percentiles
+void ECE_EngineMetrics::print(std::ostream& os) const {
+    std::ios::fmtflags savedFlags = os.flags();
+    struct Row { const char* name; const ECE_Histogram* histogram; const char* unit; };
+    const Row rows[] = {
+        { "write", &writeUs, "us" }, { "read call", &readUs, "us" }, { "first byte", &firstByteUs, "us" },
+        { "info gap", &infoGapUs, "us" }, { "bestmove", &bestMoveUs, "us" }, { "parse line", &parseNs, "ns" } };
+
+    uint64_t searchCount = searches.load(std::memory_order_relaxed);
+    uint64_t reads = readCalls.load(std::memory_order_relaxed);
+    os << "Engine metrics: " << searchCount << " searches, " << infoLines.load(std::memory_order_relaxed)
+        << " info lines, " << bytesRead.load(std::memory_order_relaxed) << " bytes in " << reads << " reads, "
+        << bytesWritten.load(std::memory_order_relaxed) << " bytes in " << writeCalls.load(std::memory_order_relaxed)
+        << " writes\n"
+        << "  engine nps: last " << lastNps.load(std::memory_order_relaxed) << ", max " << maxNps.load(std::memory_order_relaxed);
+    if (searchCount > 0) {
+        os << ", reads per search " << std::fixed << std::setprecision(1) << static_cast<double>(reads) / searchCount;
+    }
+    os << "\n  " << std::left << std::setw(12) << "" << std::right << std::setw(10) << "count" << std::setw(10) << "mean"
+        << std::setw(10) << "p50" << std::setw(10) << "p90" << std::setw(10) << "p99" << std::setw(12) << "max" << '\n';
+    for (const Row& row : rows) {
+        const ECE_Histogram& h = *row.histogram;
+        os << "  " << std::left << std::setw(12) << (std::string(row.name) + " " + row.unit) << std::right
+            << std::setw(10) << h.getCount() << std::setw(10) << std::fixed << std::setprecision(0) << h.getMean()
+            << std::setw(10) << h.percentile(0.50) << std::setw(10) << h.percentile(0.90)
+            << std::setw(10) << h.percentile(0.99) << std::setw(12) << h.getMax() << '\n';
+    }
+    os.flush();
+    os.flags(savedFlags);
+}
+
+// Constructor function
+ECE_MetricsDumper::ECE_MetricsDumper() : metrics(NULL), periodSeconds(0), stopping(false) {
+}
+
+// Destructor function
+ECE_MetricsDumper::~ECE_MetricsDumper() {
+    stop();
+}
+
+// Start appending reports to path every periodSeconds
+bool ECE_MetricsDumper::start(const ECE_EngineMetrics* source, const std::string& file, int seconds) {
+    if (thread.joinable() || source == NULL || seconds <= 0) {
+        return false;
+    }
+    metrics = source;
+    path = file;
+    periodSeconds = seconds;
+    stopping = false;
+    thread = std::thread(&ECE_MetricsDumper::dumpLoop, this);
+    return true;
+}
+
+void ECE_MetricsDumper::stop() {
+    {
+        std::lock_guard<std::mutex> lock(stopMutex);
+        stopping = true;
+    }
+    stopWake.notify_all();
+    if (thread.joinable()) {
+        thread.join();
+    }
+}
+
+void ECE_MetricsDumper::dumpLoop() {
+    std::unique_lock<std::mutex> lock(stopMutex);
+    while (!stopWake.wait_for(lock, std::chrono::seconds(periodSeconds), [this] { return stopping; })) {
+        std::ofstream out(path, std::ios::app);
+        if (!out) {
+            continue;
+        }
+        char stamp[32];
+        std::time_t now = std::time(NULL);
+        std::strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M:%S", std::localtime(&now));
+        out << "# " << stamp << '\n';
+        metrics->print(out);
+    }
+}
@@ -0,0 +1,117 @@
+/*
+Author: Botao Huang
+Class: ECE6122 (A)
+Last Date Modified: 10/19/2026
+Description:
+Header file for engine I/O metrics
+Lock-free log-linear (HDR style) histograms and counters filled by
+ECE_ChessEngine, printable on demand or dumped to a file periodically
+*/
+
+#ifndef ECE_ENGINEMETRICS_H
+#define ECE_ENGINEMETRICS_H
+
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <string>
+#include <iostream>
+#include <cstdint>
+
+// Histogram of non negative values, about 6% resolution over the whole 64 bit range.
+// record() is a few relaxed atomic adds, safe from any number of threads
+class ECE_Histogram {
+public:
+    static const int SUB_BUCKETS = 16;
+    static const int BUCKET_COUNT = 61 * SUB_BUCKETS;
+
+private:
+    std::atomic<uint64_t> buckets[BUCKET_COUNT];
+    std::atomic<uint64_t> count;
+    std::atomic<uint64_t> total;
+    std::atomic<uint64_t> maxValue;
+
+public:
+    ECE_Histogram();
+    ECE_Histogram(const ECE_Histogram&) = delete;
+    ECE_Histogram& operator=(const ECE_Histogram&) = delete;
+
+    void record(uint64_t value);
+    void reset();
+
+    uint64_t getCount() const { return count.load(std::memory_order_relaxed); }
+    uint64_t getMax() const { return maxValue.load(std::memory_order_relaxed); }
+    double getMean() const;
+    // Value at or below which the given fraction of the samples lie
+    uint64_t percentile(double fraction) const;
+
+    static int bucketIndex(uint64_t value);
+    // Highest value that falls into a bucket
+    static uint64_t bucketHigh(int index);
+};
+
+typedef std::chrono::steady_clock MetricsClock;
+
+// Timing and traffic of one engine session
+struct ECE_EngineMetrics {
+    // Microseconds
+    ECE_Histogram writeUs;        // WriteFile of one command
+    ECE_Histogram readUs;         // One ReadFile call (includes waiting for the engine)
+    ECE_Histogram firstByteUs;    // "go" sent -> first output byte
+    ECE_Histogram infoGapUs;      // Between consecutive info lines
+    ECE_Histogram bestMoveUs;     // "go" sent -> bestmove parsed
+    // Nanoseconds
+    ECE_Histogram parseNs;        // Parsing one info line
+
+    std::atomic<uint64_t> bytesRead;
+    std::atomic<uint64_t> readCalls;
+    std::atomic<uint64_t> bytesWritten;
+    std::atomic<uint64_t> writeCalls;
+    std::atomic<uint64_t> infoLines;
+    std::atomic<uint64_t> searches;
+    std::atomic<uint64_t> lastNps;     // Last nodes per second reported by the engine
+    std::atomic<uint64_t> maxNps;
+
+    // Timestamps (nanoseconds on MetricsClock, 0 when unset)
+    std::atomic<int64_t> searchStartNs;
+    std::atomic<int64_t> lastInfoNs;
+    std::atomic<bool> awaitingFirstByte;
+
+    ECE_EngineMetrics();
+
+    static int64_t nowNs();
+    // Hooks called by ECE_ChessEngine
+    void onWrite(int64_t startNs, uint64_t bytes, bool isGo);
+    void onRead(int64_t startNs, uint64_t bytes);
+    void onInfoLine(int64_t startNs, uint64_t nps);
+    void onBestMove();
+
+    void reset();
+    void print(std::ostream& os) const;
+};
+
+// Appends a metrics report to a file every few seconds
+class ECE_MetricsDumper {
+private:
+    const ECE_EngineMetrics* metrics;
+    std::string path;
+    int periodSeconds;
+    std::thread thread;
+    std::mutex stopMutex;
+    std::condition_variable stopWake;
+    bool stopping;
+
+public:
+    ECE_MetricsDumper();
+    ~ECE_MetricsDumper();
+
+    bool start(const ECE_EngineMetrics* metrics, const std::string& path, int periodSeconds);
+    void stop();
+
+private:
+    void dumpLoop();
+};
+
+#endif
@@ -0,0 +1,443 @@
+/*
+Author: Botao Huang
+Class: ECE6122 (A)
+Last Date Modified: 10/19/2026
+Description:
+Code for the engine process pool and its priority scheduler
+*/
+
+#include <future>
+#include <iomanip>
+#include "ECE_EnginePool.h"
+
+// How often the monitor checks running jobs against their deadlines
+const std::chrono::milliseconds POOL_MONITOR_PERIOD(5);
+
+namespace {
+    // Milliseconds between two time points
+    double elapsedMs(PoolClock::time_point from, PoolClock::time_point to) {
+        return std::chrono::duration<double, std::milli>(to - from).count();
+    }
+
+    const char* priorityName(int priority) {
+        return priority == PRIORITY_INTERACTIVE ? "interactive" : "background";
+    }
+}
+
+// Constructor function
+ECE_EnginePool::ECE_EnginePool() : stopping(false), nextJobId(1), preemptions(0), expired(0), cancelled(0) {
+    for (int p = 0; p < PRIORITY_COUNT; ++p) {
+        submitted[p] = 0;
+        finished[p] = 0;
+        totalWaitMs[p] = 0;
+        maxWaitMs[p] = 0;
+        maxQueueDepth[p] = 0;
+    }
+}
+
+// Destructor function
+ECE_EnginePool::~ECE_EnginePool() {
+    shutdown();
+}
+
+// Spawn the engines, handshake and wait until every engine is ready
+bool ECE_EnginePool::start(const std::string& enginePath, int engineCount,
+    const std::vector<std::pair<std::string, std::string>>& options) {
+    shutdown();
+    stopping = false;
+
+    for (int i = 0; i < engineCount; ++i) {
+        std::unique_ptr<Worker> worker(new Worker());
+        worker->engine.reset(new ECE_ChessEngine());
+        if (!worker->engine->InitializeEngine(enginePath) || !worker->engine->startUci()) {
+            std::cerr << "Engine pool: failed to start engine " << i << std::endl;
+            workers.clear();
+            return false;
+        }
+        for (const auto& option : options) {
+            worker->engine->setOption(option.first, option.second);
+        }
+        workers.push_back(std::move(worker));
+    }
+
+    // Every engine is warm before the first job arrives
+    for (size_t i = 0; i < workers.size(); ++i) {
+        if (!workers[i]->engine->waitReady()) {
+            std::cerr << "Engine pool: engine " << i << " is not ready" << std::endl;
+            workers.clear();
+            return false;
+        }
+    }
+
+    startTime = PoolClock::now();
+    for (size_t i = 0; i < workers.size(); ++i) {
+        workers[i]->thread = std::thread(&ECE_EnginePool::workerLoop, this, workers[i].get(), static_cast<int>(i));
+    }
+    monitorThread = std::thread(&ECE_EnginePool::monitorLoop, this);
+    return true;
+}
+
+// Stop every engine and join the workers
+void ECE_EnginePool::shutdown() {
+    std::vector<QueuedJob> dropped;
+    {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        stopping = true;
+        for (auto& worker : workers) {
+            if (worker->busy) {
+                worker->cancelRequested = true;
+                requestStop(worker.get());
+            }
+        }
+        for (int p = 0; p < PRIORITY_COUNT; ++p) {
+            for (auto& client : queues[p].clientJobs) {
+                for (auto& queued : client.second) {
+                    dropped.push_back(std::move(queued));
+                }
+            }
+            queues[p].clientJobs.clear();
+            queues[p].clientOrder.clear();
+            queues[p].size = 0;
+        }
+    }
+    workAvailable.notify_all();
+    monitorWake.notify_all();
+
+    for (auto& worker : workers) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+    }
+    if (monitorThread.joinable()) {
+        monitorThread.join();
+    }
+    workers.clear();
+
+    for (const auto& queued : dropped) {
+        dropJob(queued, 0.0);
+    }
+}
+
+// Queue a job, returns its id
+uint64_t ECE_EnginePool::submit(const AnalysisJob& job) {
+    uint64_t id;
+    {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        id = nextJobId++;
+
+        PriorityQueue& queue = queues[job.priority];
+        std::deque<QueuedJob>& clientQueue = queue.clientJobs[job.clientId];
+        if (clientQueue.empty()) {
+            queue.clientOrder.push_back(job.clientId);
+        }
+        QueuedJob queued;
+        queued.id = id;
+        queued.job = job;
+        queued.enqueued = PoolClock::now();
+        clientQueue.push_back(std::move(queued));
+
+        queue.size++;
+        submitted[job.priority]++;
+        if (queue.size > maxQueueDepth[job.priority]) {
+            maxQueueDepth[job.priority] = queue.size;
+        }
+
+        if (job.priority == PRIORITY_INTERACTIVE) {
+            preemptBackground();
+        }
+    }
+    workAvailable.notify_one();
+    return id;
+}
+
+// Queue a job and block until it is done (do not call from a completion callback)
+AnalysisJobResult ECE_EnginePool::analyse(const AnalysisJob& job) {
+    std::shared_ptr<std::promise<AnalysisJobResult>> promise = std::make_shared<std::promise<AnalysisJobResult>>();
+    std::future<AnalysisJobResult> future = promise->get_future();
+
+    AnalysisJob blockingJob = job;
+    std::function<void(const AnalysisJobResult&)> callback = job.onComplete;
+    blockingJob.onComplete = [promise, callback](const AnalysisJobResult& result) {
+        if (callback) {
+            callback(result);
+        }
+        promise->set_value(result);
+    };
+
+    submit(blockingJob);
+    return future.get();
+}
+
+// Drop queued jobs of a client and stop the ones already running
+void ECE_EnginePool::cancelClient(int clientId) {
+    std::vector<QueuedJob> dropped;
+    {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        for (int p = 0; p < PRIORITY_COUNT; ++p) {
+            PriorityQueue& queue = queues[p];
+            auto found = queue.clientJobs.find(clientId);
+            if (found != queue.clientJobs.end()) {
+                for (auto& queued : found->second) {
+                    dropped.push_back(std::move(queued));
+                }
+                queue.size -= found->second.size();
+                queue.clientJobs.erase(found);
+                for (auto it = queue.clientOrder.begin(); it != queue.clientOrder.end(); ++it) {
+                    if (*it == clientId) {
+                        queue.clientOrder.erase(it);
+                        break;
+                    }
+                }
+            }
+        }
+        for (auto& worker : workers) {
+            if (worker->busy && worker->clientId == clientId && !worker->stopRequested) {
+                worker->cancelRequested = true;
+                requestStop(worker.get());
+            }
+        }
+        cancelled += dropped.size();
+    }
+
+    for (const auto& queued : dropped) {
+        dropJob(queued, queued.waitedMs + elapsedMs(queued.enqueued, PoolClock::now()));
+    }
+}
+
+// Jobs waiting in the queues
+size_t ECE_EnginePool::queueDepth() {
+    std::lock_guard<std::mutex> lock(poolMutex);
+    size_t depth = 0;
+    for (int p = 0; p < PRIORITY_COUNT; ++p) {
+        depth += queues[p].size;
+    }
+    return depth;
+}
+
+// Print queue depth, wait time and per engine utilisation
+void ECE_EnginePool::printStats(std::ostream& os) {
+    std::lock_guard<std::mutex> lock(poolMutex);
+    std::ios::fmtflags savedFlags = os.flags();
+    std::streamsize savedPrecision = os.precision();
+    double wallMs = elapsedMs(startTime, PoolClock::now());
+
+    os << std::fixed << std::setprecision(1);
+    os << "Engine pool: " << workers.size() << " engines, " << preemptions << " preemptions, "
+        << expired << " expired, " << cancelled << " cancelled\n";
+    for (int p = 0; p < PRIORITY_COUNT; ++p) {
+        double averageWait = finished[p] ? totalWaitMs[p] / finished[p] : 0.0;
+        os << "  " << priorityName(p) << ": queued " << queues[p].size << " (max " << maxQueueDepth[p]
+            << "), submitted " << submitted[p] << ", run " << finished[p]
+            << ", wait avg " << averageWait << " ms, max " << maxWaitMs[p] << " ms\n";
+    }
+    for (size_t i = 0; i < workers.size(); ++i) {
+        const Worker& worker = *workers[i];
+        double busyMs = worker.busyMs;
+        if (worker.busy) {
+            busyMs += elapsedMs(worker.started, PoolClock::now());
+        }
+        os << "  engine " << i << ": " << worker.jobsRun << " jobs, utilisation "
+            << (wallMs > 0 ? 100.0 * busyMs / wallMs : 0.0) << "%" << (worker.busy ? " (busy)" : "") << "\n";
+    }
+    os.flush();
+    os.flags(savedFlags);
+    os.precision(savedPrecision);
+}
+
+// Worker thread body
+void ECE_EnginePool::workerLoop(Worker* worker, int engineIndex) {
+    std::unique_lock<std::mutex> lock(poolMutex);
+    while (true) {
+        workAvailable.wait(lock, [this] {
+            return stopping || queues[PRIORITY_INTERACTIVE].size > 0 || queues[PRIORITY_BACKGROUND].size > 0;
+        });
+        if (stopping) {
+            return;
+        }
+
+        QueuedJob queued;
+        if (!popJob(queued)) {
+            continue;
+        }
+
+        PoolClock::time_point now = PoolClock::now();
+        queued.waitedMs += elapsedMs(queued.enqueued, now);
+        int priority = queued.job.priority;
+
+        // Too late to be useful
+        if (queued.job.deadline <= now) {
+            expired++;
+            lock.unlock();
+            dropJob(queued, queued.waitedMs);
+            lock.lock();
+            continue;
+        }
+
+        worker->busy = true;
+        worker->jobId = queued.id;
+        worker->priority = queued.job.priority;
+        worker->clientId = queued.job.clientId;
+        worker->deadline = queued.job.deadline;
+        worker->started = now;
+        worker->searchStarted = false;
+        worker->searchFinished = false;
+        worker->stopRequested = false;
+        worker->preempted = false;
+        worker->cancelRequested = false;
+        worker->deadlineStopped = false;
+        lock.unlock();
+
+        AnalysisJobResult result;
+        result.jobId = queued.id;
+        result.engineIndex = engineIndex;
+        worker->engine->startSearch(queued.job.positionCommand, queued.job.goCommand);
+        lock.lock();
+        worker->searchStarted = true;
+        // Stops asked for before "go" went out were held back, send them now
+        if (worker->stopRequested) {
+            worker->engine->stopSearch();
+        }
+        lock.unlock();
+        result.completed = worker->engine->waitBestMove(result.analysis, queued.job.onInfo, [this, worker] {
+            std::lock_guard<std::mutex> guard(poolMutex);
+            worker->searchFinished = true;
+        });
+        PoolClock::time_point end = PoolClock::now();
+        result.runMs = elapsedMs(now, end);
+
+        lock.lock();
+        worker->busy = false;
+        worker->searchStarted = false;
+        worker->busyMs += result.runMs;
+        worker->jobsRun++;
+        // Only stops sent before the bestmove was read cut the search short
+        result.preempted = worker->preempted;
+        result.deadlineStopped = worker->deadlineStopped;
+        if (worker->cancelRequested || worker->deadlineStopped) {
+            result.completed = false;
+        }
+        else if (worker->preempted) {
+            // A cut off search is not the analysis asked for: run it again later
+            if (!stopping && queued.job.deadline > end) {
+                queued.enqueued = end;
+                requeueFront(queued);
+                lock.unlock();
+                workAvailable.notify_one();
+                lock.lock();
+                continue;
+            }
+            result.completed = false;
+        }
+
+        // Queue statistics count each job once, when it is delivered
+        result.waitMs = queued.waitedMs;
+        finished[priority]++;
+        totalWaitMs[priority] += queued.waitedMs;
+        if (queued.waitedMs > maxWaitMs[priority]) {
+            maxWaitMs[priority] = queued.waitedMs;
+        }
+        lock.unlock();
+
+        if (queued.job.onComplete) {
+            queued.job.onComplete(result);
+        }
+        lock.lock();
+    }
+}
+
+// Watches deadlines of running jobs
+void ECE_EnginePool::monitorLoop() {
+    std::unique_lock<std::mutex> lock(poolMutex);
+    while (!stopping) {
+        PoolClock::time_point now = PoolClock::now();
+        for (auto& worker : workers) {
+            if (worker->busy && !worker->stopRequested && !worker->searchFinished && worker->deadline <= now) {
+                worker->deadlineStopped = true;
+                requestStop(worker.get());
+            }
+        }
+        monitorWake.wait_for(lock, POOL_MONITOR_PERIOD);
+    }
+}
+
+// Pop the next job respecting priority and client fairness
+bool ECE_EnginePool::popJob(QueuedJob& queued) {
+    for (int p = 0; p < PRIORITY_COUNT; ++p) {
+        PriorityQueue& queue = queues[p];
+        if (queue.size == 0) {
+            continue;
+        }
+
+        // Serve the client at the front, then move it to the back
+        int clientId = queue.clientOrder.front();
+        queue.clientOrder.pop_front();
+        std::deque<QueuedJob>& clientQueue = queue.clientJobs[clientId];
+        queued = std::move(clientQueue.front());
+        clientQueue.pop_front();
+        if (clientQueue.empty()) {
+            queue.clientJobs.erase(clientId);
+        }
+        else {
+            queue.clientOrder.push_back(clientId);
+        }
+        queue.size--;
+        return true;
+    }
+    return false;
+}
+
+// Stop a background job so an interactive job can run
+void ECE_EnginePool::preemptBackground() {
+    // Interactive jobs that an idle (or already stopping) engine will pick up do not need a preemption
+    size_t available = 0;
+    Worker* victim = NULL;
+    for (auto& worker : workers) {
+        if (!worker->busy || worker->searchFinished ||
+            (worker->stopRequested && worker->priority == PRIORITY_BACKGROUND)) {
+            available++;
+        }
+        else if (worker->priority == PRIORITY_BACKGROUND && !worker->stopRequested) {
+            // The most recently started search has the least work to lose
+            if (victim == NULL || worker->started > victim->started) {
+                victim = worker.get();
+            }
+        }
+    }
+    if (queues[PRIORITY_INTERACTIVE].size <= available || victim == NULL) {
+        return;
+    }
+
+    victim->preempted = true;
+    requestStop(victim);
+    preemptions++;
+}
+
+// Stop a worker's job, now if its search started, else once it does
+void ECE_EnginePool::requestStop(Worker* worker) {
+    worker->stopRequested = true;
+    if (worker->searchStarted && !worker->searchFinished) {
+        worker->engine->stopSearch();
+    }
+}
+
+// Put a preempted job back at the front of its client queue
+void ECE_EnginePool::requeueFront(QueuedJob& queued) {
+    PriorityQueue& queue = queues[queued.job.priority];
+    std::deque<QueuedJob>& clientQueue = queue.clientJobs[queued.job.clientId];
+    if (clientQueue.empty()) {
+        queue.clientOrder.push_front(queued.job.clientId);
+    }
+    clientQueue.push_front(std::move(queued));
+    queue.size++;
+}
+
+// Report a job that never ran
+void ECE_EnginePool::dropJob(const QueuedJob& queued, double waitMs) {
+    if (queued.job.onComplete) {
+        AnalysisJobResult result;
+        result.jobId = queued.id;
+        result.completed = false;
+        result.waitMs = waitMs;
+        queued.job.onComplete(result);
+    }
+}
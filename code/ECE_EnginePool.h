@@ -0,0 +1,164 @@
+/*
+Author: Botao Huang
+Class: ECE6122 (A)
+Last Date Modified: 10/19/2026
+Description:
+Header file for the engine process pool
+Keeps N warm engines and schedules analysis jobs by priority, with
+interactive jobs preempting background analysis
+*/
+
+#ifndef ECE_ENGINEPOOL_H
+#define ECE_ENGINEPOOL_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <chrono>
+#include <iostream>
+#include <cstdint>
+#include "ECE_ChessEngine.h"
+
+// Job priorities, lower value is served first
+enum JobPriority {
+    PRIORITY_INTERACTIVE = 0,
+    PRIORITY_BACKGROUND = 1,
+    PRIORITY_COUNT = 2
+};
+
+typedef std::chrono::steady_clock PoolClock;
+
+// Outcome handed to the job's completion callback
+struct AnalysisJobResult {
+    uint64_t jobId;
+    EngineAnalysis analysis;
+    bool completed;      // false if the job expired, was stopped at its deadline, was cancelled or the engine failed
+    bool preempted;      // stopped early to make room for interactive work
+    bool deadlineStopped; // stopped at its deadline, analysis holds the partial search
+    double waitMs;       // time spent in the queue (every time, if preempted and requeued)
+    double runMs;        // time spent on an engine
+    int engineIndex;
+
+    AnalysisJobResult() : jobId(0), completed(false), preempted(false), deadlineStopped(false), waitMs(0), runMs(0), engineIndex(-1) {}
+};
+
+// One unit of work for an engine
+struct AnalysisJob {
+    std::string positionCommand;    // e.g. "position startpos moves e2e4"
+    std::string goCommand;          // e.g. "go depth 7", "go movetime 200"
+    JobPriority priority;
+    int clientId;                   // jobs of different clients are served round robin
+    PoolClock::time_point deadline; // stopped (or dropped) once passed
+    std::function<void(const AnalysisJobResult&)> onComplete;
+    InfoCallback onInfo;            // optional, runs on the engine's worker thread
+
+    AnalysisJob() : priority(PRIORITY_BACKGROUND), clientId(0), deadline(PoolClock::time_point::max()) {}
+};
+
+class ECE_EnginePool {
+private:
+    struct QueuedJob {
+        uint64_t id;
+        AnalysisJob job;
+        PoolClock::time_point enqueued;
+        double waitedMs = 0;        // queue time of earlier runs (preempted jobs)
+    };
+
+    // Per client FIFO plus the round robin order of clients with pending work
+    struct PriorityQueue {
+        std::map<int, std::deque<QueuedJob>> clientJobs;
+        std::deque<int> clientOrder;
+        size_t size = 0;
+    };
+
+    struct Worker {
+        std::unique_ptr<ECE_ChessEngine> engine;
+        std::thread thread;
+        // Job currently on the engine (guarded by poolMutex)
+        bool busy = false;
+        uint64_t jobId = 0;
+        JobPriority priority = PRIORITY_BACKGROUND;
+        int clientId = 0;
+        PoolClock::time_point deadline;
+        PoolClock::time_point started;
+        // "go" has been written; a stop sent earlier would reach an idle engine
+        bool searchStarted = false;
+        // Its bestmove was read: stopping it now would only reach an idle engine
+        bool searchFinished = false;
+        bool stopRequested = false;
+        bool preempted = false;
+        bool cancelRequested = false;
+        bool deadlineStopped = false;
+        // Utilisation accounting
+        double busyMs = 0;
+        uint64_t jobsRun = 0;
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    PriorityQueue queues[PRIORITY_COUNT];
+    std::mutex poolMutex;
+    std::condition_variable workAvailable;
+    std::condition_variable monitorWake;
+    std::thread monitorThread;
+    bool stopping;
+    uint64_t nextJobId;
+    PoolClock::time_point startTime;
+
+    // Statistics (guarded by poolMutex)
+    uint64_t submitted[PRIORITY_COUNT];
+    uint64_t finished[PRIORITY_COUNT];
+    uint64_t preemptions;
+    uint64_t expired;
+    uint64_t cancelled;
+    double totalWaitMs[PRIORITY_COUNT];
+    double maxWaitMs[PRIORITY_COUNT];
+    size_t maxQueueDepth[PRIORITY_COUNT];
+
+public:
+    ECE_EnginePool();
+    ~ECE_EnginePool();
+
+    // Spawn engineCount engines, run the UCI handshake, apply the
+    // (name, value) options and wait until every engine answers isready
+    bool start(const std::string& enginePath, int engineCount,
+        const std::vector<std::pair<std::string, std::string>>& options = std::vector<std::pair<std::string, std::string>>());
+    // Stop every engine and join the workers (pending jobs are dropped)
+    void shutdown();
+
+    // Queue a job, returns its id
+    uint64_t submit(const AnalysisJob& job);
+    // Queue a job and block until it is done
+    AnalysisJobResult analyse(const AnalysisJob& job);
+    // Drop queued jobs of a client and stop the ones already running
+    void cancelClient(int clientId);
+
+    int engineCount() const { return static_cast<int>(workers.size()); }
+    // Jobs waiting in the queues
+    size_t queueDepth();
+    // Print queue depth, wait time and per engine utilisation
+    void printStats(std::ostream& os);
+
+private:
+    // Worker thread body
+    void workerLoop(Worker* worker, int engineIndex);
+    // Watches deadlines of running jobs
+    void monitorLoop();
+    // Pop the next job respecting priority and client fairness (poolMutex held)
+    bool popJob(QueuedJob& queued);
+    // Stop a background job so an interactive job can run (poolMutex held)
+    void preemptBackground();
+    // Stop a worker's job, now if its search started, else once it does (poolMutex held)
+    static void requestStop(Worker* worker);
+    // Put a preempted job back at the front of its client queue (poolMutex held)
+    void requeueFront(QueuedJob& queued);
+    // Report a job that never ran
+    static void dropJob(const QueuedJob& queued, double waitMs);
+};
+
+#endif
@@ -0,0 +1,277 @@
+/*
+Author: Botao Huang
+Class: ECE6122 (A)
+Last Date Modified: 10/19/2026
+Description:
+EPD test suite runner
+Runs bm/am positions on a pool of engines and records when the expected
+move first shows up as the best move (time, depth, nodes)
+*/
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+#include "ECE_EnginePool.h"
+#include "chessEpd.h"
+#include "chessPosition.h"
+
+// Command line settings
+struct SuiteOptions {
+    std::string enginePath = "komodo.exe";
+    int engineCount = 0;              // 0: one per hardware thread
+    std::string inputPath;
+    std::string csvPath;
+    std::string limitKind = "movetime";
+    uint64_t limitValue = 5000;
+    int threads = 1;
+    int hashMb = 16;
+};
+
+// Search progress at one point in time
+struct SearchPoint {
+    bool seen = false;
+    int timeMs = 0;
+    int depth = 0;
+    uint64_t nodes = 0;
+};
+
+// One suite position and what the engine did with it
+struct SuitePosition {
+    std::string id;
+    std::string fen;
+    std::string expected;             // bm/am as written in the suite
+    std::vector<uint16_t> bestMoves;  // bm: any of these solves
+    std::vector<uint16_t> avoidMoves; // am: anything else solves
+    // Filled by the engine callbacks
+    bool solvingNow = false;
+    SearchPoint firstSeen;            // expected move first became the best move
+    SearchPoint solvedAt;             // expected move became the best move for good
+    std::string finalMove;
+    bool solved = false;
+    bool failed = false;
+
+    bool isSolution(uint16_t move) const {
+        if (!bestMoves.empty()) {
+            return std::find(bestMoves.begin(), bestMoves.end(), move) != bestMoves.end();
+        }
+        return move != 0 && std::find(avoidMoves.begin(), avoidMoves.end(), move) == avoidMoves.end();
+    }
+};
+
+// Print usage
+void printUsage() {
+    std::cerr << "Usage: ECE_EpdSuite --input suite.epd [--engine path] [--engines N]\n"
+        << "       [--movetime MS | --depth D | --nodes N] [--threads N] [--hash MB] [--csv results.csv]" << std::endl;
+}
+
+// Parse the command line
+bool parseOptions(int argc, char* argv[], SuiteOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string option = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (option == "--input" && hasValue) options.inputPath = argv[++i];
+        else if (option == "--csv" && hasValue) options.csvPath = argv[++i];
+        else if (option == "--engine" && hasValue) options.enginePath = argv[++i];
+        else if (option == "--engines" && hasValue) options.engineCount = std::atoi(argv[++i]);
+        else if ((option == "--depth" || option == "--nodes" || option == "--movetime") && hasValue) {
+            options.limitKind = option.substr(2);
+            options.limitValue = std::strtoull(argv[++i], NULL, 10);
+        }
+        else if (option == "--threads" && hasValue) options.threads = std::atoi(argv[++i]);
+        else if (option == "--hash" && hasValue) options.hashMb = std::atoi(argv[++i]);
+        else return false;
+    }
+    return !options.inputPath.empty();
+}
+
+// Resolve a space separated list of SAN moves, false if one is not legal
+bool resolveMoves(const chessPosition& position, const std::string& list, std::vector<uint16_t>& moves) {
+    std::istringstream tokens(list);
+    std::string san;
+    while (tokens >> san) {
+        uint16_t move = position.moveFromSan(san);
+        if (move == 0) {
+            return false;
+        }
+        moves.push_back(move);
+    }
+    return true;
+}
+
+// First move of a principal variation
+uint16_t firstPvMove(const std::string& pv) {
+    size_t end = pv.find(' ');
+    return chessPosition::packUciMove(pv.substr(0, end));
+}
+
+// Main Entry Point
+int main(int argc, char* argv[])
+{
+    SuiteOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage();
+        return -1;
+    }
+    if (options.engineCount <= 0) {
+        options.engineCount = std::max(1u, std::thread::hardware_concurrency() / std::max(1, options.threads));
+    }
+
+    // Load the suite
+    std::ifstream input(options.inputPath);
+    if (!input) {
+        std::cerr << "Cannot open " << options.inputPath << std::endl;
+        return -1;
+    }
+    std::vector<SuitePosition> positions;
+    std::string line, error;
+    EpdRecord record;
+    uint64_t lineNumber = 0;
+    while (std::getline(input, line)) {
+        lineNumber++;
+        if (!parseEpdLine(line, record, error)) {
+            if (!error.empty()) {
+                std::cerr << "Line " << lineNumber << ": " << error << std::endl;
+            }
+            continue;
+        }
+        SuitePosition position;
+        position.id = record.id("line " + std::to_string(lineNumber));
+        position.fen = record.fen;
+        chessPosition board;
+        board.setFromFen(record.fen);
+        bool valid = resolveMoves(board, record.operation("bm"), position.bestMoves)
+            && resolveMoves(board, record.operation("am"), position.avoidMoves);
+        if (!valid || (position.bestMoves.empty() && position.avoidMoves.empty())) {
+            std::cerr << position.id << ": no usable bm/am, skipped" << std::endl;
+            continue;
+        }
+        position.expected = record.hasOperation("bm") ? "bm " + record.operation("bm") : "am " + record.operation("am");
+        positions.push_back(position);
+    }
+
+    std::vector<std::pair<std::string, std::string>> engineOptions;
+    engineOptions.push_back(std::make_pair("Threads", std::to_string(options.threads)));
+    engineOptions.push_back(std::make_pair("Hash", std::to_string(options.hashMb)));
+    ECE_EnginePool pool;
+    if (!pool.start(options.enginePath, options.engineCount, engineOptions)) {
+        return -1;
+    }
+
+    std::mutex doneMutex;
+    std::condition_variable allDone;
+    size_t remaining = positions.size();
+    std::string goCommand = "go " + options.limitKind + " " + std::to_string(options.limitValue);
+    auto startTime = std::chrono::steady_clock::now();
+
+    for (size_t i = 0; i < positions.size(); ++i) {
+        SuitePosition* position = &positions[i];
+        AnalysisJob job;
+        job.positionCommand = "position fen " + position->fen;
+        job.goCommand = goCommand;
+        job.priority = PRIORITY_BACKGROUND;
+        // Every PV update: note when the expected move took (and kept) first place
+        job.onInfo = [position](const EngineAnalysis& analysis) {
+            bool solving = position->isSolution(firstPvMove(analysis.pv));
+            SearchPoint point;
+            point.seen = true;
+            point.timeMs = analysis.timeMs;
+            point.depth = analysis.depth;
+            point.nodes = analysis.nodes;
+            if (solving && !position->firstSeen.seen) {
+                position->firstSeen = point;
+            }
+            if (solving && !position->solvingNow) {
+                position->solvedAt = point;
+            }
+            position->solvingNow = solving;
+        };
+        job.onComplete = [&, position](const AnalysisJobResult& result) {
+            position->failed = !result.completed;
+            position->finalMove = result.analysis.bestMove;
+            position->solved = result.completed && position->isSolution(chessPosition::packUciMove(result.analysis.bestMove));
+            if (position->solved && !position->solvingNow) {
+                // Solved without a matching PV line, charge the whole search
+                position->solvedAt.seen = true;
+                position->solvedAt.timeMs = static_cast<int>(result.runMs);
+                position->solvedAt.depth = result.analysis.depth;
+                position->solvedAt.nodes = result.analysis.nodes;
+                if (!position->firstSeen.seen) {
+                    position->firstSeen = position->solvedAt;
+                }
+            }
+            std::lock_guard<std::mutex> lock(doneMutex);
+            remaining--;
+            allDone.notify_one();
+        };
+        pool.submit(job);
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(doneMutex);
+        allDone.wait(lock, [&] { return remaining == 0; });
+    }
+    double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+    // Per position results
+    std::ofstream csv;
+    if (!options.csvPath.empty()) {
+        csv.open(options.csvPath);
+        csv << "id,expected,solved,move,first_time_ms,first_depth,first_nodes,solve_time_ms,solve_depth,solve_nodes\n";
+    }
+    int solved = 0, seen = 0, failed = 0;
+    double solveTimeMs = 0, suiteTimeMs = 0;
+    uint64_t solveNodes = 0;
+    for (const SuitePosition& position : positions) {
+        std::cout << (position.solved ? "+ " : "- ") << std::left << std::setw(20) << position.id << std::right
+            << " " << position.expected << ", played " << (position.finalMove.empty() ? "-" : position.finalMove);
+        if (position.solved) {
+            std::cout << " at " << position.solvedAt.timeMs << " ms, depth " << position.solvedAt.depth;
+        }
+        std::cout << '\n';
+        if (csv.is_open()) {
+            csv << '"' << position.id << "\",\"" << position.expected << "\"," << (position.solved ? 1 : 0) << ','
+                << position.finalMove << ',' << position.firstSeen.timeMs << ',' << position.firstSeen.depth << ','
+                << position.firstSeen.nodes << ',' << position.solvedAt.timeMs << ',' << position.solvedAt.depth << ','
+                << position.solvedAt.nodes << '\n';
+        }
+
+        if (position.firstSeen.seen) seen++;
+        if (position.failed) failed++;
+        if (position.solved) {
+            solved++;
+            solveTimeMs += position.solvedAt.timeMs;
+            solveNodes += position.solvedAt.nodes;
+            suiteTimeMs += position.solvedAt.timeMs;
+        }
+        else if (options.limitKind == "movetime") {
+            // Unsolved positions are charged the full limit
+            suiteTimeMs += static_cast<double>(options.limitValue);
+        }
+    }
+
+    // Summary meant to be compared between builds and settings
+    std::cout << std::fixed << std::setprecision(1)
+        << "Suite:          " << options.inputPath << " (" << positions.size() << " positions, " << goCommand
+        << ", " << options.engineCount << " engines x " << options.threads << " threads)\n"
+        << "Solved:         " << solved << " / " << positions.size() << " ("
+        << (positions.empty() ? 0.0 : 100.0 * solved / positions.size()) << "%), first seen in " << seen
+        << (failed ? ", " + std::to_string(failed) + " engine failures" : "") << "\n"
+        << "Time to solve:  " << (solved ? solveTimeMs / solved : 0.0) << " ms mean, "
+        << (solved ? solveNodes / solved : 0) << " nodes mean\n";
+    if (options.limitKind == "movetime") {
+        std::cout << "Suite time:     " << suiteTimeMs / 1000.0 << " s (unsolved charged the full limit)\n";
+    }
+    std::cout << "Wall time:      " << wallSeconds << " s" << std::endl;
+    pool.printStats(std::cerr);
+    return 0;
+}
@@ -0,0 +1,220 @@
+/*
+Author: Botao Huang
+Class: ECE6122 (A)
+Last Date Modified: 10/19/2026
+Description:
+Board feed benchmark
+One game thread plays random games through a session with a feed attached;
+consumer threads drain many subscribers into mirrors that check every board
+hash. Reports the deltas per second delivered to the subscribers
+*/
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+#include "chessBoardFeed.h"
+#include "chessSession.h"
+#include "chessPosition.h"
+
+// Command line settings
+struct FeedBenchOptions {
+    int subscribers = 1000;
+    int consumers = 2;          // Threads draining the subscribers
+    double seconds = 5.0;
+    int games = 64;             // Random games replayed in turn
+    int rate = 0;               // Moves per second, 0: as fast as possible
+    unsigned seed = 1;
+};
+
+// Totals of one consumer thread
+struct ConsumerTotals {
+    uint64_t frames = 0;
+    uint64_t deltas = 0;
+    uint64_t keyframes = 0;
+    uint64_t bytes = 0;
+    uint64_t hashMismatches = 0;
+};
+
+// Print usage
+void printUsage() {
+    std::cerr << "Usage: ECE_FeedBench [--subscribers N] [--consumers N] [--seconds S] [--games N]\n"
+        << "       [--rate MOVES_PER_S] [--seed N]" << std::endl;
+}
+
+// Parse the command line
+bool parseOptions(int argc, char* argv[], FeedBenchOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string option = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (option == "--subscribers" && hasValue) options.subscribers = std::atoi(argv[++i]);
+        else if (option == "--consumers" && hasValue) options.consumers = std::atoi(argv[++i]);
+        else if (option == "--seconds" && hasValue) options.seconds = std::atof(argv[++i]);
+        else if (option == "--games" && hasValue) options.games = std::atoi(argv[++i]);
+        else if (option == "--rate" && hasValue) options.rate = std::atoi(argv[++i]);
+        else if (option == "--seed" && hasValue) options.seed = static_cast<unsigned>(std::atoi(argv[++i]));
+        else return false;
+    }
+    return options.subscribers > 0 && options.consumers > 0 && options.seconds > 0 && options.games > 0
+        && options.rate >= 0;
+}
+
+// Random legal games. The session's board does not move the rook when castling
+// nor take en passant, so those moves (and promotions) end a game early
+std::vector<std::vector<std::string>> randomGames(int count, unsigned seed) {
+    std::mt19937 random(seed);
+    std::vector<std::vector<std::string>> games(count);
+    std::vector<uint16_t> legal;
+    std::vector<std::string> playable;
+    for (auto& game : games) {
+        chessPosition position;
+        position.setStartPosition();
+        while (game.size() < 200) {
+            position.generateLegalMoves(legal);
+            playable.clear();
+            for (uint16_t move : legal) {
+                std::string uci = chessPosition::unpackMove(move);
+                int from = chessPosition::squareFromName(uci[0], uci[1]);
+                int to = chessPosition::squareFromName(uci[2], uci[3]);
+                char piece = position.board[from];
+                bool castling = (piece == 'K' || piece == 'k') && std::abs(uci[0] - uci[2]) == 2;
+                bool enPassant = (piece == 'P' || piece == 'p') && uci[0] != uci[2]
+                    && position.board[to] == EMPTY_SQUARE;
+                if (uci.size() == 4 && !castling && !enPassant) {
+                    playable.push_back(uci);
+                }
+            }
+            if (playable.empty()) {
+                break;
+            }
+            const std::string& move = playable[random() % playable.size()];
+            position.applyUciMove(move);
+            game.push_back(move);
+        }
+    }
+    return games;
+}
+
+// Drain every subscriber of this thread into its mirror
+void consumerLoop(std::vector<std::shared_ptr<chessFeedSubscriber>>& subscribers,
+    std::vector<chessFeedMirror>& mirrors, int first, int step, const std::atomic<bool>& playing,
+    ConsumerTotals& totals) {
+    chessFeedFrame frame;
+    while (true) {
+        // Read before draining so the last frames are not missed
+        bool finished = !playing;
+        uint64_t before = totals.frames;
+        for (size_t i = static_cast<size_t>(first); i < subscribers.size(); i += static_cast<size_t>(step)) {
+            while (subscribers[i]->pop(frame)) {
+                chessFeedMirror& mirror = mirrors[i];
+                if (!mirror.apply(frame->data(), frame->size()) && mirror.hashMismatches > 0) {
+                    totals.hashMismatches++;
+                    mirror.hashMismatches = 0;
+                }
+                totals.frames++;
+                totals.bytes += frame->size();
+            }
+        }
+        if (finished) {
+            break;
+        }
+        if (totals.frames == before) {
+            std::this_thread::yield();
+        }
+    }
+    for (size_t i = static_cast<size_t>(first); i < subscribers.size(); i += static_cast<size_t>(step)) {
+        totals.deltas += mirrors[i].deltasApplied;
+        totals.keyframes += mirrors[i].keyframesApplied;
+    }
+}
+
+// Main Entry Point
+int main(int argc, char* argv[])
+{
+    FeedBenchOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage();
+        return -1;
+    }
+    std::vector<std::vector<std::string>> games = randomGames(options.games, options.seed);
+
+    chessSession session;
+    chessBoardFeed feed;
+    std::vector<std::shared_ptr<chessFeedSubscriber>> subscribers;
+    for (int i = 0; i < options.subscribers; ++i) {
+        subscribers.push_back(feed.subscribe());
+    }
+    std::vector<chessFeedMirror> mirrors(subscribers.size());
+    session.attachFeed(&feed);
+
+    std::atomic<bool> playing{ true };
+    std::vector<ConsumerTotals> totals(options.consumers);
+    std::vector<std::thread> consumers;
+    for (int t = 0; t < options.consumers; ++t) {
+        consumers.emplace_back(consumerLoop, std::ref(subscribers), std::ref(mirrors), t, options.consumers,
+            std::cref(playing), std::ref(totals[t]));
+    }
+
+    // Game thread: this one. Move messages go nowhere
+    std::ostream sink(NULL);
+    uint64_t moves = 0;
+    auto start = std::chrono::steady_clock::now();
+    auto deadline = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(options.seconds));
+    for (size_t g = 0; std::chrono::steady_clock::now() < deadline; g = (g + 1) % games.size()) {
+        session.reset();
+        for (const std::string& move : games[g]) {
+            session.executeMove(move, sink);
+            moves++;
+            if (options.rate > 0) {
+                std::this_thread::sleep_until(start + std::chrono::microseconds(moves * 1000000 / options.rate));
+            }
+        }
+    }
+    double playSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    playing = false;
+    for (auto& consumer : consumers) {
+        consumer.join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    ConsumerTotals all;
+    for (const ConsumerTotals& t : totals) {
+        all.frames += t.frames;
+        all.deltas += t.deltas;
+        all.keyframes += t.keyframes;
+        all.bytes += t.bytes;
+        all.hashMismatches += t.hashMismatches;
+    }
+    uint64_t dropped = 0;
+    size_t inSync = 0;
+    uint32_t finalHash = feedBoardHash(session.boardState);
+    for (size_t i = 0; i < subscribers.size(); ++i) {
+        dropped += subscribers[i]->droppedFrames();
+        if (mirrors[i].isSynced() && feedBoardHash(mirrors[i].pieces + 8) == finalHash) {
+            inSync++;
+        }
+    }
+    uint64_t published = feed.framesPublished();
+
+    std::cout << std::fixed << std::setprecision(1)
+        << "Subscribers: " << options.subscribers << " on " << options.consumers << " consumer threads\n"
+        << "Published:   " << moves << " moves, " << published << " frames in " << playSeconds << " s ("
+        << moves / playSeconds << " moves/s)\n"
+        << "Delivered:   " << all.frames << " frames, " << all.deltas << " deltas, " << all.keyframes << " keyframes in "
+        << seconds << " s\n"
+        << "Throughput:  " << all.deltas / seconds << " deltas/s, " << all.bytes / seconds / 1e6 << " MB/s of frames ("
+        << std::setprecision(2) << static_cast<double>(all.bytes) / std::max<uint64_t>(all.frames, 1) << " bytes/frame)\n"
+        << "Dropped:     " << dropped << " frames (subscribers that fell behind)\n"
+        << "Integrity:   " << all.hashMismatches << " hash mismatches, " << inSync << "/" << subscribers.size()
+        << " mirrors match the final board" << std::endl;
+    return all.hashMismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,749 @@
+/*
+Author: Botao Huang
+Class: ECE6122 (A)
+Last Date Modified: 10/19/2026
+Description:
+Multi-game server
+Hosts many games in one process on a local socket (Unix domain socket, or TCP
+on localhost). Clients send the window's commands one per line; sessions run
+on a fixed worker pool and engine replies come from a shared engine pool.
+"watch N" turns a connection into a spectator of session N: from then on it
+receives the binary frames of that game's board feed (see chessBoardFeed.h)
+*/
+
+// Sockets first: winsock2.h must come before windows.h
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include <afunix.h>
+#else
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <poll.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#endif
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <memory>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <ctime>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include "ECE_EnginePool.h"
+#include "chessSession.h"
+#include "chessGameArchive.h"
+#include "chessScript.h"
+#include "chessBoardFeed.h"
+
+#ifdef _WIN32
+typedef SOCKET SocketHandle;
+const int SEND_FLAGS = 0;
+#else
+typedef int SocketHandle;
+const SocketHandle INVALID_SOCKET = -1;
+const int SEND_FLAGS = MSG_NOSIGNAL;
+#endif
+
+// Longest command line; a longer one ends the connection
+const size_t SERVER_MAX_LINE = 256;
+// Commands queued per session before the server stops reading from it
+const size_t SERVER_MAX_PENDING = 16;
+// Unsent reply bytes per session before the server stops reading from it
+const size_t SERVER_MAX_OUTPUT = 64 * 1024;
+// Commands a worker runs for one session before moving on to the next
+const int SERVER_SESSION_BATCH = 8;
+const char* INVALID_REPLY = "Invalid command or move!!\n";
+// pollIndex of a session no longer in the poll set
+const size_t NO_POLL_ENTRY = static_cast<size_t>(-1);
+
+// Command line settings
+struct ServerOptions {
+    std::string socketPath = "chess.sock";  // Unix domain socket
+    int port = 0;                           // TCP on 127.0.0.1 instead, when set
+    int workers = 0;                        // 0: one per hardware thread
+    std::string enginePath = "komodo.exe";
+    int engines = 2;
+    int depth = 7;
+    size_t maxSessions = 4096;
+    std::string archivePath;                // Games of clients that quit, when set
+};
+
+// One client and its game. The game is only touched by the worker that has
+// the session scheduled; the send buffers only by the I/O thread
+struct ServerSession {
+    chessSession game;
+    chessBoardFeed feed;                // Moves of this game, for spectators
+    std::string sending;                // Reply bytes being sent
+    size_t sent = 0;
+    std::shared_ptr<chessFeedSubscriber> spectating;
+    chessFeedFrame frame;               // Feed frame being sent (shared, not copied)
+    size_t frameSent = 0;
+    size_t pollIndex = NO_POLL_ENTRY;   // Client entry in the I/O thread's poll set
+    std::atomic<bool> dirty{ false };   // Waiting in the dirty list for a poll update
+
+    std::mutex mutex;                   // Guards everything below
+    std::string input;                  // Partial line
+    std::deque<std::string> commands;   // Complete lines waiting for a worker
+    std::string output;                 // Replies waiting for the I/O thread
+    bool scheduled = false;             // In the ready queue or on a worker
+    bool awaitingEngine = false;        // A move waits for the engine's reply
+    bool engineDone = false;
+    std::string engineMove;             // Empty when the engine failed
+    bool closing = false;               // Close once the output is sent
+    std::shared_ptr<chessFeedSubscriber> watching;  // Set by "watch"
+
+    explicit ServerSession(uint32_t id) : game(id) {
+        game.attachFeed(&feed);
+    }
+};
+typedef std::shared_ptr<ServerSession> SessionPtr;
+
+// Server wide state
+struct ServerState {
+    ServerOptions options;
+    ECE_EnginePool enginePool;
+    std::string goCommand;
+    std::vector<SocketHandle> listeners;
+    SocketHandle wakeSocket = INVALID_SOCKET;
+    std::atomic<bool> wakePending{ false };
+    // Sessions whose poll entry the I/O thread must update, handed over with the wake
+    std::mutex dirtyMutex;
+    std::vector<std::shared_ptr<ServerSession>> dirty;
+
+    // Sessions waiting for a worker
+    std::mutex readyMutex;
+    std::condition_variable readyChanged;
+    std::deque<SessionPtr> ready;
+
+    std::mutex archiveMutex;
+    chessGameArchiveWriter archive;
+
+    // Open sessions by id, for "watch"
+    std::mutex sessionsMutex;
+    std::map<uint32_t, std::weak_ptr<ServerSession>> sessionsById;
+};
+
+ServerState server;
+
+// Print usage
+void printUsage() {
+    std::cerr << "Usage: ECE_GameServer [--socket chess.sock | --port N] [--workers N]\n"
+        << "       [--engine komodo.exe] [--engines N] [--depth N] [--max-sessions N] [--archive games]" << std::endl;
+}
+
+// Parse the command line
+bool parseOptions(int argc, char* argv[], ServerOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string option = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (option == "--socket" && hasValue) options.socketPath = argv[++i];
+        else if (option == "--port" && hasValue) options.port = std::atoi(argv[++i]);
+        else if (option == "--workers" && hasValue) options.workers = std::atoi(argv[++i]);
+        else if (option == "--engine" && hasValue) options.enginePath = argv[++i];
+        else if (option == "--engines" && hasValue) options.engines = std::atoi(argv[++i]);
+        else if (option == "--depth" && hasValue) options.depth = std::atoi(argv[++i]);
+        else if (option == "--max-sessions" && hasValue) options.maxSessions = std::strtoul(argv[++i], NULL, 10);
+        else if (option == "--archive" && hasValue) options.archivePath = argv[++i];
+        else return false;
+    }
+    return options.engines > 0 && options.depth > 0 && options.maxSessions > 0;
+}
+
+// Socket helpers
+void closeSocket(SocketHandle socket) {
+#ifdef _WIN32
+    closesocket(socket);
+#else
+    close(socket);
+#endif
+}
+
+bool setNonBlocking(SocketHandle socket) {
+#ifdef _WIN32
+    u_long enabled = 1;
+    return ioctlsocket(socket, FIONBIO, &enabled) == 0;
+#else
+    int flags = fcntl(socket, F_GETFL, 0);
+    return flags >= 0 && fcntl(socket, F_SETFL, flags | O_NONBLOCK) == 0;
+#endif
+}
+
+bool wouldBlock() {
+#ifdef _WIN32
+    return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+    return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+#endif
+}
+
+int pollSockets(std::vector<pollfd>& sockets, int timeoutMs) {
+#ifdef _WIN32
+    return WSAPoll(sockets.data(), static_cast<ULONG>(sockets.size()), timeoutMs);
+#else
+    return poll(sockets.data(), sockets.size(), timeoutMs);
+#endif
+}
+
+// Listening socket on a Unix domain path or on 127.0.0.1:port
+SocketHandle openListener(const ServerOptions& options) {
+    SocketHandle listener;
+    if (options.port > 0) {
+        listener = socket(AF_INET, SOCK_STREAM, 0);
+        if (listener == INVALID_SOCKET) {
+            return INVALID_SOCKET;
+        }
+        int reuse = 1;
+        setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse), sizeof(reuse));
+        sockaddr_in address;
+        std::memset(&address, 0, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_port = htons(static_cast<unsigned short>(options.port));
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+            closeSocket(listener);
+            return INVALID_SOCKET;
+        }
+    }
+    else {
+        sockaddr_un address;
+        std::memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        if (options.socketPath.size() >= sizeof(address.sun_path)) {
+            return INVALID_SOCKET;
+        }
+        std::memcpy(address.sun_path, options.socketPath.c_str(), options.socketPath.size());
+        listener = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listener == INVALID_SOCKET) {
+            return INVALID_SOCKET;
+        }
+        // A socket file left by an earlier run would make bind fail
+        std::remove(options.socketPath.c_str());
+        if (bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+            closeSocket(listener);
+            return INVALID_SOCKET;
+        }
+    }
+    if (listen(listener, SOMAXCONN) != 0 || !setNonBlocking(listener)) {
+        closeSocket(listener);
+        return INVALID_SOCKET;
+    }
+    return listener;
+}
+
+// UDP socket connected to itself; workers send it a byte to wake the I/O thread
+SocketHandle openWakeSocket() {
+    SocketHandle wake = socket(AF_INET, SOCK_DGRAM, 0);
+    if (wake == INVALID_SOCKET) {
+        return INVALID_SOCKET;
+    }
+    sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t length = sizeof(address);
+    if (bind(wake, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0
+        || getsockname(wake, reinterpret_cast<sockaddr*>(&address), &length) != 0
+        || connect(wake, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0
+        || !setNonBlocking(wake)) {
+        closeSocket(wake);
+        return INVALID_SOCKET;
+    }
+    return wake;
+}
+
+// Wake the I/O thread (one datagram per wait, however many replies are ready)
+void wakeIoThread() {
+    if (!server.wakePending.exchange(true)) {
+        char byte = 0;
+        send(server.wakeSocket, &byte, 1, SEND_FLAGS);
+    }
+}
+
+// Have the I/O thread update a session's poll entry (new output, fewer
+// pending commands, a feed frame) and wake it
+void markDirty(const SessionPtr& session) {
+    if (!session->dirty.exchange(true)) {
+        std::lock_guard<std::mutex> lock(server.dirtyMutex);
+        server.dirty.push_back(session);
+    }
+    wakeIoThread();
+}
+
+// Hand a session to the workers unless it is already with them (mutex held)
+void scheduleLocked(const SessionPtr& session) {
+    if (session->scheduled) {
+        return;
+    }
+    session->scheduled = true;
+    std::lock_guard<std::mutex> lock(server.readyMutex);
+    server.ready.push_back(session);
+    server.readyChanged.notify_one();
+}
+
+// Engine reply for a session, on an engine pool thread
+void onEngineReply(const std::weak_ptr<ServerSession>& weak, const AnalysisJobResult& result) {
+    SessionPtr session = weak.lock();
+    if (!session) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(session->mutex);
+    session->engineDone = true;
+    session->engineMove = result.completed ? result.analysis.bestMove : "";
+    scheduleLocked(session);
+}
+
+// Append a game to the archive (clients that quit)
+void archiveGame(chessGameRecord& record) {
+    if (server.options.archivePath.empty() || record.size() == 0) {
+        return;
+    }
+    record.endTime = static_cast<uint32_t>(time(NULL));
+    std::lock_guard<std::mutex> lock(server.archiveMutex);
+    uint64_t gameId;
+    server.archive.append(record, gameId);
+}
+
+// Run one command line of a session; returns false when the session waits for the engine
+bool runCommand(const SessionPtr& session, char* line, size_t length, std::ostream& reply) {
+    chessCommandTokenizer tokens;
+    tokens.split(line, length);
+    chessSession& game = session->game;
+
+    bool spectator;
+    {
+        std::lock_guard<std::mutex> lock(session->mutex);
+        spectator = static_cast<bool>(session->watching);
+    }
+    // Spectators get binary frames: anything but quit is ignored
+    if (spectator && !tokens.is(0, "quit")) {
+        return true;
+    }
+
+    if (tokens.is(0, "move")) {
+        std::string move(tokens.token(1), tokens.length(1));
+        if (game.beginUserMove(move, reply)) {
+            AnalysisJob job;
+            job.positionCommand = "position startpos moves " + game.gameRecord.uciMoves();
+            job.goCommand = server.goCommand;
+            job.priority = PRIORITY_INTERACTIVE;
+            job.clientId = static_cast<int>(game.id);
+            std::weak_ptr<ServerSession> weak = session;
+            job.onComplete = [weak](const AnalysisJobResult& result) { onEngineReply(weak, result); };
+            {
+                std::lock_guard<std::mutex> lock(session->mutex);
+                session->awaitingEngine = true;
+            }
+            server.enginePool.submit(job);
+            return false;
+        }
+    }
+    else if (tokens.is(0, "camera") || tokens.is(0, "light")) {
+        float theta, phi, r;
+        if (tokens.toFloat(1, theta) && tokens.toFloat(2, phi) && tokens.toFloat(3, r)
+            && (tokens.is(0, "camera") ? game.setCamera(theta, phi, r) : game.setLight(theta, phi, r))) {
+            reply << "ok\n";
+            return true;
+        }
+    }
+    else if (tokens.is(0, "power")) {
+        float power;
+        if (tokens.toFloat(1, power) && game.setLightPower(power)) {
+            reply << "ok\n";
+            return true;
+        }
+    }
+    else if (tokens.is(0, "watch")) {
+        int id;
+        SessionPtr watched;
+        if (tokens.toInt(1, id) && id > 0 && static_cast<uint32_t>(id) != game.id) {
+            std::lock_guard<std::mutex> lock(server.sessionsMutex);
+            auto found = server.sessionsById.find(static_cast<uint32_t>(id));
+            if (found != server.sessionsById.end()) {
+                watched = found->second.lock();
+            }
+        }
+        if (watched) {
+            std::shared_ptr<chessFeedSubscriber> subscriber = watched->feed.subscribe();
+            std::weak_ptr<ServerSession> weak = session;
+            // The reply goes out before the first frame: the I/O thread sends
+            // frames only once the text output is empty
+            std::lock_guard<std::mutex> lock(session->mutex);
+            session->output += "ok\n";
+            session->watching = subscriber;
+            subscriber->setReadyCallback([weak]() {
+                SessionPtr spectator = weak.lock();
+                if (spectator) {
+                    markDirty(spectator);
+                }
+            });
+            return true;
+        }
+    }
+    else if (tokens.is(0, "quit")) {
+        reply << "Thanks for playing!\n";
+        archiveGame(game.gameRecord);
+        std::lock_guard<std::mutex> lock(session->mutex);
+        session->closing = true;
+        session->commands.clear();
+        return true;
+    }
+    reply << INVALID_REPLY;
+    return true;
+}
+
+// Finish the move that waited for the engine
+void runEngineReply(const SessionPtr& session, const std::string& engineMove, std::ostream& reply) {
+    chessSession& game = session->game;
+    if (!engineMove.empty() && game.finishEngineMove(engineMove, reply)) {
+        reply << "ok " << engineMove << "\n";
+    }
+    else {
+        game.undoUserMove();
+        reply << INVALID_REPLY;
+    }
+}
+
+// Worker thread body: run scheduled sessions a batch of commands at a time
+void workerLoop() {
+    std::ostringstream reply;
+    std::string line;
+    while (true) {
+        SessionPtr session;
+        {
+            std::unique_lock<std::mutex> lock(server.readyMutex);
+            server.readyChanged.wait(lock, []() { return !server.ready.empty(); });
+            session = server.ready.front();
+            server.ready.pop_front();
+        }
+
+        for (int batch = 0; ; ++batch) {
+            bool haveEngineReply = false;
+            std::string engineMove;
+            {
+                std::lock_guard<std::mutex> lock(session->mutex);
+                if (session->engineDone) {
+                    haveEngineReply = true;
+                    engineMove.swap(session->engineMove);
+                    session->engineDone = false;
+                    session->awaitingEngine = false;
+                }
+                else if (session->awaitingEngine || session->commands.empty() || session->closing) {
+                    // Picked up again by the engine reply or the next command
+                    session->scheduled = false;
+                    break;
+                }
+                else if (batch >= SERVER_SESSION_BATCH) {
+                    // Back of the queue so one busy client cannot hold a worker
+                    session->scheduled = false;
+                    scheduleLocked(session);
+                    break;
+                }
+                else {
+                    line.swap(session->commands.front());
+                    session->commands.pop_front();
+                }
+            }
+
+            reply.str("");
+            if (haveEngineReply) {
+                runEngineReply(session, engineMove, reply);
+            }
+            else {
+                runCommand(session, &line[0], line.size(), reply);
+            }
+            std::string text = reply.str();
+            if (!text.empty()) {
+                std::lock_guard<std::mutex> lock(session->mutex);
+                session->output += text;
+            }
+            markDirty(session);
+        }
+    }
+}
+
+// Split received bytes into command lines; false when a line is too long
+bool receiveBytes(const SessionPtr& session, const char* data, size_t length) {
+    std::lock_guard<std::mutex> lock(session->mutex);
+    for (size_t i = 0; i < length; ++i) {
+        if (data[i] != '\n') {
+            session->input.push_back(data[i]);
+            if (session->input.size() > SERVER_MAX_LINE) {
+                return false;
+            }
+            continue;
+        }
+        if (!session->closing) {
+            session->commands.push_back(session->input);
+            scheduleLocked(session);
+        }
+        session->input.clear();
+    }
+    return true;
+}
+
+// Recompute a client's poll entry from its session; true once the session
+// is closing and everything has been sent (I/O thread)
+bool refreshPollEntry(ServerSession& session, pollfd& entry) {
+    std::lock_guard<std::mutex> lock(session.mutex);
+    // Text replies and feed frames alternate only between whole frames
+    if (session.sending.empty() && !session.frame && !session.output.empty()) {
+        session.sending.swap(session.output);
+        session.sent = 0;
+    }
+    if (session.watching) {
+        session.spectating = session.watching;
+    }
+    if (session.sending.empty() && !session.frame && session.spectating) {
+        session.frameSent = 0;
+        session.spectating->pop(session.frame);
+    }
+    // Stop reading from a client whose commands or replies pile up
+    bool backlog = session.commands.size() >= SERVER_MAX_PENDING
+        || session.output.size() + session.sending.size() > SERVER_MAX_OUTPUT;
+    entry.events = (backlog || session.closing ? 0 : POLLIN)
+        | (session.sending.empty() && !session.frame ? 0 : POLLOUT);
+    return session.closing && session.sending.empty() && session.output.empty();
+}
+
+// Accept every pending connection, adding each client to the poll set
+void acceptClients(SocketHandle listener, std::vector<pollfd>& polled, std::vector<SessionPtr>& polledSessions,
+    uint32_t& nextId) {
+    while (true) {
+        SocketHandle client = accept(listener, NULL, NULL);
+        if (client == INVALID_SOCKET) {
+            return;
+        }
+        if (polledSessions.size() >= server.options.maxSessions || !setNonBlocking(client)) {
+            const char* full = "Server full\n";
+            send(client, full, static_cast<int>(std::strlen(full)), SEND_FLAGS);
+            closeSocket(client);
+            continue;
+        }
+        SessionPtr session = std::make_shared<ServerSession>(nextId++);
+        session->output = "Session " + std::to_string(session->game.id) + "\n";
+        session->pollIndex = polledSessions.size();
+        pollfd entry;
+        entry.fd = client;
+        entry.events = 0;
+        entry.revents = 0;
+        polled.push_back(entry);
+        polledSessions.push_back(session);
+        refreshPollEntry(*session, polled.back());
+        std::lock_guard<std::mutex> lock(server.sessionsMutex);
+        server.sessionsById[session->game.id] = session;
+    }
+}
+
+// I/O thread: accept, read command lines, write replies. The poll set stays
+// between waits; only clients that had events or were marked dirty by a worker
+// get their entry updated
+void ioLoop() {
+    // Wake socket, listeners, then one entry per client
+    std::vector<pollfd> polled;
+    std::vector<SessionPtr> polledSessions;     // Session of each client entry
+    std::vector<SessionPtr> dirty;
+    std::vector<size_t> closed;
+    uint32_t nextId = 1;
+    char buffer[4096];
+
+    pollfd entry;
+    entry.fd = server.wakeSocket;
+    entry.events = POLLIN;
+    entry.revents = 0;
+    polled.push_back(entry);
+    for (SocketHandle listener : server.listeners) {
+        entry.fd = listener;
+        polled.push_back(entry);
+    }
+    const size_t first = polled.size();
+
+    while (true) {
+        if (pollSockets(polled, -1) < 0) {
+            continue;
+        }
+        if (polled[0].revents & POLLIN) {
+            // Drain before re-arming, or a wake sent meanwhile could be swallowed
+            while (recv(server.wakeSocket, buffer, static_cast<int>(sizeof(buffer)), 0) > 0) {
+            }
+            server.wakePending = false;
+        }
+        // Taken after re-arming: a session marked from now on wakes the next wait
+        {
+            std::lock_guard<std::mutex> lock(server.dirtyMutex);
+            dirty.swap(server.dirty);
+        }
+        for (size_t i = 0; i < server.listeners.size(); ++i) {
+            if (polled[1 + i].revents & POLLIN) {
+                acceptClients(server.listeners[i], polled, polledSessions, nextId);
+            }
+        }
+
+        closed.clear();
+        for (size_t i = 0; i < polledSessions.size(); ++i) {
+            pollfd& polledClient = polled[first + i];
+            if (polledClient.revents == 0) {
+                continue;
+            }
+            const SessionPtr& session = polledSessions[i];
+            bool drop = false;
+            if (polledClient.revents & POLLIN) {
+                int got = static_cast<int>(recv(polledClient.fd, buffer, static_cast<int>(sizeof(buffer)), 0));
+                if (got > 0) {
+                    drop = !receiveBytes(session, buffer, static_cast<size_t>(got));
+                }
+                else if (got == 0 || !wouldBlock()) {
+                    drop = true;
+                }
+            }
+            else if (polledClient.revents & (POLLERR | POLLHUP)) {
+                drop = true;
+            }
+            while (!drop && session->sent < session->sending.size()) {
+                int wrote = static_cast<int>(send(polledClient.fd, session->sending.data() + session->sent,
+                    static_cast<int>(session->sending.size() - session->sent), SEND_FLAGS));
+                if (wrote > 0) {
+                    session->sent += static_cast<size_t>(wrote);
+                }
+                else {
+                    drop = !wouldBlock();
+                    break;
+                }
+            }
+            if (session->sent == session->sending.size()) {
+                session->sending.clear();
+                session->sent = 0;
+            }
+            // Feed frames go out straight from the buffer every spectator shares
+            while (!drop && session->sending.empty() && session->frame) {
+                const std::vector<uint8_t>& bytes = *session->frame;
+                int wrote = static_cast<int>(send(polledClient.fd,
+                    reinterpret_cast<const char*>(bytes.data()) + session->frameSent,
+                    static_cast<int>(bytes.size() - session->frameSent), SEND_FLAGS));
+                if (wrote <= 0) {
+                    drop = !wouldBlock();
+                    break;
+                }
+                session->frameSent += static_cast<size_t>(wrote);
+                if (session->frameSent == bytes.size()) {
+                    session->frame.reset();
+                    session->frameSent = 0;
+                    // Queued text replies go first
+                    std::lock_guard<std::mutex> lock(session->mutex);
+                    if (session->output.empty()) {
+                        session->spectating->pop(session->frame);
+                    }
+                }
+            }
+
+            if (refreshPollEntry(*session, polledClient) || drop) {
+                closed.push_back(i);
+            }
+        }
+
+        for (const SessionPtr& session : dirty) {
+            // Cleared first: a later mark queues the session again
+            session->dirty = false;
+            if (session->pollIndex != NO_POLL_ENTRY && refreshPollEntry(*session, polled[first + session->pollIndex])) {
+                closed.push_back(session->pollIndex);
+            }
+        }
+        dirty.clear();
+
+        // The engine may still be busy for a closed session: its reply is dropped.
+        // Highest entry first, each replaced by the last one
+        std::sort(closed.begin(), closed.end());
+        closed.erase(std::unique(closed.begin(), closed.end()), closed.end());
+        for (auto it = closed.rbegin(); it != closed.rend(); ++it) {
+            size_t index = *it;
+            SessionPtr session = polledSessions[index];
+            {
+                std::lock_guard<std::mutex> lock(session->mutex);
+                session->closing = true;
+                session->commands.clear();
+            }
+            server.enginePool.cancelClient(static_cast<int>(session->game.id));
+            {
+                std::lock_guard<std::mutex> lock(server.sessionsMutex);
+                server.sessionsById.erase(session->game.id);
+            }
+            closeSocket(polled[first + index].fd);
+            session->pollIndex = NO_POLL_ENTRY;
+
+            polled[first + index] = polled.back();
+            polled.pop_back();
+            polledSessions[index] = polledSessions.back();
+            polledSessions.pop_back();
+            if (index < polledSessions.size()) {
+                polledSessions[index]->pollIndex = index;
+            }
+        }
+    }
+}
+
+// Main Entry Point
+int main(int argc, char* argv[])
+{
+    if (!parseOptions(argc, argv, server.options)) {
+        printUsage();
+        return -1;
+    }
+    ServerOptions& options = server.options;
+    if (options.workers <= 0) {
+        options.workers = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    }
+#ifdef _WIN32
+    WSADATA wsaData;
+    if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
+        std::cerr << "Cannot start Winsock" << std::endl;
+        return -1;
+    }
+#endif
+
+    SocketHandle listener = openListener(options);
+    server.wakeSocket = openWakeSocket();
+    if (listener == INVALID_SOCKET || server.wakeSocket == INVALID_SOCKET) {
+        std::cerr << "Cannot listen on " << (options.port > 0 ? "port " + std::to_string(options.port) : options.socketPath)
+            << std::endl;
+        return -1;
+    }
+    server.listeners.push_back(listener);
+    if (!options.archivePath.empty() && !server.archive.open(options.archivePath)) {
+        std::cerr << "Cannot open the archive " << options.archivePath << std::endl;
+        return -1;
+    }
+
+    // Engines are shared by every session; moves of different sessions are served round robin
+    std::vector<std::pair<std::string, std::string>> engineOptions;
+    engineOptions.push_back(std::make_pair("Threads", "1"));
+    if (!server.enginePool.start(options.enginePath, options.engines, engineOptions)) {
+        std::cerr << "Cannot start " << options.engines << " engines (" << options.enginePath << ")" << std::endl;
+        return -1;
+    }
+    server.goCommand = "go depth " + std::to_string(options.depth);
+
+    std::vector<std::thread> workers;
+    for (int i = 0; i < options.workers; ++i) {
+        workers.emplace_back(workerLoop);
+    }
+    std::cout << "Listening on " << (options.port > 0 ? "127.0.0.1:" + std::to_string(options.port) : options.socketPath)
+        << " with " << options.workers << " workers and " << options.engines << " engines" << std::endl;
+
+    // Serves until the process is stopped
+    ioLoop();
+    return 0;
+}
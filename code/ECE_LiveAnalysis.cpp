@@ -0,0 +1,241 @@
+/*
+Author: Botao Huang
+Class: ECE6122 (A)
+Last Date Modified: 10/19/2026
+Description:
+Code for live MultiPV analysis
+*/
+
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+#include "ECE_LiveAnalysis.h"
+
+// Engine output read per system call
+const size_t LIVE_READ_BUFFER = 8192;
+
+namespace {
+    // Next blank separated token, false at the end of the line
+    bool nextToken(char*& cursor, char*& token, size_t& length) {
+        while (*cursor == ' ' || *cursor == '\t') {
+            cursor++;
+        }
+        if (*cursor == '\0') {
+            return false;
+        }
+        token = cursor;
+        while (*cursor != '\0' && *cursor != ' ' && *cursor != '\t') {
+            cursor++;
+        }
+        length = cursor - token;
+        return true;
+    }
+
+    bool tokenIs(const char* token, size_t length, const char* word) {
+        return std::strlen(word) == length && std::strncmp(token, word, length) == 0;
+    }
+
+    // Parse "info ... pv ..." in place, false for lines without a principal variation
+    bool parseInfo(char* text, LiveInfoLine& line) {
+        if (std::strncmp(text, "info ", 5) != 0) {
+            return false;
+        }
+        line.multiPv = 1;
+        line.depth = 0;
+        line.score = 0;
+        line.isMate = false;
+        line.nodes = 0;
+        line.nps = 0;
+        line.pv[0] = '\0';
+
+        char* cursor = text + 5;
+        char* token;
+        size_t length;
+        while (nextToken(cursor, token, length)) {
+            if (tokenIs(token, length, "depth")) {
+                line.depth = static_cast<int>(std::strtol(cursor, &cursor, 10));
+            }
+            else if (tokenIs(token, length, "multipv")) {
+                line.multiPv = static_cast<int>(std::strtol(cursor, &cursor, 10));
+            }
+            else if (tokenIs(token, length, "score")) {
+                if (nextToken(cursor, token, length)) {
+                    line.isMate = tokenIs(token, length, "mate");
+                    line.score = static_cast<int>(std::strtol(cursor, &cursor, 10));
+                }
+            }
+            else if (tokenIs(token, length, "nodes")) {
+                line.nodes = std::strtoull(cursor, &cursor, 10);
+            }
+            else if (tokenIs(token, length, "nps")) {
+                line.nps = std::strtoull(cursor, &cursor, 10);
+            }
+            else if (tokenIs(token, length, "pv")) {
+                // The principal variation runs to the end of the line, cut on a move boundary
+                while (*cursor == ' ') {
+                    cursor++;
+                }
+                size_t count = std::strlen(cursor);
+                if (count >= static_cast<size_t>(LIVE_PV_CHARS)) {
+                    count = LIVE_PV_CHARS - 1;
+                    while (count > 0 && cursor[count] != ' ') {
+                        count--;
+                    }
+                }
+                std::memcpy(line.pv, cursor, count);
+                line.pv[count] = '\0';
+                return count > 0;
+            }
+            else if (tokenIs(token, length, "string")) {
+                return false;
+            }
+        }
+        return false;
+    }
+}
+
+// Constructor function
+ECE_LiveAnalysis::ECE_LiveAnalysis() : started(false), searching(false), multiPv(1),
+    searchesStarted(0), activeSearchId(0), linesParsed(0), linesCoalesced(0) {
+}
+
+// Destructor function
+ECE_LiveAnalysis::~ECE_LiveAnalysis() {
+    if (started) {
+        stop();
+        // The engine exiting closes its pipe, which ends the I/O thread
+        engine.quit();
+        ioThread.join();
+    }
+}
+
+// Spawn the analysis engine and its I/O thread
+bool ECE_LiveAnalysis::start(const std::string& enginePath) {
+    if (started) {
+        return true;
+    }
+    if (!engine.InitializeEngine(enginePath) || !engine.startUci() || !engine.waitReady()) {
+        std::cerr << "Live analysis engine failed to start" << std::endl;
+        return false;
+    }
+    ioThread = std::thread(&ECE_LiveAnalysis::readLoop, this);
+    started = true;
+    return true;
+}
+
+// Analyse the position after moveHistory with k principal variations
+void ECE_LiveAnalysis::analyse(const std::string& moveHistory, int k) {
+    if (!started) {
+        return;
+    }
+    // The stopped search still answers with "bestmove", which ends its id
+    stop();
+    k = std::max(1, std::min(LIVE_MAX_MULTIPV, k));
+    if (k != multiPv) {
+        engine.setOption("MultiPV", std::to_string(k));
+        multiPv = k;
+    }
+    activeSearchId = searchesStarted++;
+    engine.startSearch(moveHistory.empty() ? "position startpos" : "position startpos moves " + moveHistory,
+        "go infinite");
+    searching = true;
+}
+
+// Stop the running search
+void ECE_LiveAnalysis::stop() {
+    if (searching) {
+        engine.stopSearch();
+        searching = false;
+    }
+}
+
+// Fold the queued lines into the snapshot
+bool ECE_LiveAnalysis::drain(LiveSnapshot& snapshot) {
+    bool changed = false;
+    // Read once: analyse() may start another search meanwhile
+    uint32_t searchId = activeSearchId;
+    int lines = multiPv;
+    if (snapshot.searchId != searchId) {
+        snapshot.searchId = searchId;
+        snapshot.lineCount = 0;
+        changed = true;
+    }
+
+    LiveInfoLine line;
+    while (ring.pop(line)) {
+        if (line.searchId != searchId || line.multiPv < 1 || line.multiPv > lines) {
+            continue;
+        }
+        snapshot.lines[line.multiPv - 1] = line;
+        snapshot.lineCount = std::max(snapshot.lineCount, line.multiPv);
+        changed = true;
+    }
+    return changed;
+}
+
+// Read engine output and push parsed lines
+void ECE_LiveAnalysis::readLoop() {
+    char buffer[LIVE_READ_BUFFER];
+    size_t used = 0;
+    uint32_t searchId = 0;
+    // Latest line per principal variation that did not fit in the ring
+    LiveInfoLine pending[LIVE_MAX_MULTIPV];
+    bool pendingValid[LIVE_MAX_MULTIPV] = { false };
+    LiveInfoLine info;
+
+    while (true) {
+        size_t count = engine.readOutput(buffer + used, sizeof(buffer) - 1 - used);
+        if (count == 0) {
+            return;
+        }
+        used += count;
+
+        size_t lineStart = 0;
+        for (size_t i = used - count; i < used; ++i) {
+            if (buffer[i] != '\n') {
+                continue;
+            }
+            buffer[i] = '\0';
+            if (i > lineStart && buffer[i - 1] == '\r') {
+                buffer[i - 1] = '\0';
+            }
+            char* text = buffer + lineStart;
+            lineStart = i + 1;
+
+            if (std::strncmp(text, "bestmove", 8) == 0) {
+                // Whatever was still waiting belongs to the finished search
+                searchId++;
+                std::fill(pendingValid, pendingValid + LIVE_MAX_MULTIPV, false);
+                continue;
+            }
+            if (!parseInfo(text, info) || info.multiPv < 1 || info.multiPv > LIVE_MAX_MULTIPV) {
+                continue;
+            }
+            info.searchId = searchId;
+            linesParsed.fetch_add(1, std::memory_order_relaxed);
+
+            // A full ring means the render loop is behind, keep only the newest line per PV
+            int index = info.multiPv - 1;
+            if (pendingValid[index] || !ring.push(info)) {
+                if (pendingValid[index]) {
+                    linesCoalesced.fetch_add(1, std::memory_order_relaxed);
+                }
+                pending[index] = info;
+                pendingValid[index] = true;
+            }
+        }
+
+        // Keep the partial last line, drop one that can never fit
+        std::memmove(buffer, buffer + lineStart, used - lineStart);
+        used -= lineStart;
+        if (used == sizeof(buffer) - 1) {
+            used = 0;
+        }
+
+        for (int index = 0; index < LIVE_MAX_MULTIPV; ++index) {
+            if (pendingValid[index] && ring.push(pending[index])) {
+                pendingValid[index] = false;
+            }
+        }
+    }
+}
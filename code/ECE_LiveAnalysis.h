@@ -0,0 +1,90 @@
+/*
+Author: Botao Huang
+Class: ECE6122 (A)
+Last Date Modified: 10/19/2026
+Description:
+Header file for live MultiPV analysis
+A dedicated engine runs "go infinite"; its I/O thread parses info lines into
+a lock-free ring that the render loop drains into a snapshot each frame
+*/
+
+#ifndef ECE_LIVEANALYSIS_H
+#define ECE_LIVEANALYSIS_H
+
+#include <string>
+#include <thread>
+#include <atomic>
+#include <cstdint>
+#include "ECE_ChessEngine.h"
+#include "ECE_RingBuffer.h"
+
+// Most principal variations shown at once
+const int LIVE_MAX_MULTIPV = 8;
+// Characters of a principal variation kept per line
+const int LIVE_PV_CHARS = 256;
+// Info lines buffered between the I/O thread and the render loop
+const size_t LIVE_RING_CAPACITY = 1024;
+
+// One parsed "info ... pv ..." line (plain data, copied through the ring)
+struct LiveInfoLine {
+    uint32_t searchId;   // Lines of a stopped search are discarded
+    int multiPv;         // 1 based
+    int depth;
+    int score;           // Centipawns, or moves to mate when isMate (side to move)
+    bool isMate;
+    uint64_t nodes;
+    uint64_t nps;
+    char pv[LIVE_PV_CHARS];
+};
+
+// Latest line for every principal variation of the current search
+struct LiveSnapshot {
+    uint32_t searchId;
+    int lineCount;
+    LiveInfoLine lines[LIVE_MAX_MULTIPV];
+
+    LiveSnapshot() : searchId(0), lineCount(0) {}
+};
+
+class ECE_LiveAnalysis {
+private:
+    ECE_ChessEngine engine;
+    std::thread ioThread;
+    // Set by the game thread, read by the render loop
+    std::atomic<bool> started;
+    std::atomic<bool> searching;
+    std::atomic<int> multiPv;
+
+    ECE_RingBuffer<LiveInfoLine, LIVE_RING_CAPACITY> ring;
+    // Search ids: the I/O thread counts "bestmove" lines, the game thread counts "go" commands
+    uint32_t searchesStarted;
+    std::atomic<uint32_t> activeSearchId;
+    // Statistics (written by the I/O thread)
+    std::atomic<uint64_t> linesParsed;
+    std::atomic<uint64_t> linesCoalesced;
+
+public:
+    ECE_LiveAnalysis();
+    ~ECE_LiveAnalysis();
+
+    // Spawn the analysis engine and its I/O thread
+    bool start(const std::string& enginePath);
+    bool isStarted() const { return started; }
+    // Analyse the position after moveHistory with k principal variations (restarts a running search)
+    void analyse(const std::string& moveHistory, int k);
+    // Stop the running search, the snapshot keeps its last lines
+    void stop();
+    bool isSearching() const { return searching; }
+
+    // Render loop: fold the queued lines into the snapshot, true when it changed
+    bool drain(LiveSnapshot& snapshot);
+
+    uint64_t getLinesParsed() const { return linesParsed.load(std::memory_order_relaxed); }
+    uint64_t getLinesCoalesced() const { return linesCoalesced.load(std::memory_order_relaxed); }
+
+private:
+    // I/O thread: read engine output and push parsed lines
+    void readLoop();
+};
+
+#endif
@@ -0,0 +1,134 @@
+/*
+Author: Botao Huang
+Class: ECE6122 (A)
+Last Date Modified: 10/19/2026
+Description:
+Code for memory mapped files
+*/
+
+#include <windows.h>
+#include <iostream>
+#include "ECE_MappedFile.h"
+
+// Constructor function
+ECE_MappedFile::ECE_MappedFile() : hFile(INVALID_HANDLE_VALUE), hMapping(NULL), view(NULL), viewSize(0), writable(false) {
+}
+
+// Destructor function
+ECE_MappedFile::~ECE_MappedFile() {
+    close();
+}
+
+// Open an existing file read only and map all of it
+bool ECE_MappedFile::openReadOnly(const std::string& path) {
+    close();
+    writable = false;
+
+    // Share write access so readers can follow a file another process appends to
+    hFile = CreateFile(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+        NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (hFile == INVALID_HANDLE_VALUE) {
+        std::cerr << "Failed to open " << path << std::endl;
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(hFile, &fileSize) || fileSize.QuadPart == 0) {
+        close();
+        return false;
+    }
+    return mapView(static_cast<uint64_t>(fileSize.QuadPart));
+}
+
+// Open (or create) a file for read/write, growing it to at least minSize bytes
+bool ECE_MappedFile::openReadWrite(const std::string& path, uint64_t minSize) {
+    close();
+    writable = true;
+
+    hFile = CreateFile(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE,
+        NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (hFile == INVALID_HANDLE_VALUE) {
+        std::cerr << "Failed to open " << path << std::endl;
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(hFile, &fileSize)) {
+        close();
+        return false;
+    }
+
+    // The mapping grows the file when it is larger than the file itself
+    uint64_t mapSize = static_cast<uint64_t>(fileSize.QuadPart);
+    if (mapSize < minSize) {
+        mapSize = minSize;
+    }
+    return mapView(mapSize);
+}
+
+// Map the whole file with the current access mode
+bool ECE_MappedFile::mapView(uint64_t mapSize) {
+    hMapping = CreateFileMapping(hFile, NULL, writable ? PAGE_READWRITE : PAGE_READONLY,
+        static_cast<DWORD>(mapSize >> 32), static_cast<DWORD>(mapSize & 0xFFFFFFFF), NULL);
+    if (hMapping == NULL) {
+        std::cerr << "Failed to create file mapping" << std::endl;
+        close();
+        return false;
+    }
+
+    view = MapViewOfFile(hMapping, writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, 0);
+    if (view == NULL) {
+        std::cerr << "Failed to map view of file" << std::endl;
+        close();
+        return false;
+    }
+    viewSize = mapSize;
+    return true;
+}
+
+// Unmap and close
+void ECE_MappedFile::close() {
+    if (view != NULL) {
+        UnmapViewOfFile(view);
+        view = NULL;
+    }
+    if (hMapping != NULL) {
+        CloseHandle(hMapping);
+        hMapping = NULL;
+    }
+    if (hFile != INVALID_HANDLE_VALUE) {
+        CloseHandle(hFile);
+        hFile = INVALID_HANDLE_VALUE;
+    }
+    viewSize = 0;
+}
+
+// Write dirty pages back to disk
+void ECE_MappedFile::flush() {
+    if (view != NULL && writable) {
+        FlushViewOfFile(view, 0);
+    }
+}
+
+// Lock a byte range of the file
+bool ECE_MappedFile::lockRange(uint64_t offset, uint64_t length, bool exclusive, bool wait) {
+    if (hFile == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    OVERLAPPED overlapped = {};
+    overlapped.Offset = static_cast<DWORD>(offset & 0xFFFFFFFF);
+    overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+    DWORD flags = (exclusive ? LOCKFILE_EXCLUSIVE_LOCK : 0) | (wait ? 0 : LOCKFILE_FAIL_IMMEDIATELY);
+    return LockFileEx(hFile, flags, 0, static_cast<DWORD>(length & 0xFFFFFFFF), static_cast<DWORD>(length >> 32),
+        &overlapped) != FALSE;
+}
+
+void ECE_MappedFile::unlockRange(uint64_t offset, uint64_t length) {
+    if (hFile == INVALID_HANDLE_VALUE) {
+        return;
+    }
+    OVERLAPPED overlapped = {};
+    overlapped.Offset = static_cast<DWORD>(offset & 0xFFFFFFFF);
+    overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+    UnlockFileEx(hFile, 0, static_cast<DWORD>(length & 0xFFFFFFFF), static_cast<DWORD>(length >> 32), &overlapped);
+}
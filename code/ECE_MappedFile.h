@@ -0,0 +1,53 @@
+/*
+Author: Botao Huang
+Class: ECE6122 (A)
+Last Date Modified: 10/19/2026
+Description:
+Header file for memory mapped files
+Thin wrapper over the Win32 file mapping calls
+*/
+
+#ifndef ECE_MAPPEDFILE_H
+#define ECE_MAPPEDFILE_H
+
+#include <windows.h>
+#include <string>
+#include <cstdint>
+
+class ECE_MappedFile {
+private:
+    HANDLE hFile;
+    HANDLE hMapping;
+    void* view;
+    uint64_t viewSize;
+    bool writable;
+
+public:
+    ECE_MappedFile();
+    ~ECE_MappedFile();
+
+    // Open an existing file read only and map all of it
+    bool openReadOnly(const std::string& path);
+    // Open (or create) a file for read/write, growing it to at least minSize bytes
+    bool openReadWrite(const std::string& path, uint64_t minSize);
+    // Unmap and close
+    void close();
+    // Write dirty pages back to disk
+    void flush();
+    // Lock a byte range of the file (shared or exclusive); without wait fails at
+    // once when another handle holds a conflicting lock. Closing releases it
+    bool lockRange(uint64_t offset, uint64_t length, bool exclusive, bool wait);
+    void unlockRange(uint64_t offset, uint64_t length);
+
+    bool isOpen() const { return view != NULL; }
+    uint8_t* data() const { return static_cast<uint8_t*>(view); }
+    uint64_t size() const { return viewSize; }
+
+private:
+    ECE_MappedFile(const ECE_MappedFile&);
+    ECE_MappedFile& operator=(const ECE_MappedFile&);
+    // Map the whole file with the current access mode
+    bool mapView(uint64_t mapSize);
+};
+
+#endif
@@ -0,0 +1,562 @@
+/*
+Author: Botao Huang
+Class: ECE6122 (A)
+Last Date Modified: 10/19/2026
+Description:
+Headless engine-vs-engine match runner
+Plays many games in parallel between two engine configurations, adjudicates
+with chessPosition, logs PGN and/or binary records and reports live Elo and SPRT
+*/
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+#include "ECE_ChessEngine.h"
+#include "chessEpd.h"
+#include "chessPosition.h"
+
+// Binary log identification
+const char MATCH_MAGIC[8] = { 'E', 'C', 'E', 'M', 'A', 'T', 'C', 'H' };
+const uint32_t MATCH_VERSION = 1;
+const char* START_FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+// Game outcome from white's point of view
+enum GameResult { RESULT_WHITE_WIN = 0, RESULT_DRAW = 1, RESULT_BLACK_WIN = 2 };
+
+// How a game ended
+enum Termination {
+    TERMINATION_CHECKMATE = 0,
+    TERMINATION_STALEMATE,
+    TERMINATION_FIFTY_MOVES,
+    TERMINATION_REPETITION,
+    TERMINATION_INSUFFICIENT_MATERIAL,
+    TERMINATION_MAX_PLIES,
+    TERMINATION_TIME_FORFEIT,
+    TERMINATION_ILLEGAL_MOVE,
+    TERMINATION_ENGINE_FAILURE
+};
+const char* TERMINATION_NAMES[] = { "checkmate", "stalemate", "fifty move rule", "threefold repetition",
+    "insufficient material", "max plies", "time forfeit", "illegal move", "engine failure" };
+// PGN Termination tag values
+const char* TERMINATION_TAGS[] = { "normal", "normal", "normal", "normal",
+    "normal", "adjudication", "time forfeit", "rules infraction", "abandoned" };
+
+// One side of the match
+struct EngineConfig {
+    std::string command;
+    std::string name;
+    std::vector<std::pair<std::string, std::string>> options;
+};
+
+// Command line settings
+struct MatchOptions {
+    EngineConfig engines[2];
+    std::string openingsPath;
+    int games = 100;
+    int concurrency = 0;          // 0: hardware threads x games per core
+    int gamesPerCore = 1;
+    int baseMs = 10000;           // Time control base and increment
+    int incrementMs = 100;
+    int movetimeMs = 0;           // Fixed time per move instead of a clock
+    int marginMs = 50;            // Clock overrun tolerated before a time forfeit
+    int graceMs = 1000;           // Wait for bestmove after a watchdog "stop" before killing the engine
+    int maxPlies = 600;
+    std::string pgnPath;
+    std::string binaryPath;
+    bool sprt = false;
+    double elo0 = 0.0;
+    double elo1 = 5.0;
+    double alpha = 0.05;
+    double beta = 0.05;
+};
+
+// One finished game
+struct GameRecord {
+    int round = 0;
+    std::string fen;
+    int whiteEngine = 0;
+    GameResult result = RESULT_DRAW;
+    Termination termination = TERMINATION_MAX_PLIES;
+    std::vector<uint16_t> moves;
+    std::vector<std::string> san;
+    int failedEngine = -1;        // Engine to restart after a failure
+};
+
+// Print usage
+void printUsage() {
+    std::cerr << "Usage: ECE_MatchRunner --engine1 \"cmd\" --engine2 \"cmd\" [--name1 N] [--name2 N]\n"
+        << "       [--option1 Name=Value]... [--option2 Name=Value]... [--openings file.epd]\n"
+        << "       [--games N] [--concurrency N | --games-per-core N] [--tc 10+0.1 | --movetime MS]\n"
+        << "       [--margin MS] [--grace MS] [--max-plies N] [--pgn out.pgn] [--binary out.bin]\n"
+        << "       [--sprt ELO0 ELO1] [--alpha A] [--beta B]" << std::endl;
+}
+
+// "Name=Value" into an option pair
+bool parseEngineOption(const std::string& text, std::vector<std::pair<std::string, std::string>>& options) {
+    size_t equals = text.find('=');
+    if (equals == std::string::npos || equals == 0) {
+        return false;
+    }
+    options.push_back(std::make_pair(text.substr(0, equals), text.substr(equals + 1)));
+    return true;
+}
+
+// Parse the command line
+bool parseOptions(int argc, char* argv[], MatchOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string option = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (option == "--engine1" && hasValue) options.engines[0].command = argv[++i];
+        else if (option == "--engine2" && hasValue) options.engines[1].command = argv[++i];
+        else if (option == "--name1" && hasValue) options.engines[0].name = argv[++i];
+        else if (option == "--name2" && hasValue) options.engines[1].name = argv[++i];
+        else if (option == "--option1" && hasValue) {
+            if (!parseEngineOption(argv[++i], options.engines[0].options)) return false;
+        }
+        else if (option == "--option2" && hasValue) {
+            if (!parseEngineOption(argv[++i], options.engines[1].options)) return false;
+        }
+        else if (option == "--openings" && hasValue) options.openingsPath = argv[++i];
+        else if (option == "--games" && hasValue) options.games = std::atoi(argv[++i]);
+        else if (option == "--concurrency" && hasValue) options.concurrency = std::atoi(argv[++i]);
+        else if (option == "--games-per-core" && hasValue) options.gamesPerCore = std::atoi(argv[++i]);
+        else if (option == "--tc" && hasValue) {
+            // "base+increment" in seconds
+            std::string tc = argv[++i];
+            size_t plus = tc.find('+');
+            options.baseMs = static_cast<int>(std::atof(tc.substr(0, plus).c_str()) * 1000);
+            options.incrementMs = plus == std::string::npos ? 0 : static_cast<int>(std::atof(tc.substr(plus + 1).c_str()) * 1000);
+        }
+        else if (option == "--movetime" && hasValue) options.movetimeMs = std::atoi(argv[++i]);
+        else if (option == "--margin" && hasValue) options.marginMs = std::atoi(argv[++i]);
+        else if (option == "--grace" && hasValue) options.graceMs = std::atoi(argv[++i]);
+        else if (option == "--max-plies" && hasValue) options.maxPlies = std::atoi(argv[++i]);
+        else if (option == "--pgn" && hasValue) options.pgnPath = argv[++i];
+        else if (option == "--binary" && hasValue) options.binaryPath = argv[++i];
+        else if (option == "--sprt" && i + 2 < argc) {
+            options.sprt = true;
+            options.elo0 = std::atof(argv[++i]);
+            options.elo1 = std::atof(argv[++i]);
+        }
+        else if (option == "--alpha" && hasValue) options.alpha = std::atof(argv[++i]);
+        else if (option == "--beta" && hasValue) options.beta = std::atof(argv[++i]);
+        else return false;
+    }
+    for (int e = 0; e < 2; ++e) {
+        if (options.engines[e].name.empty()) {
+            options.engines[e].name = "engine" + std::to_string(e + 1);
+        }
+    }
+    return !options.engines[0].command.empty() && !options.engines[1].command.empty() && options.games > 0;
+}
+
+// Spawn and configure one engine, NULL when it does not come up
+std::unique_ptr<ECE_ChessEngine> startEngine(const EngineConfig& config) {
+    std::unique_ptr<ECE_ChessEngine> engine(new ECE_ChessEngine());
+    if (!engine->InitializeEngine(config.command) || !engine->startUci()) {
+        return NULL;
+    }
+    for (const auto& option : config.options) {
+        engine->setOption(option.first, option.second);
+    }
+    if (!engine->waitReady()) {
+        return NULL;
+    }
+    return engine;
+}
+
+// Run one search; a watchdog sends "stop" once budgetMs have passed and kills the
+// engine when no bestmove follows within graceMs (the search then fails)
+bool searchWithWatchdog(ECE_ChessEngine& engine, const std::string& positionCommand, const std::string& goCommand,
+    int budgetMs, int graceMs, EngineAnalysis& analysis, bool& stopSent) {
+    std::mutex watchMutex;
+    std::condition_variable watchWake;
+    bool answered = false;
+    stopSent = false;
+
+    std::thread watchdog([&]() {
+        std::unique_lock<std::mutex> lock(watchMutex);
+        if (watchWake.wait_for(lock, std::chrono::milliseconds(budgetMs), [&answered] { return answered; })) {
+            return;
+        }
+        stopSent = true;
+        lock.unlock();
+        engine.stopSearch();
+        lock.lock();
+        if (watchWake.wait_for(lock, std::chrono::milliseconds(graceMs), [&answered] { return answered; })) {
+            return;
+        }
+        lock.unlock();
+        // Hung: once the process is gone the blocked read fails
+        engine.quit();
+    });
+
+    engine.startSearch(positionCommand, goCommand);
+    auto onAnswer = [&]() {
+        std::lock_guard<std::mutex> lock(watchMutex);
+        answered = true;
+        watchWake.notify_one();
+    };
+    bool found = engine.waitBestMove(analysis, InfoCallback(), onAnswer);
+    onAnswer();
+    watchdog.join();
+    return found;
+}
+
+// Play one game; engines[0] is engine1, record.whiteEngine says who has white
+void playGame(std::unique_ptr<ECE_ChessEngine> engines[2], const MatchOptions& options, GameRecord& record) {
+    chessPosition position;
+    position.setFromFen(record.fen);
+    std::vector<uint64_t> keys(1, position.zobristKey());
+    std::string moveList;
+    int remainingMs[2] = { options.baseMs, options.baseMs };   // White, black
+    std::vector<uint16_t> legalMoves;
+
+    for (int e = 0; e < 2; ++e) {
+        if (!engines[e]->newGame()) {
+            record.failedEngine = e;
+        }
+    }
+
+    auto loseFor = [&record](bool whiteLost, Termination termination) {
+        record.result = whiteLost ? RESULT_BLACK_WIN : RESULT_WHITE_WIN;
+        record.termination = termination;
+    };
+    if (record.failedEngine >= 0) {
+        loseFor(record.failedEngine == record.whiteEngine, TERMINATION_ENGINE_FAILURE);
+        return;
+    }
+
+    while (true) {
+        // Adjudicate with the rules before asking for a move
+        position.generateLegalMoves(legalMoves);
+        if (legalMoves.empty()) {
+            if (position.inCheck()) {
+                loseFor(position.whiteToMove, TERMINATION_CHECKMATE);
+            }
+            else {
+                record.result = RESULT_DRAW;
+                record.termination = TERMINATION_STALEMATE;
+            }
+            return;
+        }
+        Termination draw = TERMINATION_MAX_PLIES;
+        bool isDraw = true;
+        if (position.halfMoveClock >= 100) draw = TERMINATION_FIFTY_MOVES;
+        else if (std::count(keys.begin(), keys.end(), keys.back()) >= 3) draw = TERMINATION_REPETITION;
+        else if (position.insufficientMaterial()) draw = TERMINATION_INSUFFICIENT_MATERIAL;
+        else if (static_cast<int>(record.moves.size()) >= options.maxPlies) draw = TERMINATION_MAX_PLIES;
+        else isDraw = false;
+        if (isDraw) {
+            record.result = RESULT_DRAW;
+            record.termination = draw;
+            return;
+        }
+
+        int side = position.whiteToMove ? 0 : 1;
+        int engineIndex = (side == 0) ? record.whiteEngine : 1 - record.whiteEngine;
+        std::ostringstream goCommand;
+        if (options.movetimeMs > 0) {
+            goCommand << "go movetime " << options.movetimeMs;
+        }
+        else {
+            goCommand << "go wtime " << std::max(0, remainingMs[0]) << " btime " << std::max(0, remainingMs[1])
+                << " winc " << options.incrementMs << " binc " << options.incrementMs;
+        }
+
+        // Past its clock (or movetime) and the margin the engine is told to stop
+        int budgetMs = (options.movetimeMs > 0 ? options.movetimeMs : std::max(0, remainingMs[side])) + options.marginMs;
+        EngineAnalysis analysis;
+        bool stopSent = false;
+        auto start = std::chrono::steady_clock::now();
+        bool answered = searchWithWatchdog(*engines[engineIndex],
+            "position fen " + record.fen + (moveList.empty() ? "" : " moves " + moveList), goCommand.str(),
+            budgetMs, options.graceMs, analysis, stopSent);
+        int elapsedMs = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start).count());
+
+        if (!answered) {
+            // Killed by the watchdog, or died on its own
+            record.failedEngine = engineIndex;
+            loseFor(side == 0, stopSent && options.movetimeMs == 0 ? TERMINATION_TIME_FORFEIT : TERMINATION_ENGINE_FAILURE);
+            return;
+        }
+        if (options.movetimeMs == 0) {
+            remainingMs[side] -= elapsedMs;
+            if (remainingMs[side] < -options.marginMs) {
+                loseFor(side == 0, TERMINATION_TIME_FORFEIT);
+                return;
+            }
+            remainingMs[side] += options.incrementMs;
+        }
+
+        uint16_t move = chessPosition::packUciMove(analysis.bestMove);
+        if (std::find(legalMoves.begin(), legalMoves.end(), move) == legalMoves.end()) {
+            loseFor(side == 0, TERMINATION_ILLEGAL_MOVE);
+            return;
+        }
+
+        record.san.push_back(position.toSan(move));
+        record.moves.push_back(move);
+        position.applyMove(move);
+        keys.push_back(position.zobristKey());
+        moveList += (moveList.empty() ? "" : " ") + analysis.bestMove;
+    }
+}
+
+// Result tag
+const char* resultText(GameResult result) {
+    return result == RESULT_WHITE_WIN ? "1-0" : (result == RESULT_BLACK_WIN ? "0-1" : "1/2-1/2");
+}
+
+// Append one game in PGN
+void writePgn(std::ostream& out, const GameRecord& record, const MatchOptions& options) {
+    char date[16];
+    std::time_t now = std::time(NULL);
+    std::strftime(date, sizeof(date), "%Y.%m.%d", std::localtime(&now));
+
+    out << "[Event \"ECE match\"]\n[Site \"?\"]\n[Date \"" << date << "\"]\n[Round \"" << record.round << "\"]\n"
+        << "[White \"" << options.engines[record.whiteEngine].name << "\"]\n"
+        << "[Black \"" << options.engines[1 - record.whiteEngine].name << "\"]\n"
+        << "[Result \"" << resultText(record.result) << "\"]\n";
+    if (record.fen != START_FEN) {
+        out << "[SetUp \"1\"]\n[FEN \"" << record.fen << "\"]\n";
+    }
+    if (options.movetimeMs > 0) {
+        out << "[TimeControl \"" << options.movetimeMs / 1000.0 << "/move\"]\n";
+    }
+    else {
+        out << "[TimeControl \"" << options.baseMs / 1000.0 << "+" << options.incrementMs / 1000.0 << "\"]\n";
+    }
+    out << "[PlyCount \"" << record.moves.size() << "\"]\n"
+        << "[Termination \"" << TERMINATION_TAGS[record.termination] << "\"]\n\n";
+
+    // Move text, wrapped below 80 columns
+    chessPosition position;
+    position.setFromFen(record.fen);
+    bool whiteMoves = position.whiteToMove;
+    int moveNumber = position.fullMoveNumber;
+    std::string line;
+    auto emit = [&out, &line](const std::string& token) {
+        if (line.size() + token.size() + 1 > 79) {
+            out << line << '\n';
+            line.clear();
+        }
+        line += (line.empty() ? "" : " ") + token;
+    };
+    for (size_t i = 0; i < record.san.size(); ++i) {
+        if (whiteMoves) emit(std::to_string(moveNumber) + ".");
+        else if (i == 0) emit(std::to_string(moveNumber) + "...");
+        emit(record.san[i]);
+        if (!whiteMoves) moveNumber++;
+        whiteMoves = !whiteMoves;
+    }
+    emit(std::string("{") + TERMINATION_NAMES[record.termination] + "}");
+    emit(resultText(record.result));
+    out << line << "\n\n";
+}
+
+// Append one game as a binary record (host byte order)
+void writeBinary(std::ostream& out, const GameRecord& record) {
+    uint32_t round = static_cast<uint32_t>(record.round);
+    uint8_t header[4] = { static_cast<uint8_t>(record.result), static_cast<uint8_t>(record.termination),
+        static_cast<uint8_t>(record.whiteEngine == 0 ? 1 : 0), 0 };
+    uint16_t plies = static_cast<uint16_t>(record.moves.size());
+    uint16_t fenLength = static_cast<uint16_t>(record.fen.size());
+    out.write(reinterpret_cast<const char*>(&round), sizeof(round));
+    out.write(reinterpret_cast<const char*>(header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(&plies), sizeof(plies));
+    out.write(reinterpret_cast<const char*>(&fenLength), sizeof(fenLength));
+    out.write(record.fen.data(), fenLength);
+    if (plies > 0) {
+        out.write(reinterpret_cast<const char*>(&record.moves[0]), plies * sizeof(uint16_t));
+    }
+}
+
+// Running score of engine1 with Elo and SPRT estimates
+struct MatchStats {
+    int wins = 0;
+    int draws = 0;
+    int losses = 0;
+
+    int games() const { return wins + draws + losses; }
+
+    // Score fraction and per game variance
+    void score(double& mean, double& variance) const {
+        double n = games();
+        mean = (wins + 0.5 * draws) / n;
+        variance = (wins * (1.0 - mean) * (1.0 - mean) + draws * (0.5 - mean) * (0.5 - mean)
+            + losses * mean * mean) / n;
+    }
+
+    static double eloFromScore(double s) {
+        s = std::min(std::max(s, 1e-6), 1.0 - 1e-6);
+        return -400.0 * std::log10(1.0 / s - 1.0);
+    }
+
+    static double scoreFromElo(double elo) {
+        return 1.0 / (1.0 + std::pow(10.0, -elo / 400.0));
+    }
+
+    // Elo difference with its 95% error margin
+    void elo(double& diff, double& margin) const {
+        double mean, variance;
+        score(mean, variance);
+        double error = 1.96 * std::sqrt(variance / games());
+        diff = eloFromScore(mean);
+        margin = (eloFromScore(mean + error) - eloFromScore(mean - error)) / 2.0;
+    }
+
+    // Log likelihood ratio of elo1 against elo0 (normal approximation)
+    double llr(double elo0, double elo1) const {
+        double mean, variance;
+        score(mean, variance);
+        if (variance <= 0.0) {
+            return 0.0;
+        }
+        double s0 = scoreFromElo(elo0), s1 = scoreFromElo(elo1);
+        return games() * (s1 - s0) * (2.0 * mean - s0 - s1) / (2.0 * variance);
+    }
+};
+
+// Main Entry Point
+int main(int argc, char* argv[])
+{
+    MatchOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage();
+        return -1;
+    }
+    if (options.concurrency <= 0) {
+        options.concurrency = static_cast<int>(std::max(1u, std::thread::hardware_concurrency())) * std::max(1, options.gamesPerCore);
+    }
+    options.concurrency = std::min(options.concurrency, options.games);
+
+    // Openings, each played twice with colours reversed
+    std::vector<std::string> openings;
+    if (!options.openingsPath.empty()) {
+        std::ifstream input(options.openingsPath);
+        if (!input) {
+            std::cerr << "Cannot open " << options.openingsPath << std::endl;
+            return -1;
+        }
+        std::string line, error;
+        EpdRecord record;
+        while (std::getline(input, line)) {
+            if (parseEpdLine(line, record, error)) {
+                openings.push_back(record.fen);
+            }
+        }
+    }
+    if (openings.empty()) {
+        openings.push_back(START_FEN);
+    }
+
+    std::ofstream pgn, binary;
+    if (!options.pgnPath.empty()) {
+        pgn.open(options.pgnPath, std::ios::binary);
+    }
+    if (!options.binaryPath.empty()) {
+        binary.open(options.binaryPath, std::ios::binary);
+        binary.write(MATCH_MAGIC, sizeof(MATCH_MAGIC));
+        binary.write(reinterpret_cast<const char*>(&MATCH_VERSION), sizeof(MATCH_VERSION));
+    }
+    if ((!options.pgnPath.empty() && !pgn) || (!options.binaryPath.empty() && !binary)) {
+        std::cerr << "Cannot create the game log" << std::endl;
+        return -1;
+    }
+
+    double lowerBound = std::log(options.beta / (1.0 - options.alpha));
+    double upperBound = std::log((1.0 - options.beta) / options.alpha);
+
+    std::cout << options.engines[0].name << " vs " << options.engines[1].name << ": " << options.games
+        << " games, " << options.concurrency << " in parallel, " << openings.size() << " openings" << std::endl;
+
+    std::mutex resultMutex;
+    MatchStats stats;
+    std::atomic<int> nextGame(0);
+    std::atomic<bool> stopMatch(false);
+    auto startTime = std::chrono::steady_clock::now();
+
+    // One worker per concurrent game, each owning a pair of engines
+    auto worker = [&]() {
+        std::unique_ptr<ECE_ChessEngine> engines[2];
+        while (!stopMatch) {
+            int game = nextGame++;
+            if (game >= options.games) {
+                return;
+            }
+            for (int e = 0; e < 2; ++e) {
+                if (!engines[e]) {
+                    engines[e] = startEngine(options.engines[e]);
+                    if (!engines[e]) {
+                        std::cerr << "Cannot start " << options.engines[e].command << std::endl;
+                        stopMatch = true;
+                        return;
+                    }
+                }
+            }
+
+            GameRecord record;
+            record.round = game + 1;
+            record.fen = openings[(game / 2) % openings.size()];
+            record.whiteEngine = game % 2;
+            playGame(engines, options, record);
+            if (record.failedEngine >= 0) {
+                engines[record.failedEngine].reset();
+            }
+
+            std::lock_guard<std::mutex> lock(resultMutex);
+            bool engine1White = record.whiteEngine == 0;
+            if (record.result == RESULT_DRAW) stats.draws++;
+            else if ((record.result == RESULT_WHITE_WIN) == engine1White) stats.wins++;
+            else stats.losses++;
+
+            if (pgn.is_open()) writePgn(pgn, record, options);
+            if (binary.is_open()) writeBinary(binary, record);
+
+            double diff, margin;
+            stats.elo(diff, margin);
+            std::cout << "Game " << record.round << " " << resultText(record.result) << " ("
+                << TERMINATION_NAMES[record.termination] << ") | " << stats.games() << " played: +" << stats.wins
+                << " =" << stats.draws << " -" << stats.losses << " | Elo " << std::fixed << std::setprecision(1)
+                << diff << " +/- " << margin;
+            if (options.sprt) {
+                double llr = stats.llr(options.elo0, options.elo1);
+                std::cout << " | LLR " << std::setprecision(2) << llr << " [" << lowerBound << ", " << upperBound << "]";
+                if (llr >= upperBound || llr <= lowerBound) {
+                    std::cout << (llr >= upperBound ? " H1 accepted" : " H0 accepted");
+                    stopMatch = true;
+                }
+            }
+            std::cout << '\n';
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (int i = 0; i < options.concurrency; ++i) {
+        workers.push_back(std::thread(worker));
+    }
+    for (auto& thread : workers) {
+        thread.join();
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    std::cout << stats.games() << " games in " << std::fixed << std::setprecision(1) << seconds << " s ("
+        << (seconds > 0 ? stats.games() * 3600.0 / seconds : 0.0) << " games/hour)" << std::endl;
+    return 0;
+}
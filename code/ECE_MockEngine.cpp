@@ -0,0 +1,213 @@
+/*
+Author: Botao Huang
+Class: ECE6122 (A)
+Last Date Modified: 10/19/2026
+Description:
+Scriptable stand-in UCI engine for tests and benchmarks
+Think time, info line rate, output chunking and the bestmove sequence are
+set on the command line; without a script it plays a legal move
+*/
+
+#include <string>
+#include <vector>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include "chessPosition.h"
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#endif
+
+// Command line settings
+struct MockOptions {
+    int thinkMs = 0;           // Search time when "go" has no movetime
+    int infoRate = 0;          // Info lines per second while thinking
+    int infoBurst = 3;         // Info lines written right before bestmove
+    size_t chunkBytes = 0;     // Flush output every N bytes (0: whole lines)
+    int chunkDelayUs = 0;      // Pause between chunks
+    std::vector<std::string> script;   // Bestmoves to play, in order
+};
+
+MockOptions options;
+std::mutex outputMutex;
+chessPosition position;
+size_t scriptIndex = 0;
+uint64_t searchCount = 0;
+
+// Print usage
+void printUsage() {
+    std::cerr << "Usage: ECE_MockEngine [--think MS] [--info-rate N] [--info-burst N]\n"
+        << "       [--chunk BYTES] [--chunk-delay US] [--script e7e5,g8f6,...]" << std::endl;
+}
+
+// Parse the command line
+bool parseOptions(int argc, char* argv[]) {
+    for (int i = 1; i < argc; ++i) {
+        std::string option = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (option == "--think" && hasValue) options.thinkMs = std::atoi(argv[++i]);
+        else if (option == "--info-rate" && hasValue) options.infoRate = std::atoi(argv[++i]);
+        else if (option == "--info-burst" && hasValue) options.infoBurst = std::atoi(argv[++i]);
+        else if (option == "--chunk" && hasValue) options.chunkBytes = std::strtoul(argv[++i], NULL, 10);
+        else if (option == "--chunk-delay" && hasValue) options.chunkDelayUs = std::atoi(argv[++i]);
+        else if (option == "--script" && hasValue) {
+            std::istringstream moves(argv[++i]);
+            std::string move;
+            while (std::getline(moves, move, ',')) {
+                if (!move.empty()) options.script.push_back(move);
+            }
+        }
+        else return false;
+    }
+    return true;
+}
+
+// Write engine output, split into chunks when asked (partial lines test the reader)
+void writeOutput(const std::string& text) {
+    std::lock_guard<std::mutex> lock(outputMutex);
+    if (options.chunkBytes == 0) {
+        fwrite(text.data(), 1, text.size(), stdout);
+        fflush(stdout);
+        return;
+    }
+    for (size_t offset = 0; offset < text.size(); offset += options.chunkBytes) {
+        fwrite(text.data() + offset, 1, std::min(options.chunkBytes, text.size() - offset), stdout);
+        fflush(stdout);
+        if (options.chunkDelayUs > 0) {
+            std::this_thread::sleep_for(std::chrono::microseconds(options.chunkDelayUs));
+        }
+    }
+}
+
+// A believable info line
+std::string infoLine(int depth, const std::string& bestMove) {
+    std::ostringstream line;
+    line << "info depth " << depth << " seldepth " << depth + 4 << " multipv 1 score cp " << (depth * 7) % 61 - 30
+        << " nodes " << depth * 1500 << " nps 1500000 time " << depth << " pv " << bestMove << '\n';
+    return line.str();
+}
+
+// Next bestmove: the script first, then a legal move of the current position
+std::string chooseMove() {
+    if (scriptIndex < options.script.size()) {
+        return options.script[scriptIndex++];
+    }
+    std::vector<uint16_t> moves;
+    position.generateLegalMoves(moves);
+    if (moves.empty()) {
+        return "0000";
+    }
+    return chessPosition::unpackMove(moves[searchCount % moves.size()]);
+}
+
+// One search: info lines for the think time (or until stop), then bestmove
+void search(int thinkMs, bool infinite, std::atomic<bool>& stopRequested) {
+    std::string bestMove = chooseMove();
+    searchCount++;
+    auto start = std::chrono::steady_clock::now();
+    auto deadline = start + std::chrono::milliseconds(thinkMs);
+    auto interval = std::chrono::microseconds(options.infoRate > 0 ? 1000000 / options.infoRate : 1000);
+    int depth = 1;
+
+    while (!stopRequested && (infinite || std::chrono::steady_clock::now() < deadline)) {
+        if (options.infoRate > 0) {
+            writeOutput(infoLine(depth++, bestMove));
+        }
+        std::this_thread::sleep_for(interval);
+    }
+
+    std::string burst;
+    for (int i = 0; i < options.infoBurst; ++i) {
+        burst += infoLine(depth++, bestMove);
+    }
+    writeOutput(burst + "bestmove " + bestMove + "\n");
+}
+
+// Main Entry Point
+int main(int argc, char* argv[])
+{
+    if (!parseOptions(argc, argv)) {
+        printUsage();
+        return -1;
+    }
+#ifdef _WIN32
+    // No "\r\n" translation, byte counts must match what was written
+    _setmode(_fileno(stdout), _O_BINARY);
+#endif
+
+    position.setStartPosition();
+    std::thread searchThread;
+    std::atomic<bool> stopRequested(false);
+
+    std::string line;
+    while (std::getline(std::cin, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        std::istringstream tokens(line);
+        std::string command;
+        tokens >> command;
+
+        if (command == "uci") {
+            writeOutput("id name ECE_MockEngine\nid author ECE6122\n"
+                "option name Hash type spin default 16 min 1 max 1024\n"
+                "option name Threads type spin default 1 min 1 max 64\n"
+                "option name MultiPV type spin default 1 min 1 max 8\nuciok\n");
+        }
+        else if (command == "isready") {
+            writeOutput("readyok\n");
+        }
+        else if (command == "position") {
+            std::string kind;
+            tokens >> kind;
+            std::string rest;
+            std::getline(tokens, rest);
+            size_t movesAt = rest.find(" moves");
+            std::string moves = movesAt == std::string::npos ? "" : rest.substr(movesAt + 6);
+            if (kind == "fen") {
+                position.setFromFen(rest.substr(0, movesAt));
+                std::istringstream moveStream(moves);
+                std::string move;
+                while (moveStream >> move && position.applyUciMove(move)) {
+                }
+            }
+            else {
+                position.setFromMoveList(moves);
+            }
+        }
+        else if (command == "go") {
+            if (searchThread.joinable()) {
+                searchThread.join();
+            }
+            int thinkMs = options.thinkMs;
+            bool infinite = false;
+            std::string token;
+            while (tokens >> token) {
+                if (token == "movetime") tokens >> thinkMs;
+                else if (token == "infinite") infinite = true;
+            }
+            stopRequested = false;
+            searchThread = std::thread(search, thinkMs, infinite, std::ref(stopRequested));
+        }
+        else if (command == "stop") {
+            stopRequested = true;
+        }
+        else if (command == "quit") {
+            break;
+        }
+        // setoption, ucinewgame and anything else are accepted silently
+    }
+
+    stopRequested = true;
+    if (searchThread.joinable()) {
+        searchThread.join();
+    }
+    return 0;
+}
@@ -0,0 +1,194 @@
+/*
+Author: Botao Huang
+Class: ECE6122 (A)
+Last Date Modified: 10/19/2026
+Description:
+PGN import
+Parses a PGN dump on worker threads (memory mapped, split at game boundaries)
+and optionally appends the games to a game archive in file order.
+Malformed games are reported and skipped
+*/
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+#include "chessPgn.h"
+#include "chessGameArchive.h"
+
+// Command line settings
+struct ImportOptions {
+    std::string inputPath;
+    std::string archivePath;          // Empty: parse only
+    std::string errorPath;            // Empty: errors go to stderr
+    int threads = 0;                  // 0: one per hardware thread
+    uint64_t chunkBytes = PGN_CHUNK_BYTES;
+};
+
+// What one chunk produced, kept until it is written in order
+struct ChunkResult {
+    bool done = false;
+    uint64_t games = 0;
+    uint64_t plies = 0;
+    std::vector<chessGameRecord> records;
+    std::vector<std::string> streams;
+    std::vector<chessPgnError> errors;
+};
+
+// Print usage
+void printUsage() {
+    std::cerr << "Usage: ECE_PgnImport --input games.pgn [--archive games] [--threads N]\n"
+        << "       [--chunk-mb N] [--errors errors.txt]" << std::endl;
+}
+
+// Parse the command line
+bool parseOptions(int argc, char* argv[], ImportOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string option = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (option == "--input" && hasValue) options.inputPath = argv[++i];
+        else if (option == "--archive" && hasValue) options.archivePath = argv[++i];
+        else if (option == "--errors" && hasValue) options.errorPath = argv[++i];
+        else if (option == "--threads" && hasValue) options.threads = std::atoi(argv[++i]);
+        else if (option == "--chunk-mb" && hasValue) options.chunkBytes = std::strtoull(argv[++i], NULL, 10) << 20;
+        else return false;
+    }
+    return !options.inputPath.empty() && options.chunkBytes > 0;
+}
+
+// Main Entry Point
+int main(int argc, char* argv[])
+{
+    ImportOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage();
+        return -1;
+    }
+    if (options.threads <= 0) {
+        options.threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    chessPgnReader reader;
+    if (!reader.open(options.inputPath, options.chunkBytes)) {
+        std::cerr << "Cannot open " << options.inputPath << std::endl;
+        return -1;
+    }
+    chessGameArchiveWriter archive;
+    bool archiving = !options.archivePath.empty();
+    if (archiving && !archive.open(options.archivePath)) {
+        std::cerr << "Cannot open the archive " << options.archivePath << std::endl;
+        return -1;
+    }
+    std::ofstream errorFile;
+    if (!options.errorPath.empty()) {
+        errorFile.open(options.errorPath);
+    }
+    std::ostream& errors = errorFile.is_open() ? errorFile : std::cerr;
+
+    // Workers parse (and encode) chunks; this thread writes them in file order.
+    // Workers stay at most a window of chunks ahead so memory stays bounded
+    size_t chunkCount = reader.chunkCount();
+    size_t window = static_cast<size_t>(options.threads) * 4;
+    std::vector<ChunkResult> results(chunkCount);
+    std::mutex resultMutex;
+    std::condition_variable resultReady;
+    size_t nextChunk = 0;
+    size_t written = 0;
+
+    std::vector<std::thread> workers;
+    for (int i = 0; i < options.threads; ++i) {
+        workers.emplace_back([&]() {
+            while (true) {
+                size_t chunk;
+                {
+                    std::unique_lock<std::mutex> lock(resultMutex);
+                    resultReady.wait(lock, [&]() { return nextChunk >= chunkCount || nextChunk < written + window; });
+                    if (nextChunk >= chunkCount) {
+                        return;
+                    }
+                    chunk = nextChunk++;
+                }
+
+                ChunkResult result;
+                reader.parseChunk(chunk,
+                    [&](size_t, const chessPgnGame& game) {
+                        result.games++;
+                        result.plies += game.record.size();
+                        if (!archiving) {
+                            return;
+                        }
+                        std::string stream;
+                        if (chessGameArchiveWriter::encode(game.record, stream)) {
+                            result.records.push_back(game.record);
+                            result.streams.push_back(std::move(stream));
+                        }
+                    },
+                    [&](size_t, const chessPgnError& error) {
+                        result.errors.push_back(error);
+                    });
+
+                std::lock_guard<std::mutex> lock(resultMutex);
+                result.done = true;
+                results[chunk] = std::move(result);
+                resultReady.notify_all();
+            }
+        });
+    }
+
+    uint64_t games = 0, plies = 0, errorCount = 0;
+    uint64_t firstId = archiving ? archive.gameCount() : 0;
+    bool archiveFailed = false;
+    for (size_t chunk = 0; chunk < chunkCount; ++chunk) {
+        ChunkResult result;
+        {
+            std::unique_lock<std::mutex> lock(resultMutex);
+            resultReady.wait(lock, [&]() { return results[chunk].done; });
+            result = std::move(results[chunk]);
+            results[chunk] = ChunkResult();
+        }
+
+        games += result.games;
+        plies += result.plies;
+        errorCount += result.errors.size();
+        for (const auto& error : result.errors) {
+            errors << options.inputPath << ":" << error.line << ": game at byte " << error.offset
+                << ": " << error.message << "\n";
+        }
+        for (size_t i = 0; i < result.records.size() && !archiveFailed; ++i) {
+            uint64_t id;
+            archiveFailed = !archive.appendEncoded(result.records[i], result.streams[i], id);
+        }
+
+        std::lock_guard<std::mutex> lock(resultMutex);
+        written = chunk + 1;
+        resultReady.notify_all();
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    errors.flush();
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double megabytes = reader.size() / 1e6;
+    std::cout << std::fixed << std::setprecision(1)
+        << "Input:    " << options.inputPath << " (" << megabytes << " MB, " << chunkCount << " chunks, "
+        << options.threads << " threads)\n"
+        << "Games:    " << games << " (" << plies << " plies), " << errorCount << " malformed\n"
+        << "Time:     " << seconds << " s, " << megabytes / seconds << " MB/s, "
+        << megabytes / 1000.0 / seconds * 60.0 << " GB/min, " << games / seconds << " games/s\n";
+    if (archiving) {
+        std::cout << "Archive:  " << options.archivePath << ", " << archive.gameCount() - firstId
+            << " games added (" << archive.gameCount() << " total)" << (archiveFailed ? ", write failed" : "") << "\n";
+    }
+    std::cout.flush();
+    return archiveFailed ? -1 : 0;
+}
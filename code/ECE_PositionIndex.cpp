@@ -0,0 +1,121 @@
+/*
+Author: Botao Huang
+Class: ECE6122 (A)
+Last Date Modified: 10/19/2026
+Description:
+Position index builder and query tool
+Builds <archive>.pos from a game archive, or looks a position up in it
+*/
+
+#include <string>
+#include <vector>
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+#include "chessPositionIndex.h"
+#include "chessPosition.h"
+
+// Command line settings
+struct IndexOptions {
+    std::string archivePath = "games";
+    std::string indexPath;            // Default <archive>.pos
+    int threads = 0;
+    uint64_t runMb = 256;
+    uint32_t maxPly = POSITION_MAX_PLY;
+    bool query = false;
+    std::string fen;                  // Query position, or
+    std::string moves;                // UCI moves from the starting position
+};
+
+// Print usage
+void printUsage() {
+    std::cerr << "Usage: ECE_PositionIndex [--archive games] [--index games.pos] [--threads N]\n"
+        << "       [--run-mb MB] [--max-ply N]               build the index\n"
+        << "       ECE_PositionIndex [--index games.pos] --fen \"FEN\" | --moves \"e2e4 e7e5\"   query it" << std::endl;
+}
+
+// Parse the command line
+bool parseOptions(int argc, char* argv[], IndexOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string option = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (option == "--archive" && hasValue) options.archivePath = argv[++i];
+        else if (option == "--index" && hasValue) options.indexPath = argv[++i];
+        else if (option == "--threads" && hasValue) options.threads = std::atoi(argv[++i]);
+        else if (option == "--run-mb" && hasValue) options.runMb = std::strtoull(argv[++i], NULL, 10);
+        else if (option == "--max-ply" && hasValue) options.maxPly = static_cast<uint32_t>(std::atoi(argv[++i]));
+        else if (option == "--fen" && hasValue) { options.fen = argv[++i]; options.query = true; }
+        else if (option == "--moves" && hasValue) { options.moves = argv[++i]; options.query = true; }
+        else return false;
+    }
+    if (options.indexPath.empty()) {
+        options.indexPath = options.archivePath + ".pos";
+    }
+    return options.runMb > 0;
+}
+
+// Look one position up and print what followed it
+int runQuery(const IndexOptions& options) {
+    chessPosition position;
+    if (!options.fen.empty() ? !position.setFromFen(options.fen) : !position.setFromMoveList(options.moves)) {
+        std::cerr << "Invalid position" << std::endl;
+        return -1;
+    }
+    chessPositionIndex index;
+    if (!index.open(options.indexPath)) {
+        std::cerr << "Cannot open " << options.indexPath << std::endl;
+        return -1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    const chessPositionIndexEntry* first;
+    const chessPositionIndexEntry* last;
+    index.find(position.zobristKey(), first, last);
+    std::vector<chessMoveStats> stats;
+    uint64_t games;
+    chessPositionIndex::moveStats(first, last, stats, games);
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << std::fixed << std::setprecision(1)
+        << "Position:  " << position.toFen() << "\n"
+        << "Found in:  " << games << " games (" << (last - first) << " records, " << ms << " ms)\n";
+    for (const auto& move : stats) {
+        std::cout << "  " << std::left << std::setw(8) << position.toSan(move.move) << std::right
+            << std::setw(9) << move.games << " games  +" << move.whiteWins << " =" << move.draws
+            << " -" << move.blackWins << "  " << move.whiteScore() << "%\n";
+    }
+    std::cout.flush();
+    return 0;
+}
+
+// Main Entry Point
+int main(int argc, char* argv[])
+{
+    IndexOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage();
+        return -1;
+    }
+    if (options.query) {
+        return runQuery(options);
+    }
+
+    chessPositionIndexBuilder builder;
+    builder.threads = options.threads;
+    builder.runBytes = options.runMb << 20;
+    builder.maxPly = options.maxPly;
+    auto start = std::chrono::steady_clock::now();
+    if (!builder.build(options.archivePath, options.indexPath)) {
+        std::cerr << "Cannot index " << options.archivePath << " into " << options.indexPath << std::endl;
+        return -1;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << std::fixed << std::setprecision(1)
+        << "Index:     " << options.indexPath << "\n"
+        << "Records:   " << builder.entryCount() << " positions from " << builder.runCount() << " sorted runs\n"
+        << "Time:      " << seconds << " s, " << builder.entryCount() / seconds / 1e6 << " M positions/s" << std::endl;
+    return 0;
+}
@@ -0,0 +1,54 @@
+/*
+Author: Botao Huang
+Class: ECE6122 (A)
+Last Date Modified: 10/19/2026
+Description:
+Code for the replay engine
+*/
+
+#include <thread>
+#include <iostream>
+#include "ECE_ReplayEngine.h"
+
+// Constructor function (no engine process is started)
+ECE_ReplayEngine::ECE_ReplayEngine() : paced(false), searches(0), missingReplies(0) {
+}
+
+void ECE_ReplayEngine::queueReply(const std::string& move, TimePoint readyAt) {
+    RecordedReply reply;
+    reply.move = move;
+    reply.readyAt = readyAt;
+    replies.push_back(reply);
+}
+
+size_t ECE_ReplayEngine::discardUnusedReplies() {
+    size_t unused = replies.size();
+    replies.clear();
+    return unused;
+}
+
+// Nothing to send: the reply is already known
+bool ECE_ReplayEngine::sendMove(const std::string& /*strMove*/) {
+    searches++;
+    return true;
+}
+
+// Next recorded reply, false when the log has none (or the engine gave none)
+bool ECE_ReplayEngine::getResponseMove(std::string& strMove) {
+    if (replies.empty()) {
+        missingReplies++;
+        return false;
+    }
+    RecordedReply& reply = replies.front();
+    if (paced) {
+        std::this_thread::sleep_until(reply.readyAt);
+    }
+    strMove.swap(reply.move);
+    replies.pop_front();
+    if (strMove.empty()) {
+        return false;
+    }
+    // Same transcript as a live engine
+    std::cout << "Engine Response: " << strMove << std::endl;
+    return true;
+}
@@ -0,0 +1,51 @@
+/*
+Author: Botao Huang
+Class: ECE6122 (A)
+Last Date Modified: 10/19/2026
+Description:
+Header file for the replay engine
+Stands in for ECE_ChessEngine during a session replay: no engine process,
+every search is answered with the reply recorded in the session log
+*/
+
+#ifndef ECE_REPLAYENGINE_H
+#define ECE_REPLAYENGINE_H
+
+#include <string>
+#include <deque>
+#include <chrono>
+#include <cstdint>
+#include "ECE_ChessEngine.h"
+
+class ECE_ReplayEngine : public ECE_ChessEngine {
+private:
+    typedef std::chrono::steady_clock::time_point TimePoint;
+
+    // Replies recorded for the command being replayed
+    struct RecordedReply {
+        std::string move;       // Empty when the engine gave none
+        TimePoint readyAt;      // When it arrived, with recorded pacing
+    };
+    std::deque<RecordedReply> replies;
+    bool paced;
+    uint64_t searches;
+    uint64_t missingReplies;
+
+public:
+    ECE_ReplayEngine();
+
+    // Hold replies back until their recorded time instead of answering at once
+    void setPaced(bool enabled) { paced = enabled; }
+    void queueReply(const std::string& move, TimePoint readyAt);
+    // Replies of the current command the replayed build did not ask for (dropped)
+    size_t discardUnusedReplies();
+
+    bool sendMove(const std::string& strMove);
+    bool getResponseMove(std::string& strMove);
+
+    uint64_t getSearches() const { return searches; }
+    // Searches the log had no reply for
+    uint64_t getMissingReplies() const { return missingReplies; }
+};
+
+#endif
@@ -0,0 +1,59 @@
+/*
+Author: Botao Huang
+Class: ECE6122 (A)
+Last Date Modified: 10/19/2026
+Description:
+Single producer / single consumer lock-free ring buffer
+Fixed capacity storage inside the object, push and pop never allocate
+*/
+
+#ifndef ECE_RINGBUFFER_H
+#define ECE_RINGBUFFER_H
+
+#include <atomic>
+#include <cstddef>
+
+template <typename T, size_t Capacity>
+class ECE_RingBuffer {
+    static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of 2");
+
+private:
+    // Producer and consumer indices live on separate cache lines
+    alignas(64) std::atomic<size_t> head;   // Next slot to write (producer)
+    alignas(64) std::atomic<size_t> tail;   // Next slot to read (consumer)
+    alignas(64) T items[Capacity];
+
+public:
+    ECE_RingBuffer() : head(0), tail(0) {}
+    ECE_RingBuffer(const ECE_RingBuffer&) = delete;
+    ECE_RingBuffer& operator=(const ECE_RingBuffer&) = delete;
+
+    // Producer only: false when the ring is full
+    bool push(const T& item) {
+        size_t write = head.load(std::memory_order_relaxed);
+        if (write - tail.load(std::memory_order_acquire) == Capacity) {
+            return false;
+        }
+        items[write & (Capacity - 1)] = item;
+        head.store(write + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only: false when the ring is empty
+    bool pop(T& item) {
+        size_t read = tail.load(std::memory_order_relaxed);
+        if (read == head.load(std::memory_order_acquire)) {
+            return false;
+        }
+        item = items[read & (Capacity - 1)];
+        tail.store(read + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Approximate when called from a third thread
+    size_t size() const {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+    }
+};
+
+#endif
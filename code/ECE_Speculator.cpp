@@ -0,0 +1,228 @@
+/*
+Author: Botao Huang
+Class: ECE6122 (A)
+Last Date Modified: 10/19/2026
+Description:
+Code for speculative pre-analysis of the user's replies
+*/
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <iomanip>
+#include "ECE_Speculator.h"
+
+// Replies kept before the cache is emptied
+const size_t SPECULATION_CACHE_LIMIT = 4096;
+
+namespace {
+    // Rough material values used to rank captures
+    int pieceValue(char piece) {
+        switch (std::tolower(piece)) {
+        case 'p': return 1;
+        case 'n': case 'b': return 3;
+        case 'r': return 5;
+        case 'q': return 9;
+        default: return 0;
+        }
+    }
+}
+
+// Constructor function
+ECE_Speculator::ECE_Speculator(ECE_EnginePool& pool, int clientId, int maxReplies, const std::string& goCommand) :
+    pool(pool), analysisCache(NULL), clientId(clientId), maxReplies(maxReplies), goCommand(goCommand),
+    speculations(0), hits(0), lateHits(0), misses(0) {
+}
+
+// After the engine moved: analyse the user's likely replies in the background
+void ECE_Speculator::speculate(const std::string& moveHistory) {
+    // Predictions for the previous turn are useless now
+    pool.cancelClient(clientId);
+
+    chessPosition position;
+    if (!position.setFromMoveList(moveHistory)) {
+        return;
+    }
+    std::vector<uint16_t> candidates = rankReplies(position);
+
+    std::lock_guard<std::mutex> lock(speculationMutex);
+    if (replies.size() > SPECULATION_CACHE_LIMIT) {
+        replies.clear();
+    }
+
+    for (uint16_t reply : candidates) {
+        chessPosition next = position;
+        next.applyMove(reply);
+        uint64_t key = next.zobristKey();
+        if (replies.count(key) > 0 || pending.count(key) > 0) {
+            continue;
+        }
+
+        std::string replyText = chessPosition::unpackMove(reply);
+        AnalysisJob job;
+        job.positionCommand = "position startpos moves " + moveHistory + (moveHistory.empty() ? "" : " ") + replyText;
+        job.goCommand = goCommand;
+        job.priority = PRIORITY_BACKGROUND;
+        job.clientId = clientId;
+        job.onComplete = [this, key](const AnalysisJobResult& result) {
+            std::lock_guard<std::mutex> guard(speculationMutex);
+            pending.erase(key);
+            // A search stopped early is not the answer the engine would give
+            if (result.completed && !result.preempted) {
+                replies[key] = result.analysis.bestMove;
+            }
+            replyReady.notify_all();
+        };
+
+        pending.insert(key);
+        speculations++;
+        pool.submit(job);
+    }
+}
+
+// After the user moved: take the engine reply if it was predicted
+bool ECE_Speculator::takeReply(const std::string& moveHistory, std::string& engineMove) {
+    chessPosition position;
+    if (!position.setFromMoveList(moveHistory)) {
+        return false;
+    }
+    uint64_t key = position.zobristKey();
+
+    bool found = false;
+    {
+        std::unique_lock<std::mutex> lock(speculationMutex);
+        bool wasPending = pending.count(key) > 0;
+        // The right position is already on an engine, finishing it beats starting over
+        replyReady.wait(lock, [this, key] { return pending.count(key) == 0; });
+
+        auto reply = replies.find(key);
+        if (reply != replies.end()) {
+            engineMove = reply->second;
+            replies.erase(reply);
+            found = true;
+            if (wasPending) lateHits++;
+            else hits++;
+        }
+        else {
+            misses++;
+        }
+    }
+
+    // The other predictions lost, free their engines
+    pool.cancelClient(clientId);
+    return found;
+}
+
+// Learn which move the user played in a position
+void ECE_Speculator::recordUserMove(const std::string& historyBefore, const std::string& move) {
+    chessPosition position;
+    if (!position.setFromMoveList(historyBefore)) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(speculationMutex);
+    history[position.zobristKey()][chessPosition::packUciMove(move)]++;
+}
+
+// Most plausible replies for the side to move, best first
+std::vector<uint16_t> ECE_Speculator::rankReplies(const chessPosition& position) {
+    std::vector<uint16_t> moves;
+    position.generateLegalMoves(moves);
+
+    // The engine's own verdict for the user's side is the strongest hint
+    uint16_t engineChoice = 0;
+    AnalysisEntry entry;
+    bool flipped = false;
+    uint64_t canonical = position.canonicalKey(flipped);
+    if (analysisCache != NULL && analysisCache->lookupHint(canonical, 1, entry)) {
+        std::string move = chessPosition::unpackMove(entry.move);
+        engineChoice = chessPosition::packUciMove(flipped ? chessPosition::flipUciMove(move) : move);
+    }
+
+    std::map<uint16_t, uint32_t> played;
+    {
+        std::lock_guard<std::mutex> lock(speculationMutex);
+        auto found = history.find(position.zobristKey());
+        if (found != history.end()) {
+            played = found->second;
+        }
+    }
+
+    std::vector<std::pair<int, uint16_t>> scored;
+    for (uint16_t move : moves) {
+        int score = heuristicScore(position, move);
+        auto count = played.find(move);
+        if (count != played.end()) {
+            score += 1000 * static_cast<int>(count->second);
+        }
+        if (move == engineChoice) {
+            score += 5000;
+        }
+        scored.push_back(std::make_pair(score, move));
+    }
+    std::stable_sort(scored.begin(), scored.end(),
+        [](const std::pair<int, uint16_t>& a, const std::pair<int, uint16_t>& b) { return a.first > b.first; });
+
+    std::vector<uint16_t> ranked;
+    for (size_t i = 0; i < scored.size() && static_cast<int>(i) < maxReplies; ++i) {
+        ranked.push_back(scored[i].second);
+    }
+    return ranked;
+}
+
+// Cheap plausibility score of one move
+int ECE_Speculator::heuristicScore(const chessPosition& position, uint16_t move) const {
+    int from = move & 0x3F;
+    int to = (move >> 6) & 0x3F;
+    int promotion = (move >> 12) & 0xF;
+    char piece = position.board[from];
+    char victim = position.board[to];
+    char type = static_cast<char>(std::tolower(piece));
+    int score = 0;
+
+    // Captures, most valuable victim by least valuable attacker
+    if (victim != EMPTY_SQUARE) {
+        score += 100 * pieceValue(victim) - 10 * pieceValue(piece);
+    }
+    if (promotion == 4) {
+        score += 800;
+    }
+    // Castling
+    if (type == 'k' && std::abs((to % 8) - (from % 8)) == 2) {
+        score += 200;
+    }
+    // Developing a minor piece off the back rank
+    int homeRank = position.whiteToMove ? 0 : 7;
+    if ((type == 'n' || type == 'b') && from / 8 == homeRank) {
+        score += 50;
+    }
+    // Central pawn moves
+    if (type == 'p' && (to % 8 == 3 || to % 8 == 4)) {
+        score += 40;
+    }
+    // Pieces heading for the centre
+    if (type != 'k') {
+        int fileDistance = std::min(std::abs(to % 8 - 3), std::abs(to % 8 - 4));
+        int rankDistance = std::min(std::abs(to / 8 - 3), std::abs(to / 8 - 4));
+        score += 5 * (6 - fileDistance - rankDistance);
+    }
+    // Checks
+    chessPosition next = position;
+    next.applyMove(move);
+    if (next.inCheck()) {
+        score += 300;
+    }
+    return score;
+}
+
+// Print hit rate
+void ECE_Speculator::printStats(std::ostream& os) {
+    std::lock_guard<std::mutex> lock(speculationMutex);
+    uint64_t answered = hits + lateHits + misses;
+    std::ios::fmtflags savedFlags = os.flags();
+    std::streamsize savedPrecision = os.precision();
+    os << "Speculation: " << speculations << " positions analysed ahead, " << hits << " hits, "
+        << lateHits << " late hits, " << misses << " misses (hit rate " << std::fixed << std::setprecision(1)
+        << (answered ? 100.0 * (hits + lateHits) / answered : 0.0) << "%)" << std::endl;
+    os.flags(savedFlags);
+    os.precision(savedPrecision);
+}
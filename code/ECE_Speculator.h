@@ -0,0 +1,74 @@
+/*
+Author: Botao Huang
+Class: ECE6122 (A)
+Last Date Modified: 10/19/2026
+Description:
+Header file for speculative pre-analysis
+While the user thinks, spare engines analyse the positions after the
+user's most plausible replies so the engine answer is ready in advance
+*/
+
+#ifndef ECE_SPECULATOR_H
+#define ECE_SPECULATOR_H
+
+#include <string>
+#include <vector>
+#include <set>
+#include <map>
+#include <unordered_map>
+#include <mutex>
+#include <condition_variable>
+#include <iostream>
+#include <cstdint>
+#include "ECE_EnginePool.h"
+#include "ECE_AnalysisCache.h"
+#include "chessPosition.h"
+
+class ECE_Speculator {
+private:
+    ECE_EnginePool& pool;
+    ECE_AnalysisCache* analysisCache;   // Optional, ranks the engine's own choice first
+    int clientId;
+    int maxReplies;
+    std::string goCommand;
+
+    std::mutex speculationMutex;
+    std::condition_variable replyReady;
+    // Engine replies by position key (position after the user's move)
+    std::unordered_map<uint64_t, std::string> replies;
+    // Positions still being analysed
+    std::set<uint64_t> pending;
+    // How often the user chose each move in a position
+    std::unordered_map<uint64_t, std::map<uint16_t, uint32_t>> history;
+
+    // Statistics
+    uint64_t speculations;
+    uint64_t hits;
+    uint64_t lateHits;
+    uint64_t misses;
+
+public:
+    // clientId keeps speculative jobs apart from other pool clients
+    ECE_Speculator(ECE_EnginePool& pool, int clientId, int maxReplies, const std::string& goCommand);
+
+    void attachAnalysisCache(ECE_AnalysisCache* cache) { analysisCache = cache; }
+
+    // After the engine moved: analyse the user's likely replies in the background
+    void speculate(const std::string& moveHistory);
+    // After the user moved: take the engine reply if it was predicted (waits for
+    // a prediction that is still being analysed), false on a miss
+    bool takeReply(const std::string& moveHistory, std::string& engineMove);
+    // Learn which move the user played in the position before moveHistory's last move
+    void recordUserMove(const std::string& historyBefore, const std::string& move);
+
+    // Print hit rate
+    void printStats(std::ostream& os);
+
+private:
+    // Most plausible replies for the side to move, best first
+    std::vector<uint16_t> rankReplies(const chessPosition& position);
+    // Cheap plausibility score of one move
+    int heuristicScore(const chessPosition& position, uint16_t move) const;
+};
+
+#endif
@@ -0,0 +1,53 @@
+/*
+Author: Botao Huang
+Class: ECE6122 (A)
+Last Date Modified: 10/19/2026
+Description:
+Single writer / single reader lock-free triple buffer
+The writer fills a back slot and publishes it; the reader always switches to
+the newest published value. Neither side ever waits for the other
+*/
+
+#ifndef ECE_TRIPLEBUFFER_H
+#define ECE_TRIPLEBUFFER_H
+
+#include <atomic>
+#include <cstdint>
+
+template <typename T>
+class ECE_TripleBuffer {
+private:
+    // Slot index in the low bits, set when the middle slot was not read yet
+    static const uint8_t INDEX_MASK = 3;
+    static const uint8_t FRESH = 4;
+
+    T slots[3];
+    std::atomic<uint8_t> middle;    // Last published slot, swapped by both sides
+    uint8_t writing;                // Writer's slot
+    uint8_t reading;                // Reader's slot
+
+public:
+    ECE_TripleBuffer() : middle(1), writing(0), reading(2) {}
+    ECE_TripleBuffer(const ECE_TripleBuffer&) = delete;
+    ECE_TripleBuffer& operator=(const ECE_TripleBuffer&) = delete;
+
+    // Writer only: the slot to fill. It holds an older value, so fill all of it
+    T& back() { return slots[writing]; }
+    // Writer only: make back() the newest value and move on to another slot
+    void publish() {
+        writing = middle.exchange(writing | FRESH, std::memory_order_acq_rel) & INDEX_MASK;
+    }
+
+    // Reader only: switch to the newest value, false when nothing new was published
+    bool update() {
+        if ((middle.load(std::memory_order_relaxed) & FRESH) == 0) {
+            return false;
+        }
+        reading = middle.exchange(reading, std::memory_order_acq_rel) & INDEX_MASK;
+        return true;
+    }
+    // Reader only: the value read by the last update() (stays unchanged until the next one)
+    const T& front() const { return slots[reading]; }
+};
+
+#endif
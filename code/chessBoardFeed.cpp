@@ -0,0 +1,364 @@
+/*
+Author: Botao Huang
+Class: ECE6122 (A)
+Last Date Modified: 10/19/2026
+Description:
+Board feed for spectators definition file
+*/
+
+#include <cstring>
+#include "chessBoardFeed.h"
+
+namespace
+{
+    // Piece ids in code order (code 0 is no piece)
+    const char* const PIECE_IDS[] = {
+        "", "TORRE3", "Object3", "ALFIERE3", "REGINA2", "RE2", "PEDONE13",
+        "TORRE02", "Object02", "ALFIERE02", "REGINA01", "RE01", "PEDONE12"
+    };
+    const uint8_t PIECE_CODES = sizeof(PIECE_IDS) / sizeof(PIECE_IDS[0]);
+
+    void putUint16(std::vector<uint8_t>& frame, size_t at, uint32_t value)
+    {
+        frame[at] = static_cast<uint8_t>(value);
+        frame[at + 1] = static_cast<uint8_t>(value >> 8);
+    }
+
+    void putUint32(std::vector<uint8_t>& frame, size_t at, uint32_t value)
+    {
+        for (int i = 0; i < 4; ++i)
+        {
+            frame[at + i] = static_cast<uint8_t>(value >> (8 * i));
+        }
+    }
+
+    uint32_t getUint32(const uint8_t* data)
+    {
+        return static_cast<uint32_t>(data[0]) | (static_cast<uint32_t>(data[1]) << 8)
+            | (static_cast<uint32_t>(data[2]) << 16) | (static_cast<uint32_t>(data[3]) << 24);
+    }
+
+    // Frame with its header filled in except for the sequence number
+    std::shared_ptr<std::vector<uint8_t>> newFrame(uint8_t type, size_t length)
+    {
+        std::shared_ptr<std::vector<uint8_t>> frame = std::make_shared<std::vector<uint8_t>>(length);
+        putUint16(*frame, 0, static_cast<uint32_t>(length));
+        (*frame)[2] = type;
+        return frame;
+    }
+
+    bool isBoardLocation(uint8_t location)
+    {
+        return location >= 8 && location < 72;
+    }
+}
+
+uint8_t feedPieceCode(const std::string& pieceId)
+{
+    for (uint8_t code = 1; code < PIECE_CODES; ++code)
+    {
+        if (pieceId == PIECE_IDS[code])
+            return code;
+    }
+    return 0;
+}
+
+const char* feedPieceId(uint8_t code)
+{
+    return code < PIECE_CODES ? PIECE_IDS[code] : "";
+}
+
+uint8_t feedLocation(const std::string& name)
+{
+    if (name.size() != 2 || name[0] < 'a' || name[0] > 'h' || name[1] < '0' || name[1] > '9')
+        return FEED_NO_LOCATION;
+    return static_cast<uint8_t>((name[1] - '0') * 8 + (name[0] - 'a'));
+}
+
+std::string feedLocationName(uint8_t location)
+{
+    if (location >= FEED_LOCATIONS)
+        return "";
+    std::string name(2, ' ');
+    name[0] = static_cast<char>('a' + location % 8);
+    name[1] = static_cast<char>('0' + location / 8);
+    return name;
+}
+
+// FNV-1a over the 64 squares
+uint32_t feedBoardHash(const uint8_t squares[64])
+{
+    uint32_t hash = 2166136261u;
+    for (int i = 0; i < 64; ++i)
+    {
+        hash ^= squares[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+uint32_t feedBoardHash(const std::map<std::string, std::string>& boardState)
+{
+    uint8_t squares[64];
+    std::memset(squares, 0, sizeof(squares));
+    for (const auto& entry : boardState)
+    {
+        uint8_t location = feedLocation(entry.first);
+        if (isBoardLocation(location))
+            squares[location - 8] = feedPieceCode(entry.second);
+    }
+    return feedBoardHash(squares);
+}
+
+// Constructor function; nothing is delivered before the first keyframe
+chessFeedSubscriber::chessFeedSubscriber() : waitingForKeyframe(true), dropped(0)
+{
+}
+
+bool chessFeedSubscriber::pop(chessFeedFrame& frame)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (frames.empty())
+        return false;
+    frame.swap(frames.front());
+    frames.pop_front();
+    return true;
+}
+
+size_t chessFeedSubscriber::backlog()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return frames.size();
+}
+
+uint64_t chessFeedSubscriber::droppedFrames()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return dropped;
+}
+
+void chessFeedSubscriber::setReadyCallback(const std::function<void()>& callback)
+{
+    bool ready;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        onReady = callback;
+        ready = !frames.empty();
+    }
+    if (ready && callback)
+        callback();
+}
+
+// Queue a frame; a subscriber that falls too far behind loses its backlog and
+// skips to the next keyframe
+void chessFeedSubscriber::push(const chessFeedFrame& frame, bool keyframe)
+{
+    std::function<void()> callback;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (frames.size() >= FEED_MAX_BACKLOG)
+        {
+            dropped += frames.size();
+            frames.clear();
+            waitingForKeyframe = true;
+        }
+        if (waitingForKeyframe && !keyframe)
+        {
+            dropped++;
+            return;
+        }
+        waitingForKeyframe = false;
+        if (frames.empty())
+            callback = onReady;
+        frames.push_back(frame);
+    }
+    if (callback)
+        callback();
+}
+
+// Constructor function
+chessBoardFeed::chessBoardFeed() : sequence(0), deltasSinceKeyframe(0)
+{
+}
+
+std::shared_ptr<chessFeedSubscriber> chessBoardFeed::subscribe()
+{
+    std::shared_ptr<chessFeedSubscriber> subscriber = std::make_shared<chessFeedSubscriber>();
+    std::lock_guard<std::mutex> lock(mutex);
+    for (size_t i = 0; i < history.size(); ++i)
+    {
+        subscriber->push(history[i], i == 0);
+    }
+    subscribers.push_back(subscriber);
+    return subscriber;
+}
+
+size_t chessBoardFeed::subscriberCount()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t count = 0;
+    for (const auto& subscriber : subscribers)
+    {
+        if (!subscriber.expired())
+            count++;
+    }
+    return count;
+}
+
+uint64_t chessBoardFeed::framesPublished()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return sequence;
+}
+
+void chessBoardFeed::publishDelta(const chessBoardDelta& delta, const std::map<std::string, std::string>& boardState,
+    const tModelMap& models)
+{
+    std::shared_ptr<std::vector<uint8_t>> frame = newFrame(FEED_FRAME_DELTA, FEED_DELTA_SIZE);
+    std::vector<uint8_t>& bytes = *frame;
+    bytes[FEED_HEADER_SIZE] = delta.from;
+    bytes[FEED_HEADER_SIZE + 1] = delta.to;
+    bytes[FEED_HEADER_SIZE + 2] = delta.capturedTo;
+    bytes[FEED_HEADER_SIZE + 3] = delta.promotion;
+    putUint32(bytes, FEED_HEADER_SIZE + 4, feedBoardHash(boardState));
+    publish(frame, false);
+
+    // The counter is only touched by the thread that plays the game
+    if (++deltasSinceKeyframe >= FEED_KEYFRAME_INTERVAL)
+    {
+        publishKeyframe(boardState, models);
+    }
+}
+
+void chessBoardFeed::publishKeyframe(const std::map<std::string, std::string>& boardState, const tModelMap& models)
+{
+    // Location and piece pairs: the board, then the captured pieces beside it
+    std::vector<uint8_t> pairs;
+    pairs.reserve(2 * 32);
+    for (const auto& entry : boardState)
+    {
+        uint8_t location = feedLocation(entry.first);
+        if (isBoardLocation(location))
+        {
+            pairs.push_back(location);
+            pairs.push_back(feedPieceCode(entry.second));
+        }
+    }
+    for (const auto& model : models)
+    {
+        uint8_t location = feedLocation(model.location);
+        if (location < FEED_LOCATIONS && !isBoardLocation(location))
+        {
+            pairs.push_back(location);
+            pairs.push_back(feedPieceCode(model.id));
+        }
+    }
+    size_t count = pairs.size() / 2 > 255 ? 255 : pairs.size() / 2;
+
+    std::shared_ptr<std::vector<uint8_t>> frame = newFrame(FEED_FRAME_KEYFRAME, FEED_HEADER_SIZE + 1 + 2 * count + 4);
+    std::vector<uint8_t>& bytes = *frame;
+    bytes[FEED_HEADER_SIZE] = static_cast<uint8_t>(count);
+    std::memcpy(&bytes[FEED_HEADER_SIZE + 1], pairs.data(), 2 * count);
+    putUint32(bytes, FEED_HEADER_SIZE + 1 + 2 * count, feedBoardHash(boardState));
+    deltasSinceKeyframe = 0;
+    publish(frame, true);
+}
+
+// Number the frame and hand the same buffer to every subscriber
+void chessBoardFeed::publish(const std::shared_ptr<std::vector<uint8_t>>& frame, bool keyframe)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    putUint32(*frame, 3, ++sequence);
+    chessFeedFrame shared = frame;
+    if (keyframe)
+    {
+        history.clear();
+    }
+    history.push_back(shared);
+
+    for (size_t i = 0; i < subscribers.size(); )
+    {
+        std::shared_ptr<chessFeedSubscriber> subscriber = subscribers[i].lock();
+        if (!subscriber)
+        {
+            // Unsubscribed: the pointer was dropped
+            subscribers[i] = subscribers.back();
+            subscribers.pop_back();
+            continue;
+        }
+        subscriber->push(shared, keyframe);
+        ++i;
+    }
+}
+
+// Constructor function
+chessFeedMirror::chessFeedMirror()
+    : deltasApplied(0), keyframesApplied(0), hashMismatches(0), synced(false), lastSequence(0)
+{
+    std::memset(pieces, 0, sizeof(pieces));
+}
+
+bool chessFeedMirror::apply(const uint8_t* data, size_t length)
+{
+    if (length < FEED_HEADER_SIZE || (static_cast<size_t>(data[0]) | (static_cast<size_t>(data[1]) << 8)) != length)
+        return false;
+    uint32_t frameSequence = getUint32(data + 3);
+
+    if (data[2] == FEED_FRAME_KEYFRAME)
+    {
+        if (length < FEED_HEADER_SIZE + 1 + 4)
+            return false;
+        size_t count = data[FEED_HEADER_SIZE];
+        if (length != FEED_HEADER_SIZE + 1 + 2 * count + 4)
+            return false;
+        std::memset(pieces, 0, sizeof(pieces));
+        const uint8_t* pair = data + FEED_HEADER_SIZE + 1;
+        for (size_t i = 0; i < count; ++i, pair += 2)
+        {
+            if (pair[0] < FEED_LOCATIONS)
+                pieces[pair[0]] = pair[1];
+        }
+        if (feedBoardHash(pieces + 8) != getUint32(pair))
+        {
+            hashMismatches++;
+            synced = false;
+            return false;
+        }
+        synced = true;
+        lastSequence = frameSequence;
+        keyframesApplied++;
+        return true;
+    }
+
+    if (data[2] != FEED_FRAME_DELTA || length != FEED_DELTA_SIZE || !synced)
+        return false;
+    if (frameSequence != lastSequence + 1)
+    {
+        // A frame went missing: wait for the next keyframe
+        synced = false;
+        return false;
+    }
+    const uint8_t* delta = data + FEED_HEADER_SIZE;
+    uint8_t from = delta[0];
+    uint8_t to = delta[1];
+    uint8_t capturedTo = delta[2];
+    if (from >= FEED_LOCATIONS || to >= FEED_LOCATIONS
+        || (capturedTo != FEED_NO_LOCATION && capturedTo >= FEED_LOCATIONS))
+    {
+        synced = false;
+        return false;
+    }
+    if (capturedTo != FEED_NO_LOCATION)
+        pieces[capturedTo] = pieces[to];
+    pieces[to] = delta[3] != 0 ? delta[3] : pieces[from];
+    pieces[from] = 0;
+    lastSequence = frameSequence;
+    if (feedBoardHash(pieces + 8) != getUint32(delta + 4))
+    {
+        hashMismatches++;
+        synced = false;
+        return false;
+    }
+    deltasApplied++;
+    return true;
+}
@@ -0,0 +1,142 @@
+/*
+Author: Botao Huang
+Class: ECE6122 (A)
+Last Date Modified: 10/19/2026
+Description:
+Board feed for spectators
+Each executed move is published as a small binary delta (moved piece,
+captured piece relocation, promotion, board hash); a keyframe with every
+piece is published periodically so late joiners can sync. Every subscriber
+gets the same encoded buffer, nothing is copied per subscriber
+*/
+
+#ifndef CHESS_BOARD_FEED_H
+#define CHESS_BOARD_FEED_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <functional>
+#include <cstdint>
+#include "chessCommon.h"
+
+// Frame types
+const uint8_t FEED_FRAME_DELTA = 'D';
+const uint8_t FEED_FRAME_KEYFRAME = 'K';
+// Frame header: length (2 bytes, whole frame), type, sequence number (4 bytes)
+const size_t FEED_HEADER_SIZE = 7;
+// Delta frame: header, from, to, captured piece relocation, promotion, board hash
+const size_t FEED_DELTA_SIZE = FEED_HEADER_SIZE + 4 + 4;
+// Locations are rank * 8 + file with ranks 0 and 9 beside the board
+const uint8_t FEED_LOCATIONS = 80;
+const uint8_t FEED_NO_LOCATION = 0xFF;
+// Deltas between two keyframes
+const uint32_t FEED_KEYFRAME_INTERVAL = 32;
+// Frames queued for one subscriber before it is sent back to the next keyframe
+const size_t FEED_MAX_BACKLOG = 256;
+
+// One encoded frame, shared by every subscriber
+typedef std::shared_ptr<const std::vector<uint8_t>> chessFeedFrame;
+
+// What one executed move changed
+struct chessBoardDelta
+{
+    uint8_t from;           // Location the piece left
+    uint8_t to;             // Location it arrived on
+    uint8_t capturedTo;     // Where the captured piece went, FEED_NO_LOCATION without capture
+    uint8_t promotion;      // Piece code after promotion, 0 without promotion
+};
+
+// Piece ids ("TORRE3") <-> codes 1..12, 0 is no piece
+uint8_t feedPieceCode(const std::string& pieceId);
+const char* feedPieceId(uint8_t code);
+// Location names ("e2", "c0", "a9") <-> location codes, FEED_NO_LOCATION if malformed
+uint8_t feedLocation(const std::string& name);
+std::string feedLocationName(uint8_t location);
+// Hash of the pieces on the 64 board squares (one piece code per square)
+uint32_t feedBoardHash(const uint8_t squares[64]);
+uint32_t feedBoardHash(const std::map<std::string, std::string>& boardState);
+
+// Frames waiting for one spectator
+class chessFeedSubscriber
+{
+public:
+    chessFeedSubscriber();
+
+    // Next frame, false when none is queued
+    bool pop(chessFeedFrame& frame);
+    size_t backlog();
+    // Frames dropped because this subscriber fell too far behind
+    uint64_t droppedFrames();
+    // Called (on the publishing thread) when the queue stops being empty
+    void setReadyCallback(const std::function<void()>& callback);
+
+private:
+    friend class chessBoardFeed;
+    std::mutex mutex;
+    std::deque<chessFeedFrame> frames;
+    bool waitingForKeyframe;
+    uint64_t dropped;
+    std::function<void()> onReady;
+
+    void push(const chessFeedFrame& frame, bool keyframe);
+};
+
+// Publisher side, one per game
+class chessBoardFeed
+{
+public:
+    chessBoardFeed();
+
+    // New subscribers start with the last keyframe and the deltas after it.
+    // Dropping the returned pointer unsubscribes
+    std::shared_ptr<chessFeedSubscriber> subscribe();
+    size_t subscriberCount();
+
+    // Publish a move; a keyframe follows every FEED_KEYFRAME_INTERVAL deltas
+    void publishDelta(const chessBoardDelta& delta, const std::map<std::string, std::string>& boardState,
+        const tModelMap& models);
+    // Publish every piece: board squares from boardState, captured pieces from the models
+    void publishKeyframe(const std::map<std::string, std::string>& boardState, const tModelMap& models);
+
+    // Frames published so far
+    uint64_t framesPublished();
+
+private:
+    std::mutex mutex;
+    std::vector<std::weak_ptr<chessFeedSubscriber>> subscribers;
+    // Last keyframe and the deltas after it, for late joiners
+    std::vector<chessFeedFrame> history;
+    uint32_t sequence;
+    uint32_t deltasSinceKeyframe;
+
+    void publish(const std::shared_ptr<std::vector<uint8_t>>& frame, bool keyframe);
+};
+
+// Subscriber side: rebuilds the pieces from frames and checks the hashes
+class chessFeedMirror
+{
+public:
+    chessFeedMirror();
+
+    // Apply one frame; false when it cannot be applied (waiting for a keyframe,
+    // sequence gap, hash mismatch or a malformed frame)
+    bool apply(const uint8_t* data, size_t length);
+    bool isSynced() const { return synced; }
+
+    // Piece code on each location (0 empty); beside the board a location
+    // shows the last piece put there
+    uint8_t pieces[FEED_LOCATIONS];
+    uint64_t deltasApplied;
+    uint64_t keyframesApplied;
+    uint64_t hashMismatches;
+
+private:
+    bool synced;
+    uint32_t lastSequence;
+};
+
+#endif
@@ -1,7 +1,7 @@
 /*
 Author: Botao Huang
 Class: ECE6122 (A)
-Last Date Modified: 12/3/2024
+Last Date Modified: 10/19/2026
 Description:
 Chess component class definition file
 */
@@ -40,6 +40,13 @@ void chessComponent::getGeometricCenter()
 // Output: None
 void chessComponent::getBoundingBox()
 {
+    // No Vertices (Weird case)
+    if (vertices.empty())
+    {
+        cBoundingLimitsMin = glm::vec3(0.0f);
+        cBoundingLimitsMax = glm::vec3(0.0f);
+        return;
+    }
     // Initialize the min and max
     cBoundingLimitsMin = vertices.front();
     cBoundingLimitsMax = vertices.front();
@@ -73,10 +80,9 @@ chessComponent::chessComponent()
     normals.clear();
 
     // OpenGL Buffers management
-    vertexbuffer = 0;
-    uvbuffer = 0;
-    normalbuffer = 0;
-    elementbuffer = 0;
+    meshRange.baseVertex = 0;
+    meshRange.firstIndex = 0;
+    meshRange.indexCount = 0;
 
     // Component ID
     cName = "";
@@ -85,17 +91,21 @@ chessComponent::chessComponent()
     // Reset the geometric center
     cGeometricCener = glm::vec3(0.0f);
     cBoundingLimitsMin = glm::vec3(0.0f);
-    cBoundingLimitsMin = glm::vec3(0.0f);
+    cBoundingLimitsMax = glm::vec3(0.0f);
 
     // Reset the Texture handle
     Texture = 0;
+    textureLayer = 0;
+
+    // No corrections until the mesh is set up
+    cFlipWhenRotated = false;
+    cMeshCorrection = glm::mat4(1.0f);
 }
 
 // Destructor function
 chessComponent::~chessComponent()
 {
-    // Delete all the buffers
-    deleteGLBuffers();
+    // Buffers and textures belong to the mesh arena and texture arrays
 }
 
 // Reserve storage
@@ -152,52 +162,66 @@ void chessComponent::addFaceIndices(unsigned int *objFaceIndice)
     indices.push_back(objFaceIndice[2]);
 }
 
-// Setup rendering buffers
+// Setup the mesh once it is loaded
 // Inputs: None
 // Output: None
-void chessComponent::setupGLBuffers()
+void chessComponent::setupMesh()
 {
-    // Load it into a VBO
-    glGenBuffers(1, &vertexbuffer);
-    glBindBuffer(GL_ARRAY_BUFFER, vertexbuffer);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(glm::vec3), &vertices[0], GL_STATIC_DRAW);
-    
-    // Load it into UV Buffer
-    glGenBuffers(1, &uvbuffer);
-    glBindBuffer(GL_ARRAY_BUFFER, uvbuffer);
-    glBufferData(GL_ARRAY_BUFFER, uvs.size() * sizeof(glm::vec2), &uvs[0], GL_STATIC_DRAW);
-    
-    // Load it into the normals buffer
-    glGenBuffers(1, &normalbuffer);
-    glBindBuffer(GL_ARRAY_BUFFER, normalbuffer);
-    glBufferData(GL_ARRAY_BUFFER, normals.size() * sizeof(glm::vec3), &normals[0], GL_STATIC_DRAW);
-
-    // Generate a buffer for the indices as well
-    glGenBuffers(1, &elementbuffer);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, elementbuffer);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned short), &indices[0], GL_STATIC_DRAW);
-
     // Compute the Geometric center
     getGeometricCenter();
+    // Compute the Bounding box (for culling)
+    getBoundingBox();
+    // Corrections that depend only on the mesh
+    bakeModelCorrections();
+}
 
+// Append the mesh to the arena's vertices and indices
+// Inputs: Arena vertex and index data
+// Output: None
+void chessComponent::packMesh(std::vector<chessVertex>& arenaVertices, std::vector<unsigned short>& arenaIndices)
+{
+    meshRange.baseVertex = static_cast<GLint>(arenaVertices.size());
+    meshRange.firstIndex = static_cast<GLuint>(arenaIndices.size());
+    meshRange.indexCount = static_cast<GLsizei>(indices.size());
+
+    // Interleave position, uv and normal so a vertex is fetched from one place
+    for (size_t i = 0; i < vertices.size(); ++i)
+    {
+        chessVertex vertex;
+        vertex.position = vertices[i];
+        vertex.uv = (i < uvs.size()) ? uvs[i] : glm::vec2(0.0f);
+        vertex.normal = (i < normals.size()) ? normals[i] : glm::vec3(0.0f);
+        arenaVertices.push_back(vertex);
+    }
+    // Indices stay relative to the mesh (drawn with baseVertex)
+    arenaIndices.insert(arenaIndices.end(), indices.begin(), indices.end());
 }
 
-// Setup Texture buffers
+// Bake the per-mesh model corrections
 // Inputs: None
 // Output: None
-void chessComponent::setupTexture(GLuint& TextureID)
+void chessComponent::bakeModelCorrections()
 {
-    // Bind our texture in Texture Unit 0
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, Texture);
-    // Set our "myTextureSampler" sampler to use Texture Unit 0
-    glUniform1i(TextureID, 0);
+    // Rotate Knight/Bishop by another 180 degree aroudn Z
+    cFlipWhenRotated = (cName == "Object3" || cName == "ALFIERE3");
+    // Pull it to origin first (with height adjusted to X/Z plane)!
+    // We want the board surface to be in the X/Z plane. Need to move in -y direction
+    // equal to board's height.
+    if (cName == "12951_Stone_Chess_Board")
+    { // For Chess board eliminate the height by pushing it down by the height
+        // Apply the adjustment (Z is compensated to push the board down by depth)
+        cMeshCorrection = glm::translate(glm::mat4(1.0f), {-cGeometricCener.x, -cGeometricCener.y, -cGeometricCener.z/2});
+    }
+    else
+    { // For all others get to X/Z plane with Y=0
+        cMeshCorrection = glm::translate(glm::mat4(1.0f), {-cGeometricCener.x, 0.f, -cGeometricCener.z});
+    }
 }
 
-// Setup rendering buffers
-// Inputs: None
+// Setup Texture: find the file and take a layer of an array texture
+// Inputs: Texture array
 // Output: None
-void chessComponent::setupTextureBuffers()
+void chessComponent::setupTextureBuffers(chessTextureArray& textures)
 {
     // Matching pattern and rule creation
     // Any combination of 0-9, space in the beginning or end is allowed!
@@ -231,80 +255,53 @@ void chessComponent::setupTextureBuffers()
         std::cout << "Texture file not found for chess compoent!" << cName << std::endl;
     }
 
-    // Load the texture
-    Texture = loadBMP_custom(&cTextureFile[0]);
+    // The array of same size images and the layer in it (uploaded by the texture array's build)
+    textures.addLayer(cTextureFile, Texture, textureLayer);
 }
 
-// Render a mesh
+// Bind the texture in the active texture unit
 // Inputs: None
 // Output: None
-void chessComponent::renderMesh()
+void chessComponent::bindTexture()
 {
-    // 1rst attribute buffer : vertices
-    glEnableVertexAttribArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, vertexbuffer);
-    glVertexAttribPointer(
-        0,                  // attribute
-        3,                  // size
-        GL_FLOAT,           // type
-        GL_FALSE,           // normalized?
-        0,                  // stride
-        (void*)0            // array buffer offset
-    );
-
-    // 2nd attribute buffer : UVs
-    glEnableVertexAttribArray(1);
-    glBindBuffer(GL_ARRAY_BUFFER, uvbuffer);
-    glVertexAttribPointer(
-        1,                                // attribute
-        2,                                // size
-        GL_FLOAT,                         // type
-        GL_FALSE,                         // normalized?
-        0,                                // stride
-        (void*)0                          // array buffer offset
-    );
-
-    // 3rd attribute buffer : normals
-    glEnableVertexAttribArray(2);
-    glBindBuffer(GL_ARRAY_BUFFER, normalbuffer);
-    glVertexAttribPointer(
-        2,                                // attribute
-        3,                                // size
-        GL_FLOAT,                         // type
-        GL_FALSE,                         // normalized?
-        0,                                // stride
-        (void*)0                          // array buffer offset
-    );
-
-    // Index buffer
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, elementbuffer);
-
-    // Draw the triangles !
-    glDrawElements(
-        GL_TRIANGLES,      // mode
-        indices.size(),    // count
-        GL_UNSIGNED_SHORT,   // type
-        (void*)0           // element array buffer offset
-    );
-
-    // Disable the arrays
-    glDisableVertexAttribArray(0);
-    glDisableVertexAttribArray(1);
-    glDisableVertexAttribArray(2);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, Texture);
 }
 
-// Render a mesh
+// Get the texture handle
 // Inputs: None
-// Output: None
-void chessComponent::deleteGLBuffers()
+// Output: Texture handle
+GLuint chessComponent::getTexture() const
 {
-    // Cleanup VBO
-    glDeleteBuffers(1, &vertexbuffer);
-    glDeleteBuffers(1, &uvbuffer);
-    glDeleteBuffers(1, &normalbuffer);
-    glDeleteBuffers(1, &elementbuffer);
-    // Cleanup Texture buffer
-    glDeleteTextures(1, &Texture);
+    return Texture;
+}
+
+// Get the layer in the array texture
+// Inputs: None
+// Output: Layer
+int chessComponent::getTextureLayer() const
+{
+    return textureLayer;
+}
+
+// Get the model space bounding box
+// Inputs: None
+// Output: Minimum and maximum corners
+const glm::vec3& chessComponent::getBoundingMin() const
+{
+    return cBoundingLimitsMin;
+}
+
+const glm::vec3& chessComponent::getBoundingMax() const
+{
+    return cBoundingLimitsMax;
+}
+
+// Get the mesh's place in the mesh arena
+// Inputs: None
+// Output: Mesh range
+const chessMeshRange& chessComponent::getMeshRange() const
+{
+    return meshRange;
 }
 
 // Stores a component ID
@@ -340,7 +337,7 @@ void chessComponent::storeMeshProps(meshPropsT meshProps)
 // Generate model matrix
 // Inputs: None
 // Output: None
-glm::mat4 chessComponent::genModelMatrix(tPosition& cTPosition)
+glm::mat4 chessComponent::genModelMatrix(const tPosition& cTPosition) const
 {
     // Start with the Identity matrix
     glm::mat4 tModel = glm::mat4(1.0f);
@@ -349,8 +346,7 @@ glm::mat4 chessComponent::genModelMatrix(tPosition& cTPosition)
     // Apply target rotation
     if (cTPosition.rAngle != 0.f)   
     {
-        // Rotate Knight/Bishop by another 180 degree aroudn Z
-        if (cName == "Object3" || cName == "ALFIERE3")
+        if (cFlipWhenRotated)
         {
             tModel = glm::rotate(tModel, glm::radians(180.f), {0, 0, 1});
         }
@@ -358,21 +354,8 @@ glm::mat4 chessComponent::genModelMatrix(tPosition& cTPosition)
     }
     // Apply scaling
     tModel = glm::scale(tModel, cTPosition.cScale);
-    // Pull it to origin first (with height adjusted to X/Z plane)!
-    // tModel = glm::translate(tModel, -cGeometricCener);
-    // We want the board surface to be in the X/Z plane. Need to move in -y direction
-    // equal to board's height.
-    if (cName == "12951_Stone_Chess_Board")
-    { // For Chess board eliminate the height by pushing it down by the height
-        // Apply the adjustment (Z is compensated to push the board down by depth)
-        tModel = glm::translate(tModel, {-cGeometricCener.x, -cGeometricCener.y, -cGeometricCener.z/2});
-    }
-    else
-    { // For all others get to X/Z plane with Y=0
-        tModel = glm::translate(tModel, {-cGeometricCener.x, 0.f, -cGeometricCener.z});
-    }
-    // Return the matrix
-    return tModel;
+    // Then the mesh's own correction (baked at load time)
+    return tModel * cMeshCorrection;
 }
 
 // Get ID
@@ -387,11 +370,3 @@ std::string chessComponent::getComponentID()
 std::string chessComponent::getComponentID() const {
     return cName;
 }
-
-void chessComponent::storePosition(const tPosition& newPosition) {
-    currentPosition = newPosition; // Update the stored position
-}
-
-const tPosition& chessComponent::getPosition() const {
-    return currentPosition; // Return the current position
-}
@@ -1,7 +1,7 @@
 /*
 Author: Botao Huang
 Class: ECE6122 (A)
-Last Date Modified: 12/3/2024
+Last Date Modified: 10/19/2026
 Description:
 Chess component class header file
 */
@@ -20,8 +20,24 @@ Chess component class header file
 // Include GLEW
 #include <GL/glew.h>
 
-// Load BMP function support
-#include <common/texture.hpp>
+// Textures are layers of array textures (one per image size)
+#include "chessTextureArray.h"
+
+// Interleaved vertex, as stored in the mesh arena
+struct chessVertex
+{
+    glm::vec3 position;
+    glm::vec2 uv;
+    glm::vec3 normal;
+};
+
+// Where a mesh lives in the mesh arena (indices are relative to baseVertex)
+struct chessMeshRange
+{
+    GLint baseVertex;
+    GLuint firstIndex;
+    GLsizei indexCount;
+};
 
 class chessComponent
 {
@@ -32,10 +48,7 @@ private:
     std::vector<glm::vec2> uvs;
     std::vector<glm::vec3> normals;
 
-    GLuint vertexbuffer = 0;
-    GLuint uvbuffer = 0;
-    GLuint normalbuffer = 0;
-    GLuint elementbuffer = 0;
+    chessMeshRange meshRange;   // Set when packed into the mesh arena
 
     std::string cName;
     std::string cTextureFile;
@@ -45,13 +58,16 @@ private:
     glm::vec3 cBoundingLimitsMin = { 0, 0, 0 };
     glm::vec3 cBoundingLimitsMax = { 0, 0, 0 };
 
-    GLuint Texture;
+    GLuint Texture;             // Array texture (shared by images of one size)
+    int textureLayer;
 
-    // Add this member to track the piece's position and orientation
-    tPosition currentPosition;
+    // Per-mesh model corrections, baked once the mesh is loaded
+    bool cFlipWhenRotated;          // Knight/Bishop turn another 180 degrees
+    glm::mat4 cMeshCorrection;      // Centre (and board depth) offset
 
     void getGeometricCenter();
     void getBoundingBox();
+    void bakeModelCorrections();
 
 public:
     chessComponent();
@@ -63,22 +79,23 @@ public:
     void addTextureCor(glm::vec3& objUVW);
     void addVerNormals(glm::vec3& objVerNormal);
     void addFaceIndices(unsigned int* objFaceIndice);
-    void setupGLBuffers();
-    void setupTextureBuffers();
-    void setupTexture(GLuint& TextureID);
-    void renderMesh();
-    void deleteGLBuffers();
+    void setupMesh();
+    void packMesh(std::vector<chessVertex>& arenaVertices, std::vector<unsigned short>& arenaIndices);
+    void setupTextureBuffers(chessTextureArray& textures);
+    // Bind the array texture only (texture unit and sampler set once)
+    void bindTexture();
+    GLuint getTexture() const;
+    int getTextureLayer() const;
+    const chessMeshRange& getMeshRange() const;
+    const glm::vec3& getBoundingMin() const;
+    const glm::vec3& getBoundingMax() const;
     void storeComponentID(std::string cName);
     void storeTextureID(std::string cTextureFile);
     void storeMeshProps(meshPropsT meshProps);
-    glm::mat4 genModelMatrix(tPosition& cTPosition);
+    glm::mat4 genModelMatrix(const tPosition& cTPosition) const;
 
     std::string getComponentID();
     std::string getComponentID() const;
-
-    // New methods to handle position updates
-    void storePosition(const tPosition& newPosition); // Update position
-    const tPosition& getPosition() const;            // Retrieve position
 };
 
 #endif
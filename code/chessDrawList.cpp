@@ -0,0 +1,317 @@
+/*
+Author: Botao Huang
+Class: ECE6122 (A)
+Last Date Modified: 10/19/2026
+Description:
+Draw list for the chess scene definition file
+*/
+
+#include <algorithm>
+#include <cstddef>
+#include "chessDrawList.h"
+
+// Constructor function
+chessDrawList::chessDrawList() : changed(false), recomputed(0), visibleCount(0), visibilityDirty(false),
+    instanceBuffer(0), instanceCapacity(0), useIndirect(false), indirectBuffer(0), indirectCapacity(0)
+{
+}
+
+// Destructor function
+chessDrawList::~chessDrawList()
+{
+    deleteGLBuffers();
+}
+
+// Submit with glMultiDrawElementsIndirect (needs ARB_multi_draw_indirect and
+// ARB_base_instance), otherwise one glDrawElementsInstancedBaseVertex per mesh
+void chessDrawList::setIndirect(bool indirect)
+{
+    useIndirect = indirect;
+}
+
+void chessDrawList::clear()
+{
+    nextEntries.clear();
+    nextModels.clear();
+    nextBounds.clear();
+    changed = false;
+}
+
+namespace
+{
+    // Upload to a buffer, growing it only when the data got bigger
+    void uploadGrowing(GLenum target, GLuint& buffer, size_t& capacity, const void* data, size_t bytes)
+    {
+        if (buffer == 0)
+        {
+            glGenBuffers(1, &buffer);
+        }
+        glBindBuffer(target, buffer);
+        if (bytes > capacity)
+        {
+            capacity = bytes;
+            glBufferData(target, bytes, data, GL_DYNAMIC_DRAW);
+        }
+        else
+        {
+            glBufferSubData(target, 0, bytes, data);
+        }
+    }
+
+    bool samePosition(const tPosition& a, const tPosition& b)
+    {
+        return a.rCnt == b.rCnt && a.rDis == b.rDis && a.rAngle == b.rAngle &&
+            a.rAxis == b.rAxis && a.cScale == b.cScale && a.tPos == b.tPos;
+    }
+}
+
+// Add the next scene entry: a component at a position (rCnt draws, rDis squares apart)
+void chessDrawList::add(const std::vector<chessComponent>& components, int component, const tPosition& position)
+{
+    chessDrawEntry entry;
+    entry.component = component;
+    entry.position = position;
+    entry.first = nextModels.size();
+    entry.count = position.rCnt;
+
+    // Entries keep their order between scenes: compare with the same entry last time
+    size_t index = nextEntries.size();
+    if (index < entries.size() && entries[index].component == component &&
+        samePosition(entries[index].position, position))
+    {
+        const chessDrawEntry& cached = entries[index];
+        nextModels.insert(nextModels.end(), models.begin() + cached.first,
+            models.begin() + cached.first + cached.count);
+        nextBounds.insert(nextBounds.end(), bounds.begin() + cached.first,
+            bounds.begin() + cached.first + cached.count);
+    }
+    else
+    {
+        const chessComponent& mesh = components[component];
+        for (unsigned int pit = 0; pit < position.rCnt; ++pit)
+        {
+            tPosition morph = position;
+            morph.tPos.x += pit * position.rDis * CHESS_BOX_SIZE;
+            nextModels.push_back(mesh.genModelMatrix(morph));
+            nextBounds.push_back(transformBounds(mesh.getBoundingMin(), mesh.getBoundingMax(), nextModels.back()));
+        }
+        recomputed += position.rCnt;
+        changed = true;
+    }
+    nextEntries.push_back(entry);
+}
+
+// After the last add: sort, batch by mesh and upload the instance matrices
+// (nothing to do when no entry changed)
+void chessDrawList::build(const std::vector<chessComponent>& components)
+{
+    if (nextEntries.size() != entries.size())
+    {
+        changed = true;
+    }
+    entries.swap(nextEntries);
+    models.swap(nextModels);
+    bounds.swap(nextBounds);
+    if (!changed)
+    {
+        return;
+    }
+
+    draws.clear();
+    for (const chessDrawEntry& entry : entries)
+    {
+        for (size_t i = 0; i < entry.count; ++i)
+        {
+            chessDraw draw;
+            draw.component = entry.component;
+            draw.texture = components[entry.component].getTexture();
+            draw.key = (static_cast<uint64_t>(draw.texture) << 32) | static_cast<uint32_t>(draw.component);
+            draw.model = entry.first + i;
+            draws.push_back(draw);
+        }
+    }
+    std::sort(draws.begin(), draws.end(), [](const chessDraw& a, const chessDraw& b)
+    {
+        return a.key < b.key;
+    });
+
+    batches.clear();
+    instances.clear();
+    instanceBounds.clear();
+    for (const chessDraw& draw : draws)
+    {
+        if (batches.empty() || batches.back().component != draw.component)
+        {
+            chessDrawBatch batch;
+            batch.component = draw.component;
+            batch.texture = draw.texture;
+            batch.first = static_cast<GLsizei>(instances.size());
+            batch.count = 0;
+            batches.push_back(batch);
+        }
+        ++batches.back().count;
+        chessInstance instance;
+        instance.model = models[draw.model];
+        instance.layer = static_cast<float>(components[draw.component].getTextureLayer());
+        instance.padding[0] = instance.padding[1] = instance.padding[2] = 0.0f;
+        instances.push_back(instance);
+        instanceBounds.add(bounds[draw.model]);
+    }
+
+    // One indirect command per batch, one multi-draw per texture
+    commands.clear();
+    groups.clear();
+    for (const chessDrawBatch& batch : batches)
+    {
+        const chessMeshRange& range = components[batch.component].getMeshRange();
+        chessDrawCommand command;
+        command.count = static_cast<GLuint>(range.indexCount);
+        command.instanceCount = 0;          // Set by cull
+        command.firstIndex = range.firstIndex;
+        command.baseVertex = range.baseVertex;
+        command.baseInstance = 0;
+        if (groups.empty() || groups.back().texture != batch.texture)
+        {
+            chessTextureGroup group;
+            group.component = batch.component;
+            group.texture = batch.texture;
+            group.firstCommand = commands.size();
+            group.commandCount = 0;
+            groups.push_back(group);
+        }
+        ++groups.back().commandCount;
+        commands.push_back(command);
+    }
+    visibilityDirty = true;
+}
+
+// Every frame before render: cull against the view frustum, uploading the
+// visible instances and the draw commands when visibility changed
+void chessDrawList::cull(const glm::mat4& viewProjection)
+{
+    chessFrustum frustum;
+    frustum.extract(viewProjection);
+    visibleCount = frustum.cull(instanceBounds, culled);
+    if (!visibilityDirty && culled == visible)
+    {
+        return;
+    }
+    visible.swap(culled);
+    visibilityDirty = false;
+
+    // Each batch's visible matrices, packed
+    visibleInstances.clear();
+    for (size_t b = 0; b < batches.size(); ++b)
+    {
+        const chessDrawBatch& batch = batches[b];
+        chessDrawCommand& command = commands[b];
+        command.baseInstance = static_cast<GLuint>(visibleInstances.size());
+        for (GLsizei i = batch.first; i < batch.first + batch.count; ++i)
+        {
+            if (visible[i])
+            {
+                visibleInstances.push_back(instances[i]);
+            }
+        }
+        command.instanceCount = static_cast<GLuint>(visibleInstances.size()) - command.baseInstance;
+    }
+    if (visibleInstances.empty())
+    {
+        return;
+    }
+
+    uploadGrowing(GL_ARRAY_BUFFER, instanceBuffer, instanceCapacity, visibleInstances.data(),
+        visibleInstances.size() * sizeof(chessInstance));
+    if (useIndirect)
+    {
+        uploadGrowing(GL_DRAW_INDIRECT_BUFFER, indirectBuffer, indirectCapacity, commands.data(),
+            commands.size() * sizeof(chessDrawCommand));
+    }
+}
+
+// Draw the list; the caller set the per-frame uniforms, texture unit and sampler
+void chessDrawList::render(std::vector<chessComponent>& components, const chessMeshArena& arena) const
+{
+    if (visibleInstances.empty())
+    {
+        return;
+    }
+
+    // Same buffers every frame: the arena's vertex array, instances and commands
+    arena.bind();
+    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+    if (useIndirect)
+    {
+        // Each command picks its matrices by baseInstance
+        pointInstances(0);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer);
+        // (Culled meshes are commands without instances)
+        for (const chessTextureGroup& group : groups)
+        {
+            components[group.component].bindTexture();
+            glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_SHORT,
+                (void*)(group.firstCommand * sizeof(chessDrawCommand)), group.commandCount, 0);
+        }
+    }
+    else
+    {
+        GLuint boundTexture = 0;
+        bool textureBound = false;
+        for (size_t i = 0; i < batches.size(); ++i)
+        {
+            const chessDrawBatch& batch = batches[i];
+            const chessDrawCommand& command = commands[i];
+            if (command.instanceCount == 0)
+            {
+                continue;
+            }
+            if (!textureBound || batch.texture != boundTexture)
+            {
+                components[batch.component].bindTexture();
+                boundTexture = batch.texture;
+                textureBound = true;
+            }
+            // No base instance in OpenGL 3.3, so the offset goes in the pointers
+            pointInstances(static_cast<GLsizei>(command.baseInstance));
+            glDrawElementsInstancedBaseVertex(GL_TRIANGLES, command.count, GL_UNSIGNED_SHORT,
+                (void*)(command.firstIndex * sizeof(unsigned short)), command.instanceCount, command.baseVertex);
+        }
+    }
+    chessMeshArena::unbind();
+}
+
+void chessDrawList::deleteGLBuffers()
+{
+    if (instanceBuffer != 0)
+    {
+        glDeleteBuffers(1, &instanceBuffer);
+        instanceBuffer = 0;
+    }
+    instanceCapacity = 0;
+    if (indirectBuffer != 0)
+    {
+        glDeleteBuffers(1, &indirectBuffer);
+        indirectBuffer = 0;
+    }
+    indirectCapacity = 0;
+}
+
+// Point the instance attributes at a batch's first instance
+// (instance buffer bound)
+void chessDrawList::pointInstances(GLsizei first) const
+{
+    size_t offset = static_cast<size_t>(first) * sizeof(chessInstance);
+    for (GLuint column = 0; column < 4; ++column)
+    {
+        glVertexAttribPointer(
+            INSTANCE_MATRIX_ATTRIBUTE + column,     // attribute
+            4,                                      // size
+            GL_FLOAT,                               // type
+            GL_FALSE,                               // normalized?
+            sizeof(chessInstance),                  // stride
+            (void*)(offset + offsetof(chessInstance, model) + column * sizeof(glm::vec4))    // array buffer offset
+        );
+    }
+    glVertexAttribPointer(INSTANCE_LAYER_ATTRIBUTE, 1, GL_FLOAT, GL_FALSE, sizeof(chessInstance),
+        (void*)(offset + offsetof(chessInstance, layer)));
+}
@@ -0,0 +1,153 @@
+/*
+Author: Botao Huang
+Class: ECE6122 (A)
+Last Date Modified: 10/19/2026
+Description:
+Draw list for the chess scene
+Model matrices (and world bounding boxes) are cached per scene entry and
+recomputed only for entries that moved; draws are sorted by texture and mesh
+when the scene changes. Every frame the boxes are culled against the view
+frustum; the visible instances and one indirect draw command per mesh are
+uploaded when visibility changed. Textures are layers of array textures (one
+per image size), so a frame binds each array once and issues one multi-draw per
+array (or one instanced draw per mesh without ARB_multi_draw_indirect) from the
+shared mesh arena
+*/
+
+#ifndef CHESS_DRAW_LIST_H
+#define CHESS_DRAW_LIST_H
+
+#include <vector>
+#include "chessComponent.h"
+#include "chessMeshArena.h"
+#include "chessFrustum.h"
+
+// One scene entry and its cached model matrices
+struct chessDrawEntry
+{
+    int component;          // Index in the component list
+    tPosition position;
+    size_t first;           // First of its model matrices
+    size_t count;           // rCnt matrices
+};
+
+// One mesh drawn once
+struct chessDraw
+{
+    uint64_t key;           // Render queue order: texture, then mesh (one program)
+    int component;
+    GLuint texture;
+    size_t model;           // Index of its model matrix
+};
+
+// Instance buffer entry
+struct chessInstance
+{
+    glm::mat4 model;
+    float layer;            // Texture array layer
+    float padding[3];
+};
+static_assert(sizeof(chessInstance) == 80, "instances are a matrix and a vec4");
+
+// Consecutive draws of one mesh, drawn instanced
+struct chessDrawBatch
+{
+    int component;
+    GLuint texture;
+    GLsizei first;          // First instance, visible or not
+    GLsizei count;
+};
+
+// glMultiDrawElementsIndirect's command layout (DrawElementsIndirectCommand)
+struct chessDrawCommand
+{
+    GLuint count;
+    GLuint instanceCount;
+    GLuint firstIndex;
+    GLint baseVertex;
+    GLuint baseInstance;
+};
+static_assert(sizeof(chessDrawCommand) == 20, "indirect draw commands are 5 words");
+
+// Consecutive batches with one texture, one multi-draw
+struct chessTextureGroup
+{
+    int component;          // Any component with the texture (binds it)
+    GLuint texture;
+    size_t firstCommand;
+    GLsizei commandCount;
+};
+
+class chessDrawList
+{
+private:
+    // Last scene's entries and model matrices, and the scene being added
+    std::vector<chessDrawEntry> entries;
+    std::vector<glm::mat4> models;
+    std::vector<chessBounds> bounds;        // World box of each model
+    std::vector<chessDrawEntry> nextEntries;
+    std::vector<glm::mat4> nextModels;
+    std::vector<chessBounds> nextBounds;
+    bool changed;               // An entry differs from the last scene
+    size_t recomputed;          // Model matrices computed so far
+
+    std::vector<chessDraw> draws;
+    std::vector<chessDrawBatch> batches;
+    // Instances and their boxes in batch order
+    std::vector<chessInstance> instances;
+    chessBoundsList instanceBounds;
+
+    // Last frame's culling; the visible matrices are in the instance buffer
+    std::vector<uint8_t> visible;
+    std::vector<uint8_t> culled;            // This frame's, compared with visible
+    std::vector<chessInstance> visibleInstances;
+    size_t visibleCount;
+    bool visibilityDirty;                   // Scene changed since the last upload
+    GLuint instanceBuffer;
+    size_t instanceCapacity;    // Bytes the buffer holds
+
+    // One command per batch (its visible instances), grouped by texture
+    std::vector<chessDrawCommand> commands;
+    std::vector<chessTextureGroup> groups;
+    bool useIndirect;
+    GLuint indirectBuffer;
+    size_t indirectCapacity;    // Bytes the buffer holds
+
+public:
+    chessDrawList();
+    ~chessDrawList();
+
+    // Submit with glMultiDrawElementsIndirect (needs ARB_multi_draw_indirect and
+    // ARB_base_instance), otherwise one glDrawElementsInstancedBaseVertex per mesh
+    void setIndirect(bool indirect);
+    bool isIndirect() const { return useIndirect; }
+
+    // Start a new scene (keeps the capacity and the cached matrices)
+    void clear();
+    // Add the next scene entry: a component at a position (rCnt draws, rDis squares apart)
+    void add(const std::vector<chessComponent>& components, int component, const tPosition& position);
+    // After the last add: sort and batch by mesh (nothing to do when no entry changed)
+    void build(const std::vector<chessComponent>& components);
+    // Every frame before render: cull against the view frustum, uploading the
+    // visible instances and the draw commands when visibility changed
+    void cull(const glm::mat4& viewProjection);
+
+    // Draw the list; the caller set the per-frame uniforms, texture unit and sampler
+    void render(std::vector<chessComponent>& components, const chessMeshArena& arena) const;
+    void deleteGLBuffers();
+
+    size_t size() const { return draws.size(); }
+    size_t getBatchCount() const { return batches.size(); }
+    size_t getGroupCount() const { return groups.size(); }
+    size_t getRecomputed() const { return recomputed; }
+    // Instances drawn and culled by the last cull
+    size_t getVisibleCount() const { return visibleCount; }
+    size_t getCulledCount() const { return instances.size() - visibleCount; }
+
+private:
+    // Point the instance attributes at a batch's first instance
+    // (instance buffer bound)
+    void pointInstances(GLsizei first) const;
+};
+
+#endif
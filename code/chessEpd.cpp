@@ -0,0 +1,148 @@
+/*
+Author: Botao Huang
+Class: ECE6122 (A)
+Last Date Modified: 10/19/2026
+Description:
+EPD / FEN record parsing definition file
+*/
+
+#include <sstream>
+#include <algorithm>
+#include <cctype>
+#include "chessEpd.h"
+#include "chessPosition.h"
+
+namespace
+{
+    // Whole token is a non negative integer
+    bool isNumber(const std::string& token)
+    {
+        if (token.empty())
+            return false;
+        for (char c : token)
+        {
+            if (!std::isdigit(static_cast<unsigned char>(c)))
+                return false;
+        }
+        return true;
+    }
+
+    // Strip surrounding blanks and quotes
+    std::string trimOperand(const std::string& text)
+    {
+        size_t first = text.find_first_not_of(" \t\"");
+        if (first == std::string::npos)
+            return "";
+        size_t last = text.find_last_not_of(" \t\"");
+        return text.substr(first, last - first + 1);
+    }
+}
+
+// Operand of an operation ("" when absent)
+std::string EpdRecord::operation(const std::string& opcode) const
+{
+    for (const auto& op : operations)
+    {
+        if (op.first == opcode)
+            return op.second;
+    }
+    return "";
+}
+
+// Whether the operation is present
+bool EpdRecord::hasOperation(const std::string& opcode) const
+{
+    for (const auto& op : operations)
+    {
+        if (op.first == opcode)
+            return true;
+    }
+    return false;
+}
+
+// Record id from the "id" operation, or a fallback
+std::string EpdRecord::id(const std::string& fallback) const
+{
+    std::string value = operation("id");
+    return value.empty() ? fallback : value;
+}
+
+// Parse one EPD or FEN line
+bool parseEpdLine(const std::string& line, EpdRecord& record, std::string& error)
+{
+    error.clear();
+    record.fen.clear();
+    record.operations.clear();
+
+    size_t start = line.find_first_not_of(" \t\r\n");
+    if (start == std::string::npos || line[start] == '#')
+    {
+        return false;
+    }
+
+    // The first four fields are the position itself
+    std::istringstream iss(line.substr(start));
+    std::string fields[4];
+    if (!(iss >> fields[0] >> fields[1] >> fields[2] >> fields[3]))
+    {
+        error = "too few fields";
+        return false;
+    }
+    std::string rest;
+    std::getline(iss, rest);
+
+    chessPosition position;
+    if (!position.setFromFen(fields[0] + " " + fields[1] + " " + fields[2] + " " + fields[3]))
+    {
+        error = "malformed position";
+        return false;
+    }
+
+    // FEN lines carry the two move counters next, EPD lines carry operations
+    std::istringstream restStream(rest);
+    std::string halfMoves, fullMoves;
+    if (restStream >> halfMoves >> fullMoves && isNumber(halfMoves) && isNumber(fullMoves))
+    {
+        position.halfMoveClock = std::stoi(halfMoves);
+        position.fullMoveNumber = std::max(1, std::stoi(fullMoves));
+        std::getline(restStream, rest);
+    }
+
+    // Operations are "opcode operand...;" with operands possibly quoted
+    std::string operationText;
+    bool inQuotes = false;
+    for (char c : rest)
+    {
+        if (c == '"')
+        {
+            inQuotes = !inQuotes;
+        }
+        if (c == ';' && !inQuotes)
+        {
+            std::istringstream opStream(operationText);
+            std::string opcode;
+            if (opStream >> opcode)
+            {
+                std::string operand;
+                std::getline(opStream, operand);
+                record.operations.push_back(std::make_pair(opcode, trimOperand(operand)));
+            }
+            operationText.clear();
+        }
+        else
+        {
+            operationText += c;
+        }
+    }
+
+    // EPD move counter operations
+    std::string hmvc = record.operation("hmvc");
+    std::string fmvn = record.operation("fmvn");
+    if (isNumber(hmvc))
+        position.halfMoveClock = std::stoi(hmvc);
+    if (isNumber(fmvn))
+        position.fullMoveNumber = std::max(1, std::stoi(fmvn));
+
+    record.fen = position.toFen();
+    return true;
+}
@@ -0,0 +1,34 @@
+/*
+Author: Botao Huang
+Class: ECE6122 (A)
+Last Date Modified: 10/19/2026
+Description:
+EPD / FEN record parsing
+One position per line, EPD operations ("bm Nf3; id \"WAC.001\";") are kept
+*/
+
+#ifndef CHESS_EPD_H
+#define CHESS_EPD_H
+
+#include <string>
+#include <vector>
+#include <utility>
+
+// One position read from an EPD or FEN file
+struct EpdRecord
+{
+    std::string fen;    // Full FEN (move counters filled in for EPD lines)
+    std::vector<std::pair<std::string, std::string>> operations;
+
+    // Operand of an operation ("" when absent)
+    std::string operation(const std::string& opcode) const;
+    bool hasOperation(const std::string& opcode) const;
+    // Record id from the "id" operation, or a fallback
+    std::string id(const std::string& fallback) const;
+};
+
+// Parse one line; returns false for blank/comment lines or malformed positions
+// (error is set only for malformed positions)
+bool parseEpdLine(const std::string& line, EpdRecord& record, std::string& error);
+
+#endif
@@ -0,0 +1,39 @@
+/*
+Author: Botao Huang
+Class: ECE6122 (A)
+Last Date Modified: 10/19/2026
+Description:
+Per-frame uniform block shared by the StandardShading shaders
+Camera and lighting state are the same for every draw of a frame, so they are
+uploaded once per frame into a std140 uniform buffer
+*/
+
+#ifndef CHESS_FRAME_UNIFORMS_H
+#define CHESS_FRAME_UNIFORMS_H
+
+#include <cstddef>
+#include <glm/glm.hpp>
+#include <GL/glew.h>
+
+// Uniform block name and binding point
+const char FRAME_UNIFORMS_BLOCK[] = "FrameUniforms";
+const GLuint FRAME_UNIFORMS_BINDING = 0;
+
+// Matches the FrameUniforms block (std140 layout) member for member
+struct chessFrameUniforms
+{
+    glm::mat4 view;
+    glm::mat4 projection;
+    glm::mat4 viewProjection;
+    glm::vec3 lightPosition;    // World space
+    float lightPower;           // Packed into lightPosition's last float
+    int lightSwitch;            // GLSL bools are 4 bytes in std140
+    float time;                 // Seconds since the window opened
+    int frame;
+    int padding;
+};
+static_assert(offsetof(chessFrameUniforms, lightPosition) == 192, "FrameUniforms: matrices take 64 bytes each");
+static_assert(offsetof(chessFrameUniforms, lightPower) == 204, "FrameUniforms: LightPower follows the vec3");
+static_assert(sizeof(chessFrameUniforms) == 224, "FrameUniforms: std140 block size");
+
+#endif
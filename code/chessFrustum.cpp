@@ -0,0 +1,175 @@
+/*
+Author: Botao Huang
+Class: ECE6122 (A)
+Last Date Modified: 10/19/2026
+Description:
+View frustum culling definition file
+*/
+
+#include <cmath>
+#include "chessFrustum.h"
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define CHESS_FRUSTUM_SSE 1
+#endif
+
+// Box around a model space box once transformed by a model matrix
+chessBounds transformBounds(const glm::vec3& localMin, const glm::vec3& localMax, const glm::mat4& model)
+{
+    glm::vec3 localCenter = (localMin + localMax) * 0.5f;
+    glm::vec3 localExtent = (localMax - localMin) * 0.5f;
+
+    chessBounds bounds;
+    bounds.center = glm::vec3(model * glm::vec4(localCenter, 1.0f));
+    // Each world axis gets the extent along it of every (scaled, rotated) model axis
+    for (int row = 0; row < 3; ++row)
+    {
+        bounds.extent[row] = std::fabs(model[0][row]) * localExtent.x +
+            std::fabs(model[1][row]) * localExtent.y +
+            std::fabs(model[2][row]) * localExtent.z;
+    }
+    return bounds;
+}
+
+void chessBoundsList::clear()
+{
+    centerX.clear();
+    centerY.clear();
+    centerZ.clear();
+    extentX.clear();
+    extentY.clear();
+    extentZ.clear();
+}
+
+void chessBoundsList::add(const chessBounds& bounds)
+{
+    centerX.push_back(bounds.center.x);
+    centerY.push_back(bounds.center.y);
+    centerZ.push_back(bounds.center.z);
+    extentX.push_back(bounds.extent.x);
+    extentY.push_back(bounds.extent.y);
+    extentZ.push_back(bounds.extent.z);
+}
+
+// Constructor function (everything visible until the first extract)
+chessFrustum::chessFrustum()
+{
+    for (int p = 0; p < 6; ++p)
+    {
+        planes[p][0] = 0.0f;
+        planes[p][1] = 0.0f;
+        planes[p][2] = 0.0f;
+        planes[p][3] = 1.0f;
+    }
+}
+
+// Planes of a view-projection matrix (normalised)
+void chessFrustum::extract(const glm::mat4& viewProjection)
+{
+    // Rows of the matrix (glm is column major)
+    glm::vec4 rows[4];
+    for (int r = 0; r < 4; ++r)
+    {
+        rows[r] = glm::vec4(viewProjection[0][r], viewProjection[1][r], viewProjection[2][r], viewProjection[3][r]);
+    }
+    glm::vec4 sides[6] = {
+        rows[3] + rows[0], rows[3] - rows[0],   // left, right
+        rows[3] + rows[1], rows[3] - rows[1],   // bottom, top
+        rows[3] + rows[2], rows[3] - rows[2]    // near, far
+    };
+    for (int p = 0; p < 6; ++p)
+    {
+        float length = glm::length(glm::vec3(sides[p]));
+        if (length > 0.0f)
+        {
+            sides[p] /= length;
+        }
+        planes[p][0] = sides[p].x;
+        planes[p][1] = sides[p].y;
+        planes[p][2] = sides[p].z;
+        planes[p][3] = sides[p].w;
+    }
+}
+
+bool chessFrustum::isVisible(const chessBounds& bounds) const
+{
+    for (int p = 0; p < 6; ++p)
+    {
+        // Distance of the box's corner furthest along the plane normal
+        float distance = planes[p][0] * bounds.center.x + planes[p][1] * bounds.center.y +
+            planes[p][2] * bounds.center.z + planes[p][3] +
+            std::fabs(planes[p][0]) * bounds.extent.x + std::fabs(planes[p][1]) * bounds.extent.y +
+            std::fabs(planes[p][2]) * bounds.extent.z;
+        if (distance < 0.0f)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// visible[i] is 1 when box i is at least partly inside; returns the visible count
+size_t chessFrustum::cull(const chessBoundsList& boxes, std::vector<uint8_t>& visible) const
+{
+    size_t count = boxes.size();
+    visible.resize(count);
+    size_t visibleCount = 0;
+    size_t i = 0;
+
+#ifdef CHESS_FRUSTUM_SSE
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 signBit = _mm_set1_ps(-0.0f);
+    __m128 normal[6][3], absNormal[6][3], offset[6];
+    for (int p = 0; p < 6; ++p)
+    {
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            normal[p][axis] = _mm_set1_ps(planes[p][axis]);
+            absNormal[p][axis] = _mm_andnot_ps(signBit, normal[p][axis]);
+        }
+        offset[p] = _mm_set1_ps(planes[p][3]);
+    }
+
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 cx = _mm_loadu_ps(&boxes.centerX[i]);
+        __m128 cy = _mm_loadu_ps(&boxes.centerY[i]);
+        __m128 cz = _mm_loadu_ps(&boxes.centerZ[i]);
+        __m128 ex = _mm_loadu_ps(&boxes.extentX[i]);
+        __m128 ey = _mm_loadu_ps(&boxes.extentY[i]);
+        __m128 ez = _mm_loadu_ps(&boxes.extentZ[i]);
+
+        __m128 inside = _mm_cmpeq_ps(zero, zero);
+        for (int p = 0; p < 6; ++p)
+        {
+            __m128 distance = _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(normal[p][0], cx), _mm_mul_ps(normal[p][1], cy)),
+                _mm_add_ps(_mm_mul_ps(normal[p][2], cz), offset[p]));
+            __m128 reach = _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(absNormal[p][0], ex), _mm_mul_ps(absNormal[p][1], ey)),
+                _mm_mul_ps(absNormal[p][2], ez));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(distance, reach), zero));
+        }
+
+        int mask = _mm_movemask_ps(inside);
+        for (int lane = 0; lane < 4; ++lane)
+        {
+            uint8_t in = static_cast<uint8_t>((mask >> lane) & 1);
+            visible[i + lane] = in;
+            visibleCount += in;
+        }
+    }
+#endif
+
+    // The rest (everything without SSE)
+    for (; i < count; ++i)
+    {
+        chessBounds bounds;
+        bounds.center = glm::vec3(boxes.centerX[i], boxes.centerY[i], boxes.centerZ[i]);
+        bounds.extent = glm::vec3(boxes.extentX[i], boxes.extentY[i], boxes.extentZ[i]);
+        visible[i] = isVisible(bounds) ? 1 : 0;
+        visibleCount += visible[i];
+    }
+    return visibleCount;
+}
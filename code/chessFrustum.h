@@ -0,0 +1,59 @@
+/*
+Author: Botao Huang
+Class: ECE6122 (A)
+Last Date Modified: 10/19/2026
+Description:
+View frustum culling of world space bounding boxes
+The six planes come from the view-projection matrix; boxes are kept in
+structure-of-arrays form and tested four at a time with SSE where available
+*/
+
+#ifndef CHESS_FRUSTUM_H
+#define CHESS_FRUSTUM_H
+
+#include <vector>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+// World space axis aligned box
+struct chessBounds
+{
+    glm::vec3 center;
+    glm::vec3 extent;       // Half size
+};
+
+// Box around a model space box once transformed by a model matrix
+chessBounds transformBounds(const glm::vec3& localMin, const glm::vec3& localMax, const glm::mat4& model);
+
+// Boxes laid out for four-wide tests
+class chessBoundsList
+{
+private:
+    std::vector<float> centerX, centerY, centerZ;
+    std::vector<float> extentX, extentY, extentZ;
+
+public:
+    void clear();
+    void add(const chessBounds& bounds);
+    size_t size() const { return centerX.size(); }
+
+    friend class chessFrustum;
+};
+
+class chessFrustum
+{
+private:
+    // a*x + b*y + c*z + d >= 0 inside: left, right, bottom, top, near, far
+    float planes[6][4];
+
+public:
+    chessFrustum();
+
+    // Planes of a view-projection matrix (normalised)
+    void extract(const glm::mat4& viewProjection);
+    bool isVisible(const chessBounds& bounds) const;
+    // visible[i] is 1 when box i is at least partly inside; returns the visible count
+    size_t cull(const chessBoundsList& boxes, std::vector<uint8_t>& visible) const;
+};
+
+#endif
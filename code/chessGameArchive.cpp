@@ -0,0 +1,274 @@
+/*
+Author: Botao Huang
+Class: ECE6122 (A)
+Last Date Modified: 10/19/2026
+Description:
+Append-only game archive definition file
+*/
+
+#include <cstring>
+#include <algorithm>
+#include "chessGameArchive.h"
+#include "chessPosition.h"
+
+namespace
+{
+    void putVarint(std::string& out, uint32_t value)
+    {
+        while (value >= 0x80)
+        {
+            out += static_cast<char>((value & 0x7F) | 0x80);
+            value >>= 7;
+        }
+        out += static_cast<char>(value);
+    }
+
+    bool getVarint(const uint8_t*& cursor, const uint8_t* end, uint32_t& value)
+    {
+        value = 0;
+        for (int shift = 0; cursor < end && shift < 35; shift += 7)
+        {
+            uint8_t byte = *cursor++;
+            value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0)
+                return true;
+        }
+        return false;
+    }
+
+    // Index file header
+    void makeHeader(char header[GAME_INDEX_HEADER_SIZE])
+    {
+        std::memset(header, 0, GAME_INDEX_HEADER_SIZE);
+        std::memcpy(header, GAME_INDEX_MAGIC, sizeof(GAME_INDEX_MAGIC));
+        uint32_t version = GAME_INDEX_VERSION;
+        uint32_t entrySize = sizeof(chessGameIndexEntry);
+        std::memcpy(header + 8, &version, sizeof(version));
+        std::memcpy(header + 12, &entrySize, sizeof(entrySize));
+    }
+
+    // Size of a file, 0 when missing
+    uint64_t fileSize(const std::string& path)
+    {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        return file ? static_cast<uint64_t>(file.tellg()) : 0;
+    }
+}
+
+// Constructor function
+chessGameArchiveWriter::chessGameArchiveWriter() : moveOffset(0), games(0)
+{
+}
+
+// Create the archive or continue an existing one
+bool chessGameArchiveWriter::open(const std::string& basePath)
+{
+    close();
+    std::string indexPath = basePath + ".idx";
+    uint64_t indexSize = fileSize(indexPath);
+
+    if (indexSize >= GAME_INDEX_HEADER_SIZE)
+    {
+        // Existing archive: check the header and that the index holds whole records
+        char expected[GAME_INDEX_HEADER_SIZE];
+        char header[GAME_INDEX_HEADER_SIZE];
+        makeHeader(expected);
+        std::ifstream existing(indexPath, std::ios::binary);
+        if (!existing.read(header, sizeof(header)) || std::memcmp(header, expected, sizeof(header)) != 0)
+        {
+            return false;
+        }
+        games = (indexSize - GAME_INDEX_HEADER_SIZE) / sizeof(chessGameIndexEntry);
+        if (games * sizeof(chessGameIndexEntry) + GAME_INDEX_HEADER_SIZE != indexSize)
+        {
+            return false;
+        }
+        indexFile.open(indexPath, std::ios::binary | std::ios::app);
+    }
+    else
+    {
+        char header[GAME_INDEX_HEADER_SIZE];
+        makeHeader(header);
+        indexFile.open(indexPath, std::ios::binary | std::ios::trunc);
+        indexFile.write(header, sizeof(header));
+        games = 0;
+    }
+
+    // Move streams only grow; bytes after the last indexed game are never referenced
+    moveOffset = fileSize(basePath + ".mov");
+    moveFile.open(basePath + ".mov", std::ios::binary | std::ios::app);
+    return indexFile.good() && moveFile.good();
+}
+
+// Move stream of a game, false if a move is not legal in its position
+bool chessGameArchiveWriter::encode(const chessGameRecord& game, std::string& stream)
+{
+    stream.clear();
+    chessPosition position;
+    if (!game.startFen.empty())
+    {
+        position.setFromFen(game.startFen);
+        putVarint(stream, static_cast<uint32_t>(game.startFen.size()));
+        stream += game.startFen;
+    }
+
+    // Candidate (pseudo legal) order is as stable as the legal one and skips the
+    // legality checks; the moves were legal when they were recorded
+    uint16_t candidates[MAX_CANDIDATE_MOVES];
+    for (uint16_t move : game.moves)
+    {
+        int count = position.generateCandidateMoves(candidates);
+        const uint16_t* found = std::find(candidates, candidates + count, move);
+        if (found == candidates + count)
+            return false;
+        putVarint(stream, static_cast<uint32_t>(found - candidates));
+        position.applyMove(move);
+    }
+    return true;
+}
+
+// Append a game
+bool chessGameArchiveWriter::append(const chessGameRecord& game, uint64_t& id)
+{
+    std::string stream;
+    return encode(game, stream) && appendEncoded(game, stream, id);
+}
+
+// Append a game whose move stream was encoded already
+bool chessGameArchiveWriter::appendEncoded(const chessGameRecord& game, const std::string& stream, uint64_t& id)
+{
+    if (!indexFile.is_open() || game.moves.size() > 0xFFFF)
+    {
+        return false;
+    }
+
+    chessGameIndexEntry entry;
+    entry.offset = moveOffset;
+    entry.startKey = game.startKey;
+    entry.startTime = game.startTime;
+    entry.endTime = game.endTime;
+    entry.byteLength = static_cast<uint32_t>(stream.size());
+    entry.plyCount = static_cast<uint16_t>(game.moves.size());
+    entry.result = game.result;
+    entry.flags = game.startFen.empty() ? 0 : GAME_FLAG_CUSTOM_START;
+
+    // Moves first: a crash in between leaves unreferenced bytes, never a dangling record
+    moveFile.write(stream.data(), stream.size());
+    moveFile.flush();
+    indexFile.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+    indexFile.flush();
+    if (!moveFile || !indexFile)
+    {
+        return false;
+    }
+    moveOffset += stream.size();
+    id = games++;
+    return true;
+}
+
+void chessGameArchiveWriter::close()
+{
+    if (indexFile.is_open())
+        indexFile.close();
+    if (moveFile.is_open())
+        moveFile.close();
+    moveOffset = 0;
+    games = 0;
+}
+
+// Constructor function
+chessGameArchiveReader::chessGameArchiveReader() : games(0)
+{
+}
+
+bool chessGameArchiveReader::open(const std::string& basePath)
+{
+    close();
+    char expected[GAME_INDEX_HEADER_SIZE];
+    makeHeader(expected);
+    if (!indexFile.openReadOnly(basePath + ".idx") || indexFile.size() < GAME_INDEX_HEADER_SIZE
+        || std::memcmp(indexFile.data(), expected, GAME_INDEX_HEADER_SIZE) != 0)
+    {
+        close();
+        return false;
+    }
+    games = (indexFile.size() - GAME_INDEX_HEADER_SIZE) / sizeof(chessGameIndexEntry);
+    // An archive of empty games has an empty move file, which cannot be mapped
+    if (!moveFile.openReadOnly(basePath + ".mov"))
+    {
+        for (uint64_t id = 0; id < games; ++id)
+        {
+            if (entry(id)->byteLength > 0)
+            {
+                close();
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void chessGameArchiveReader::close()
+{
+    indexFile.close();
+    moveFile.close();
+    games = 0;
+}
+
+// Index record of a game
+const chessGameIndexEntry* chessGameArchiveReader::entry(uint64_t id) const
+{
+    if (id >= games)
+    {
+        return NULL;
+    }
+    return reinterpret_cast<const chessGameIndexEntry*>(indexFile.data() + GAME_INDEX_HEADER_SIZE) + id;
+}
+
+// Decode a whole game
+bool chessGameArchiveReader::readGame(uint64_t id, chessGameRecord& game) const
+{
+    const chessGameIndexEntry* record = entry(id);
+    if (record == NULL || (record->byteLength > 0 && record->offset + record->byteLength > moveFile.size()))
+    {
+        return false;
+    }
+    const uint8_t* cursor = record->byteLength > 0 ? moveFile.data() + record->offset : NULL;
+    const uint8_t* end = cursor + record->byteLength;
+
+    game.clear();
+    chessPosition position;
+    if (record->flags & GAME_FLAG_CUSTOM_START)
+    {
+        uint32_t length;
+        if (!getVarint(cursor, end, length) || length > static_cast<uint64_t>(end - cursor))
+        {
+            return false;
+        }
+        if (!game.setStartFen(std::string(reinterpret_cast<const char*>(cursor), length)))
+        {
+            return false;
+        }
+        position.setFromFen(game.startFen);
+        cursor += length;
+    }
+    game.startKey = record->startKey;
+    game.result = record->result;
+    game.startTime = record->startTime;
+    game.endTime = record->endTime;
+    game.moves.reserve(record->plyCount);
+
+    uint16_t candidates[MAX_CANDIDATE_MOVES];
+    for (uint16_t ply = 0; ply < record->plyCount; ++ply)
+    {
+        uint32_t index;
+        int count = position.generateCandidateMoves(candidates);
+        if (!getVarint(cursor, end, index) || index >= static_cast<uint32_t>(count))
+        {
+            return false;
+        }
+        game.push(candidates[index]);
+        position.applyMove(candidates[index]);
+    }
+    return true;
+}
@@ -0,0 +1,88 @@
+/*
+Author: Botao Huang
+Class: ECE6122 (A)
+Last Date Modified: 10/19/2026
+Description:
+Append-only on-disk game archive
+<base>.idx holds a fixed size record per game (random access by game id),
+<base>.mov holds the move streams: one varint per ply, the index of the
+move among the candidate moves of the position (one byte for almost every ply)
+*/
+
+#ifndef CHESS_GAME_ARCHIVE_H
+#define CHESS_GAME_ARCHIVE_H
+
+#include <string>
+#include <fstream>
+#include <cstdint>
+#include "chessGameRecord.h"
+#include "ECE_MappedFile.h"
+
+// Index file identification
+const char GAME_INDEX_MAGIC[8] = { 'E', 'C', 'E', 'G', 'A', 'M', 'E', '1' };
+const uint32_t GAME_INDEX_VERSION = 2;     // 2: candidate move indices
+const uint32_t GAME_INDEX_HEADER_SIZE = 32;
+
+// Index record flags
+const uint8_t GAME_FLAG_CUSTOM_START = 1;   // Move stream starts with the FEN
+
+// One game in the index file
+struct chessGameIndexEntry
+{
+    uint64_t offset;        // Start of the move stream in the .mov file
+    uint64_t startKey;      // Zobrist key of the starting position
+    uint32_t startTime;
+    uint32_t endTime;
+    uint32_t byteLength;    // Length of the move stream
+    uint16_t plyCount;
+    uint8_t result;
+    uint8_t flags;
+};
+static_assert(sizeof(chessGameIndexEntry) == 32, "index records are 32 bytes on disk");
+
+// Appends games (one writer per archive at a time)
+class chessGameArchiveWriter
+{
+private:
+    std::ofstream indexFile;
+    std::ofstream moveFile;
+    uint64_t moveOffset;
+    uint64_t games;
+
+public:
+    chessGameArchiveWriter();
+
+    // Create the archive or continue an existing one
+    bool open(const std::string& basePath);
+    // Append a game, id receives its game id
+    bool append(const chessGameRecord& game, uint64_t& id);
+    // Same in two steps, so bulk imports can encode on worker threads
+    static bool encode(const chessGameRecord& game, std::string& stream);
+    bool appendEncoded(const chessGameRecord& game, const std::string& stream, uint64_t& id);
+    void close();
+
+    uint64_t gameCount() const { return games; }
+};
+
+// Memory mapped, random access reader
+class chessGameArchiveReader
+{
+private:
+    ECE_MappedFile indexFile;
+    ECE_MappedFile moveFile;
+    uint64_t games;
+
+public:
+    chessGameArchiveReader();
+
+    bool open(const std::string& basePath);
+    void close();
+
+    uint64_t gameCount() const { return games; }
+    // Index record of a game (no decoding), NULL when out of range
+    const chessGameIndexEntry* entry(uint64_t id) const;
+    // Decode a whole game, false when out of range or corrupt
+    bool readGame(uint64_t id, chessGameRecord& game) const;
+};
+
+#endif
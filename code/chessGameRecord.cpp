@@ -0,0 +1,106 @@
+/*
+Author: Botao Huang
+Class: ECE6122 (A)
+Last Date Modified: 10/19/2026
+Description:
+Compact game record definition file
+*/
+
+#include <ctime>
+#include "chessGameRecord.h"
+#include "chessPosition.h"
+
+// Constructor function
+chessGameRecord::chessGameRecord()
+{
+    clear();
+}
+
+// New game from the standard starting position, stamped now
+void chessGameRecord::clear()
+{
+    chessPosition start;
+    startKey = start.zobristKey();
+    startFen.clear();
+    result = GAME_RESULT_UNKNOWN;
+    startTime = static_cast<uint32_t>(std::time(NULL));
+    endTime = startTime;
+    moves.clear();
+    uciText.clear();
+    uciPlies = 0;
+}
+
+// Start from a FEN instead
+bool chessGameRecord::setStartFen(const std::string& fen)
+{
+    chessPosition start;
+    if (!start.setFromFen(fen))
+    {
+        return false;
+    }
+    clear();
+    startFen = start.toFen();
+    startKey = start.zobristKey();
+    return true;
+}
+
+// Append a packed move
+void chessGameRecord::push(uint16_t move)
+{
+    moves.push_back(move);
+}
+
+// Append a UCI move, false if malformed
+bool chessGameRecord::pushUci(const std::string& move)
+{
+    uint16_t packed = chessPosition::packUciMove(move);
+    if (packed == 0)
+    {
+        return false;
+    }
+    push(packed);
+    return true;
+}
+
+// Drop moves beyond the first plies
+void chessGameRecord::truncate(size_t plies)
+{
+    if (plies >= moves.size())
+    {
+        return;
+    }
+    while (uciPlies > plies)
+    {
+        // Each move is 4 or 5 characters plus its separator
+        uciPlies--;
+        size_t length = chessPosition::unpackMove(moves[uciPlies]).size();
+        uciText.resize(uciPlies == 0 ? 0 : uciText.size() - length - 1);
+    }
+    moves.resize(plies);
+}
+
+// Space separated UCI move list, extended with the moves added since the last call
+const std::string& chessGameRecord::uciMoves() const
+{
+    for (; uciPlies < moves.size(); ++uciPlies)
+    {
+        if (!uciText.empty())
+        {
+            uciText += ' ';
+        }
+        uciText += chessPosition::unpackMove(moves[uciPlies]);
+    }
+    return uciText;
+}
+
+// PGN style result text
+const char* chessGameRecord::resultText(uint8_t result)
+{
+    switch (result)
+    {
+    case GAME_RESULT_WHITE_WIN: return "1-0";
+    case GAME_RESULT_BLACK_WIN: return "0-1";
+    case GAME_RESULT_DRAW: return "1/2-1/2";
+    default: return "*";
+    }
+}
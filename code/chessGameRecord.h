@@ -0,0 +1,55 @@
+/*
+Author: Botao Huang
+Class: ECE6122 (A)
+Last Date Modified: 10/19/2026
+Description:
+Compact game record: 16 bit packed moves plus a small header
+The UCI move list sent to the engine is built on demand and extended in place
+*/
+
+#ifndef CHESS_GAME_RECORD_H
+#define CHESS_GAME_RECORD_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// Game result codes
+const uint8_t GAME_RESULT_UNKNOWN = 0;
+const uint8_t GAME_RESULT_WHITE_WIN = 1;
+const uint8_t GAME_RESULT_BLACK_WIN = 2;
+const uint8_t GAME_RESULT_DRAW = 3;
+
+class chessGameRecord
+{
+public:
+    uint64_t startKey;          // Zobrist key of the starting position
+    std::string startFen;       // Empty for the standard starting position
+    uint8_t result;
+    uint32_t startTime;         // Unix seconds
+    uint32_t endTime;
+    std::vector<uint16_t> moves;
+
+    chessGameRecord();
+
+    // New game from the standard starting position (or fen), stamped now
+    void clear();
+    bool setStartFen(const std::string& fen);
+
+    // Append a packed move / a UCI move (false if malformed)
+    void push(uint16_t move);
+    bool pushUci(const std::string& move);
+    // Drop moves beyond the first plies (undo)
+    void truncate(size_t plies);
+    size_t size() const { return moves.size(); }
+
+    // Space separated UCI move list ("e2e4 e7e5")
+    const std::string& uciMoves() const;
+    static const char* resultText(uint8_t result);
+
+private:
+    mutable std::string uciText;
+    mutable size_t uciPlies;    // Moves already in uciText
+};
+
+#endif
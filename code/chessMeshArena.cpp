@@ -0,0 +1,100 @@
+/*
+Author: Botao Huang
+Class: ECE6122 (A)
+Last Date Modified: 10/19/2026
+Description:
+Shared mesh arena definition file
+*/
+
+#include <cstddef>
+#include "chessMeshArena.h"
+
+// Constructor function
+chessMeshArena::chessMeshArena() : vertexArray(0), vertexBuffer(0), indexBuffer(0), vertexCount(0), indexCount(0)
+{
+}
+
+// Destructor function
+chessMeshArena::~chessMeshArena()
+{
+    deleteGLBuffers();
+}
+
+// Pack every component (sets their mesh ranges) and upload
+void chessMeshArena::build(std::vector<chessComponent>& components)
+{
+    deleteGLBuffers();
+
+    std::vector<chessVertex> vertices;
+    std::vector<unsigned short> indices;
+    for (chessComponent& component : components)
+    {
+        component.packMesh(vertices, indices);
+    }
+    vertexCount = vertices.size();
+    indexCount = indices.size();
+
+    // The vertex array records the attribute setup below
+    glGenVertexArrays(1, &vertexArray);
+    glBindVertexArray(vertexArray);
+
+    glGenBuffers(1, &vertexBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(chessVertex), vertices.data(), GL_STATIC_DRAW);
+
+    // 1rst attribute : vertices
+    glEnableVertexAttribArray(POSITION_ATTRIBUTE);
+    glVertexAttribPointer(POSITION_ATTRIBUTE, 3, GL_FLOAT, GL_FALSE, sizeof(chessVertex),
+        (void*)offsetof(chessVertex, position));
+    // 2nd attribute : UVs
+    glEnableVertexAttribArray(UV_ATTRIBUTE);
+    glVertexAttribPointer(UV_ATTRIBUTE, 2, GL_FLOAT, GL_FALSE, sizeof(chessVertex),
+        (void*)offsetof(chessVertex, uv));
+    // 3rd attribute : normals
+    glEnableVertexAttribArray(NORMAL_ATTRIBUTE);
+    glVertexAttribPointer(NORMAL_ATTRIBUTE, 3, GL_FLOAT, GL_FALSE, sizeof(chessVertex),
+        (void*)offsetof(chessVertex, normal));
+
+    // Model matrix columns and texture layer advance once per instance
+    // (pointed at the instance buffer by the draw list)
+    for (GLuint column = 0; column < 4; ++column)
+    {
+        glEnableVertexAttribArray(INSTANCE_MATRIX_ATTRIBUTE + column);
+        glVertexAttribDivisor(INSTANCE_MATRIX_ATTRIBUTE + column, 1);
+    }
+    glEnableVertexAttribArray(INSTANCE_LAYER_ATTRIBUTE);
+    glVertexAttribDivisor(INSTANCE_LAYER_ATTRIBUTE, 1);
+
+    // All indices (part of the vertex array)
+    glGenBuffers(1, &indexBuffer);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned short), indices.data(), GL_STATIC_DRAW);
+
+    glBindVertexArray(0);
+}
+
+// Bind the vertex array (attributes, index buffer, instance attributes enabled)
+void chessMeshArena::bind() const
+{
+    glBindVertexArray(vertexArray);
+}
+
+void chessMeshArena::unbind()
+{
+    glBindVertexArray(0);
+}
+
+void chessMeshArena::deleteGLBuffers()
+{
+    if (vertexArray != 0)
+    {
+        glDeleteVertexArrays(1, &vertexArray);
+        glDeleteBuffers(1, &vertexBuffer);
+        glDeleteBuffers(1, &indexBuffer);
+        vertexArray = 0;
+        vertexBuffer = 0;
+        indexBuffer = 0;
+    }
+    vertexCount = 0;
+    indexCount = 0;
+}
@@ -0,0 +1,51 @@
+/*
+Author: Botao Huang
+Class: ECE6122 (A)
+Last Date Modified: 10/19/2026
+Description:
+Shared mesh arena
+Every component's vertices and indices packed into one vertex buffer and one
+index buffer behind one vertex array; meshes are drawn by base vertex and first
+index, so a frame binds the same buffers whatever it draws
+*/
+
+#ifndef CHESS_MESH_ARENA_H
+#define CHESS_MESH_ARENA_H
+
+#include <vector>
+#include "chessComponent.h"
+
+// Vertex attribute locations (StandardShading.vertexshader)
+const GLuint POSITION_ATTRIBUTE = 0;
+const GLuint UV_ATTRIBUTE = 1;
+const GLuint NORMAL_ATTRIBUTE = 2;
+// Per-instance model matrix, one attribute per column (takes four)
+const GLuint INSTANCE_MATRIX_ATTRIBUTE = 3;
+// Per-instance texture array layer
+const GLuint INSTANCE_LAYER_ATTRIBUTE = 7;
+
+class chessMeshArena
+{
+private:
+    GLuint vertexArray;
+    GLuint vertexBuffer;        // Interleaved chessVertex data
+    GLuint indexBuffer;
+    size_t vertexCount;
+    size_t indexCount;
+
+public:
+    chessMeshArena();
+    ~chessMeshArena();
+
+    // Pack every component (sets their mesh ranges) and upload
+    void build(std::vector<chessComponent>& components);
+    // Bind the vertex array (attributes, index buffer, instance attributes enabled)
+    void bind() const;
+    static void unbind();
+    void deleteGLBuffers();
+
+    size_t getVertexCount() const { return vertexCount; }
+    size_t getIndexCount() const { return indexCount; }
+};
+
+#endif
@@ -0,0 +1,491 @@
+/*
+Author: Botao Huang
+Class: ECE6122 (A)
+Last Date Modified: 10/19/2026
+Description:
+Memory mapped PGN reader definition file
+*/
+
+#include <cstdio>
+#include <cstring>
+#include <cctype>
+#include <algorithm>
+#include <thread>
+#include <atomic>
+#include "chessPgn.h"
+#include "chessPosition.h"
+
+namespace
+{
+    bool isBlank(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+    }
+
+    // UTF-8 byte order mark some tools put at the start of the file
+    const char* skipByteOrderMark(const char* base, const char* end)
+    {
+        return (end - base >= 3 && std::memcmp(base, "\xEF\xBB\xBF", 3) == 0) ? base + 3 : base;
+    }
+
+    // Characters that end a movetext token
+    bool endsToken(char c)
+    {
+        return isBlank(c) || c == '{' || c == '}' || c == '(' || c == ')' || c == ';' || c == '[' || c == '$';
+    }
+
+    // Start of the line after p (end when there is none)
+    const char* nextLine(const char* p, const char* end)
+    {
+        const char* newline = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        return newline != NULL ? newline + 1 : end;
+    }
+
+    // A '[' at the start of a line opens a game unless the previous
+    // non blank line is a tag as well (games need not be blank line separated)
+    bool isGameStart(const char* base, const char* line)
+    {
+        while (line > base)
+        {
+            const char* previous = line - 1;
+            while (previous > base && previous[-1] != '\n')
+                previous--;
+            const char* first = (previous == base) ? skipByteOrderMark(base, line) : previous;
+            while (first < line && isBlank(*first))
+                first++;
+            if (first < line)
+                return *first != '[';
+            line = previous;
+        }
+        return true;
+    }
+
+    // First game start at or after p
+    const char* findGameStart(const char* base, const char* p, const char* end)
+    {
+        if (p > base && p[-1] != '\n')
+            p = nextLine(p, end);
+        for (; p < end; p = nextLine(p, end))
+        {
+            if (*p == '[' && isGameStart(base, p))
+                return p;
+        }
+        return end;
+    }
+
+    // Unix time of a PGN date ("2024.03.17", unknown parts as "??"), 0 when unknown
+    uint32_t parseDate(const std::string& date)
+    {
+        int year = 0, month = 0, day = 0;
+        if (std::sscanf(date.c_str(), "%d.%d.%d", &year, &month, &day) != 3 || year < 1970
+            || month < 1 || month > 12 || day < 1 || day > 31)
+        {
+            return 0;
+        }
+        // Days from the civil date (proleptic Gregorian)
+        year -= month <= 2;
+        int era = year / 400;
+        int yearOfEra = year - era * 400;
+        int dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+        int dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+        long long days = static_cast<long long>(era) * 146097 + dayOfEra - 719468;
+        return static_cast<uint32_t>(days * 86400);
+    }
+
+    // Result token, GAME_RESULT_UNKNOWN for "*", -1 when not a result
+    int resultFromText(const char* text, size_t length)
+    {
+        if (length == 3 && std::memcmp(text, "1-0", 3) == 0)
+            return GAME_RESULT_WHITE_WIN;
+        if (length == 3 && std::memcmp(text, "0-1", 3) == 0)
+            return GAME_RESULT_BLACK_WIN;
+        if (length == 7 && std::memcmp(text, "1/2-1/2", 7) == 0)
+            return GAME_RESULT_DRAW;
+        if (length == 1 && text[0] == '*')
+            return GAME_RESULT_UNKNOWN;
+        return -1;
+    }
+
+    // Parses the games of one chunk
+    class PgnParser
+    {
+    public:
+        // firstLine: line number of begin
+        PgnParser(const char* base, const char* begin, const char* end, uint64_t firstLine)
+            : base(base), p(begin), end(end), tagCount(0), countedTo(begin), countedLines(firstLine)
+        {
+        }
+
+        // Next game; false at the end of the chunk. ok is false for a malformed game
+        // (error filled in, the parser has already moved on to the next game)
+        bool next(chessPgnGame& game, bool& ok, chessPgnError& error)
+        {
+            skipBetweenGames();
+            if (p >= end)
+                return false;
+
+            const char* start = p;
+            game.offset = static_cast<uint64_t>(start - base);
+            game.record.clear();
+            game.record.startTime = 0;
+            game.record.endTime = 0;
+            position.setStartPosition();
+            tagCount = 0;
+            message.clear();
+
+            ok = readTags(game) && readMovetext(game);
+            game.tags.resize(tagCount);
+            if (!ok)
+            {
+                error.offset = game.offset;
+                error.line = lineOf(errorAt);
+                error.message = message;
+                p = findGameStart(base, std::max(errorAt, start + 1), end);
+            }
+            return true;
+        }
+
+    private:
+        const char* base;
+        const char* p;
+        const char* end;
+        size_t tagCount;
+        chessPosition position;
+        std::string message;
+        const char* errorAt;
+        // Line counting resumes where the previous error left off
+        const char* countedTo;
+        uint64_t countedLines;
+
+        uint64_t lineOf(const char* at)
+        {
+            countedLines += static_cast<uint64_t>(std::count(countedTo, at, '\n'));
+            countedTo = at;
+            return countedLines;
+        }
+
+        bool fail(const char* at, const std::string& text)
+        {
+            errorAt = std::min(at, end);
+            message = text;
+            return false;
+        }
+
+        // Blank lines and "%" escape lines
+        void skipBetweenGames()
+        {
+            if (p == base)
+                p = skipByteOrderMark(base, end);
+            while (p < end)
+            {
+                if (isBlank(*p))
+                    p++;
+                else if (*p == '%' && (p == base || p[-1] == '\n'))
+                    p = nextLine(p, end);
+                else
+                    break;
+            }
+        }
+
+        // [Name "Value"] lines; reuses the game's tag strings
+        bool readTags(chessPgnGame& game)
+        {
+            while (p < end && *p == '[')
+            {
+                const char* tagStart = p++;
+                while (p < end && (*p == ' ' || *p == '\t'))
+                    p++;
+                const char* name = p;
+                while (p < end && (std::isalnum(static_cast<unsigned char>(*p)) || *p == '_'))
+                    p++;
+                size_t nameLength = p - name;
+                while (p < end && (*p == ' ' || *p == '\t'))
+                    p++;
+                if (nameLength == 0 || p >= end || *p != '"')
+                    return fail(tagStart, "malformed tag");
+
+                if (tagCount == game.tags.size())
+                    game.tags.emplace_back();
+                std::pair<std::string, std::string>& tag = game.tags[tagCount++];
+                tag.first.assign(name, nameLength);
+                tag.second.clear();
+                for (p++; p < end && *p != '"' && *p != '\n'; p++)
+                {
+                    if (*p == '\\' && p + 1 < end && (p[1] == '"' || p[1] == '\\'))
+                        p++;
+                    tag.second += *p;
+                }
+                if (p >= end || *p != '"')
+                    return fail(tagStart, "unterminated tag value");
+                p++;
+                while (p < end && (*p == ' ' || *p == '\t'))
+                    p++;
+                if (p >= end || *p != ']')
+                    return fail(tagStart, "malformed tag");
+                p++;
+
+                if (!applyTag(tag.first, tag.second, game))
+                    return fail(tagStart, "bad " + tag.first + " tag: " + tag.second);
+                while (p < end && isBlank(*p))
+                    p++;
+            }
+            return true;
+        }
+
+        // Tags that change how the game is read
+        bool applyTag(const std::string& name, const std::string& value, chessPgnGame& game)
+        {
+            if (name == "FEN")
+            {
+                // Keeps what the earlier tags set
+                chessGameRecord header = game.record;
+                if (!game.record.setStartFen(value) || !position.setFromFen(value))
+                    return false;
+                game.record.result = header.result;
+                game.record.startTime = header.startTime;
+                game.record.endTime = header.endTime;
+            }
+            else if (name == "Date")
+            {
+                game.record.startTime = parseDate(value);
+                game.record.endTime = game.record.startTime;
+            }
+            else if (name == "Result")
+            {
+                int result = resultFromText(value.data(), value.size());
+                game.record.result = result < 0 ? GAME_RESULT_UNKNOWN : static_cast<uint8_t>(result);
+            }
+            return true;
+        }
+
+        // Moves up to the result (or the next game's tags)
+        bool readMovetext(chessPgnGame& game)
+        {
+            while (p < end)
+            {
+                char c = *p;
+                bool lineStart = p == base || p[-1] == '\n';
+                if (isBlank(c))
+                {
+                    p++;
+                }
+                else if (c == '{')
+                {
+                    const char* close = static_cast<const char*>(std::memchr(p, '}', end - p));
+                    if (close == NULL)
+                        return fail(p, "unterminated comment");
+                    p = close + 1;
+                }
+                else if (c == ';' || (c == '%' && lineStart))
+                {
+                    p = nextLine(p, end);
+                }
+                else if (c == '(')
+                {
+                    if (!skipVariation())
+                        return false;
+                }
+                else if (c == '$')
+                {
+                    for (p++; p < end && std::isdigit(static_cast<unsigned char>(*p)); p++)
+                    {
+                    }
+                }
+                else if (c == '[' && lineStart)
+                {
+                    // Next game's tags: this game ended without a result token
+                    return true;
+                }
+                else
+                {
+                    const char* token = p;
+                    while (p < end && !endsToken(*p))
+                        p++;
+                    if (p == token)
+                        return fail(p, std::string("unexpected '") + c + "'");
+                    bool finished = false;
+                    if (!readToken(token, p - token, game, finished))
+                        return false;
+                    if (finished)
+                        return true;
+                }
+            }
+            return true;
+        }
+
+        // Nested "( ... )" alternatives are skipped
+        bool skipVariation()
+        {
+            const char* open = p;
+            int depth = 0;
+            for (; p < end; p++)
+            {
+                if (*p == '{')
+                {
+                    const char* close = static_cast<const char*>(std::memchr(p, '}', end - p));
+                    if (close == NULL)
+                        break;
+                    p = close;
+                }
+                else if (*p == '(')
+                {
+                    depth++;
+                }
+                else if (*p == ')' && --depth == 0)
+                {
+                    p++;
+                    return true;
+                }
+            }
+            return fail(open, "unterminated variation");
+        }
+
+        // Move number, result or SAN move
+        bool readToken(const char* token, size_t length, chessPgnGame& game, bool& finished)
+        {
+            int result = resultFromText(token, length);
+            if (result >= 0)
+            {
+                game.record.result = static_cast<uint8_t>(result);
+                finished = true;
+                return true;
+            }
+
+            // "12." / "12..." / "12.e4" (but "0-0" is castling)
+            if (std::isdigit(static_cast<unsigned char>(token[0])) && !(length >= 3 && token[1] == '-'))
+            {
+                size_t skip = 0;
+                while (skip < length && std::isdigit(static_cast<unsigned char>(token[skip])))
+                    skip++;
+                while (skip < length && token[skip] == '.')
+                    skip++;
+                token += skip;
+                length -= skip;
+                if (length == 0)
+                    return true;
+            }
+            else if (token[0] == '.')
+            {
+                return true;
+            }
+
+            uint16_t move = position.moveFromSan(token, length);
+            if (move == 0)
+            {
+                return fail(token, "illegal move " + std::string(token, length) + " at ply "
+                    + std::to_string(game.record.size() + 1));
+            }
+            if (game.record.size() == 0xFFFF)
+                return fail(token, "game too long");
+            position.applyMove(move);
+            game.record.push(move);
+            return true;
+        }
+    };
+}
+
+// Tag value ("" when absent)
+std::string chessPgnGame::tag(const std::string& name) const
+{
+    for (const auto& entry : tags)
+    {
+        if (entry.first == name)
+            return entry.second;
+    }
+    return "";
+}
+
+// Constructor function
+chessPgnReader::chessPgnReader()
+{
+}
+
+// Map the file and find the chunk boundaries
+bool chessPgnReader::open(const std::string& path, uint64_t chunkBytes)
+{
+    close();
+    if (!file.openReadOnly(path))
+    {
+        return false;
+    }
+
+    // Chunks start at game boundaries, so each one parses on its own
+    const char* base = reinterpret_cast<const char*>(file.data());
+    const char* end = base + file.size();
+    chunkStarts.push_back(0);
+    chunkLines.push_back(1);
+    for (uint64_t target = std::max<uint64_t>(chunkBytes, 1); target < file.size(); )
+    {
+        const char* start = findGameStart(base, base + target, end);
+        if (start >= end)
+            break;
+        // Error lines count from the chunk's first line, not the file's
+        chunkLines.push_back(chunkLines.back() + static_cast<uint64_t>(
+            std::count(base + chunkStarts.back(), start, '\n')));
+        chunkStarts.push_back(static_cast<uint64_t>(start - base));
+        target = static_cast<uint64_t>(start - base) + std::max<uint64_t>(chunkBytes, 1);
+    }
+    return true;
+}
+
+void chessPgnReader::close()
+{
+    file.close();
+    chunkStarts.clear();
+    chunkLines.clear();
+}
+
+// Parse one chunk on the calling thread
+size_t chessPgnReader::parseChunk(size_t chunk, const GameCallback& onGame, const ErrorCallback& onError) const
+{
+    if (chunk >= chunkStarts.size())
+    {
+        return 0;
+    }
+    const char* base = reinterpret_cast<const char*>(file.data());
+    uint64_t chunkEnd = chunk + 1 < chunkStarts.size() ? chunkStarts[chunk + 1] : file.size();
+    PgnParser parser(base, base + chunkStarts[chunk], base + chunkEnd, chunkLines[chunk]);
+
+    chessPgnGame game;
+    chessPgnError error;
+    bool ok;
+    size_t games = 0;
+    while (parser.next(game, ok, error))
+    {
+        if (ok)
+        {
+            games++;
+            if (onGame)
+                onGame(chunk, game);
+        }
+        else if (onError)
+        {
+            onError(chunk, error);
+        }
+    }
+    return games;
+}
+
+// Parse every chunk on worker threads
+void chessPgnReader::parseAll(int threads, const GameCallback& onGame, const ErrorCallback& onError) const
+{
+    if (threads <= 0)
+    {
+        threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    }
+    std::atomic<size_t> nextChunk(0);
+    std::vector<std::thread> workers;
+    for (int i = 0; i < threads; ++i)
+    {
+        workers.emplace_back([&]() {
+            for (size_t chunk = nextChunk++; chunk < chunkStarts.size(); chunk = nextChunk++)
+            {
+                parseChunk(chunk, onGame, onError);
+            }
+        });
+    }
+    for (auto& worker : workers)
+    {
+        worker.join();
+    }
+}
@@ -0,0 +1,70 @@
+/*
+Author: Botao Huang
+Class: ECE6122 (A)
+Last Date Modified: 10/19/2026
+Description:
+Memory mapped PGN reader
+The file is split into chunks at game boundaries; chunks are parsed
+independently (one chessPosition per worker resolves the SAN movetext)
+*/
+
+#ifndef CHESS_PGN_H
+#define CHESS_PGN_H
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <functional>
+#include <cstdint>
+#include "chessGameRecord.h"
+#include "ECE_MappedFile.h"
+
+// Default chunk size handed to one worker at a time
+const uint64_t PGN_CHUNK_BYTES = 4ULL << 20;
+
+// One game read from a PGN file
+struct chessPgnGame
+{
+    uint64_t offset;    // Byte offset of the game in the file
+    std::vector<std::pair<std::string, std::string>> tags;
+    chessGameRecord record;
+
+    // Tag value ("" when absent)
+    std::string tag(const std::string& name) const;
+};
+
+// A game that could not be read (the rest of the file is still read)
+struct chessPgnError
+{
+    uint64_t offset;    // Byte offset of the game in the file
+    uint64_t line;      // Line of the problem, 1 based
+    std::string message;
+};
+
+class chessPgnReader
+{
+public:
+    // Called on the parsing thread; games and errors of one chunk arrive in file order
+    typedef std::function<void(size_t chunk, const chessPgnGame& game)> GameCallback;
+    typedef std::function<void(size_t chunk, const chessPgnError& error)> ErrorCallback;
+
+    chessPgnReader();
+
+    // Map the file and find the chunk boundaries
+    bool open(const std::string& path, uint64_t chunkBytes = PGN_CHUNK_BYTES);
+    void close();
+
+    uint64_t size() const { return file.size(); }
+    size_t chunkCount() const { return chunkStarts.size(); }
+    // Parse one chunk on the calling thread, returns the games read
+    size_t parseChunk(size_t chunk, const GameCallback& onGame, const ErrorCallback& onError) const;
+    // Parse every chunk on worker threads (0: one per hardware thread)
+    void parseAll(int threads, const GameCallback& onGame, const ErrorCallback& onError) const;
+
+private:
+    ECE_MappedFile file;
+    std::vector<uint64_t> chunkStarts;
+    std::vector<uint64_t> chunkLines;       // Line number of each chunk start
+};
+
+#endif
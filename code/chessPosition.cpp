@@ -0,0 +1,1029 @@
+/*
+Author: Botao Huang
+Class: ECE6122 (A)
+Last Date Modified: 10/19/2026
+Description:
+Compact chess position definition file
+*/
+
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include "chessPosition.h"
+
+namespace
+{
+    // Zobrist keys, generated from a fixed seed so keys are stable
+    // between runs and processes (they are stored on disk)
+    struct ZobristTable
+    {
+        uint64_t pieces[12][64];
+        uint64_t side;
+        uint64_t castling[16];
+        uint64_t epFile[8];
+
+        ZobristTable()
+        {
+            uint64_t seed = 0x9E3779B97F4A7C15ULL;
+            for (int p = 0; p < 12; ++p)
+                for (int s = 0; s < 64; ++s)
+                    pieces[p][s] = next(seed);
+            side = next(seed);
+            for (int c = 0; c < 16; ++c)
+                castling[c] = next(seed);
+            for (int f = 0; f < 8; ++f)
+                epFile[f] = next(seed);
+        }
+
+        // splitmix64 generator
+        static uint64_t next(uint64_t& state)
+        {
+            uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            return z ^ (z >> 31);
+        }
+    };
+
+    const ZobristTable& zobrist()
+    {
+        static const ZobristTable table;
+        return table;
+    }
+
+    // Index of a FEN piece letter into the Zobrist piece table
+    int pieceIndex(char piece)
+    {
+        switch (piece)
+        {
+        case 'P': return 0;  case 'N': return 1;  case 'B': return 2;
+        case 'R': return 3;  case 'Q': return 4;  case 'K': return 5;
+        case 'p': return 6;  case 'n': return 7;  case 'b': return 8;
+        case 'r': return 9;  case 'q': return 10; case 'k': return 11;
+        default: return -1;
+        }
+    }
+
+    // Promotion codes used by the packed move format
+    const char PROMOTION_PIECES[] = "\0nbrq";
+
+    // (file, rank) steps, king steps list the straight directions first
+    const int KNIGHT_STEPS[8][2] = { {1, 2}, {2, 1}, {2, -1}, {1, -2}, {-1, -2}, {-2, -1}, {-2, 1}, {-1, 2} };
+    const int KING_STEPS[8][2] = { {1, 0}, {-1, 0}, {0, 1}, {0, -1}, {1, 1}, {1, -1}, {-1, 1}, {-1, -1} };
+}
+
+// Constructor function
+chessPosition::chessPosition()
+{
+    setStartPosition();
+}
+
+// Reset to the standard starting position
+void chessPosition::setStartPosition()
+{
+    static const char backRank[] = { 'R', 'N', 'B', 'Q', 'K', 'B', 'N', 'R' };
+
+    std::memset(board, EMPTY_SQUARE, sizeof(board));
+    for (int file = 0; file < 8; ++file)
+    {
+        board[file] = backRank[file];
+        board[8 + file] = 'P';
+        board[48 + file] = 'p';
+        board[56 + file] = static_cast<char>(std::tolower(backRank[file]));
+    }
+    whiteToMove = true;
+    castling = CASTLE_WHITE_KING | CASTLE_WHITE_QUEEN | CASTLE_BLACK_KING | CASTLE_BLACK_QUEEN;
+    epSquare = NO_EP_SQUARE;
+    halfMoveClock = 0;
+    fullMoveNumber = 1;
+}
+
+// Apply a move in UCI notation
+bool chessPosition::applyUciMove(const std::string& move)
+{
+    if (move.size() == 5 && std::strchr("qrbnQRBN", move[4]) == nullptr)
+    {
+        return false;
+    }
+    uint16_t packed = packUciMove(move);
+    return packed != 0 && applyMove(packed);
+}
+
+// Apply a packed move (no legality check beyond a piece on the source square)
+bool chessPosition::applyMove(uint16_t move)
+{
+    int from = move & 0x3F;
+    int to = (move >> 6) & 0x3F;
+    int promotion = (move >> 12) & 0xF;
+    if (from == to || board[from] == EMPTY_SQUARE || promotion > 4)
+    {
+        return false;
+    }
+
+    char piece = board[from];
+    char captured = board[to];
+    bool isPawn = (piece == 'P' || piece == 'p');
+
+    // En passant capture removes the pawn behind the destination
+    if (isPawn && to == epSquare && captured == EMPTY_SQUARE && (from % 8) != (to % 8))
+    {
+        int victim = whiteToMove ? to - 8 : to + 8;
+        captured = board[victim];
+        board[victim] = EMPTY_SQUARE;
+    }
+
+    // Castling moves the rook as well (king travels two files)
+    if ((piece == 'K' || piece == 'k') && std::abs((to % 8) - (from % 8)) == 2)
+    {
+        int rankBase = from - (from % 8);
+        int rookFrom = (to % 8 == 6) ? rankBase + 7 : rankBase;
+        int rookTo = (to % 8 == 6) ? rankBase + 5 : rankBase + 3;
+        board[rookTo] = board[rookFrom];
+        board[rookFrom] = EMPTY_SQUARE;
+    }
+
+    board[to] = piece;
+    board[from] = EMPTY_SQUARE;
+
+    // Promotion
+    if (promotion > 0)
+    {
+        char promoted = PROMOTION_PIECES[promotion];
+        board[to] = whiteToMove ? static_cast<char>(std::toupper(promoted)) : promoted;
+    }
+
+    // Castling rights are lost when the king or a rook leaves (or is taken on) its home square
+    auto clearRights = [this](int square) {
+        switch (square)
+        {
+        case 4:  castling &= ~(CASTLE_WHITE_KING | CASTLE_WHITE_QUEEN); break;
+        case 0:  castling &= ~CASTLE_WHITE_QUEEN; break;
+        case 7:  castling &= ~CASTLE_WHITE_KING; break;
+        case 60: castling &= ~(CASTLE_BLACK_KING | CASTLE_BLACK_QUEEN); break;
+        case 56: castling &= ~CASTLE_BLACK_QUEEN; break;
+        case 63: castling &= ~CASTLE_BLACK_KING; break;
+        default: break;
+        }
+    };
+    clearRights(from);
+    clearRights(to);
+
+    // Double pawn push opens an en passant square
+    epSquare = (isPawn && std::abs(to - from) == 16) ? (from + to) / 2 : NO_EP_SQUARE;
+
+    halfMoveClock = (isPawn || captured != EMPTY_SQUARE) ? 0 : halfMoveClock + 1;
+    if (!whiteToMove)
+    {
+        fullMoveNumber++;
+    }
+    whiteToMove = !whiteToMove;
+    return true;
+}
+
+// Whether a piece belongs to white
+bool chessPosition::isWhitePiece(char piece)
+{
+    return piece >= 'A' && piece <= 'Z';
+}
+
+// Whether a square is attacked by the given side
+bool chessPosition::isSquareAttacked(int square, bool byWhite) const
+{
+    int file = square % 8, rank = square / 8;
+
+    // Piece on (file + df, rank + dr) if that square exists
+    auto pieceAt = [this](int f, int r) -> char {
+        return (f < 0 || f > 7 || r < 0 || r > 7) ? EMPTY_SQUARE : board[r * 8 + f];
+    };
+
+    // Pawns attack diagonally forward
+    int pawnRank = byWhite ? rank - 1 : rank + 1;
+    char pawn = byWhite ? 'P' : 'p';
+    if (pieceAt(file - 1, pawnRank) == pawn || pieceAt(file + 1, pawnRank) == pawn)
+    {
+        return true;
+    }
+
+    char knight = byWhite ? 'N' : 'n';
+    char king = byWhite ? 'K' : 'k';
+    for (int i = 0; i < 8; ++i)
+    {
+        if (pieceAt(file + KNIGHT_STEPS[i][0], rank + KNIGHT_STEPS[i][1]) == knight ||
+            pieceAt(file + KING_STEPS[i][0], rank + KING_STEPS[i][1]) == king)
+        {
+            return true;
+        }
+    }
+
+    // Sliding pieces: the first four rays are straight, the last four diagonal
+    char rook = byWhite ? 'R' : 'r';
+    char bishop = byWhite ? 'B' : 'b';
+    char queen = byWhite ? 'Q' : 'q';
+    for (int i = 0; i < 8; ++i)
+    {
+        int f = file + KING_STEPS[i][0], r = rank + KING_STEPS[i][1];
+        while (f >= 0 && f < 8 && r >= 0 && r < 8)
+        {
+            char piece = board[r * 8 + f];
+            if (piece != EMPTY_SQUARE)
+            {
+                bool straight = (KING_STEPS[i][0] == 0 || KING_STEPS[i][1] == 0);
+                if (piece == queen || (straight && piece == rook) || (!straight && piece == bishop))
+                {
+                    return true;
+                }
+                break;
+            }
+            f += KING_STEPS[i][0];
+            r += KING_STEPS[i][1];
+        }
+    }
+    return false;
+}
+
+// Whether the side to move is in check
+bool chessPosition::inCheck() const
+{
+    char king = whiteToMove ? 'K' : 'k';
+    for (int square = 0; square < 64; ++square)
+    {
+        if (board[square] == king)
+        {
+            return isSquareAttacked(square, !whiteToMove);
+        }
+    }
+    return false;
+}
+
+// Whether neither side has mating material
+bool chessPosition::insufficientMaterial() const
+{
+    int minorPieces = 0;
+    for (int square = 0; square < 64; ++square)
+    {
+        char type = static_cast<char>(std::tolower(board[square]));
+        if (type == 'p' || type == 'r' || type == 'q')
+        {
+            return false;
+        }
+        if (type == 'n' || type == 'b')
+        {
+            minorPieces++;
+        }
+    }
+    return minorPieces <= 1;
+}
+
+// Standard algebraic notation of a legal move
+std::string chessPosition::toSan(uint16_t move) const
+{
+    int from = move & 0x3F;
+    int to = (move >> 6) & 0x3F;
+    int promotion = (move >> 12) & 0xF;
+    char piece = board[from];
+    char type = static_cast<char>(std::tolower(piece));
+    std::string san;
+
+    if (type == 'k' && std::abs(to % 8 - from % 8) == 2)
+    {
+        san = (to % 8 == 6) ? "O-O" : "O-O-O";
+    }
+    else
+    {
+        bool capture = board[to] != EMPTY_SQUARE || (type == 'p' && to == epSquare);
+        if (type == 'p')
+        {
+            if (capture)
+                san += static_cast<char>('a' + from % 8);
+        }
+        else
+        {
+            san += static_cast<char>(std::toupper(type));
+            // Disambiguate between identical pieces reaching the same square
+            std::vector<uint16_t> moves;
+            generateLegalMoves(moves);
+            bool sameFile = false, sameRank = false, ambiguous = false;
+            for (uint16_t other : moves)
+            {
+                int otherFrom = other & 0x3F;
+                if (otherFrom == from || ((other >> 6) & 0x3F) != to || board[otherFrom] != piece)
+                    continue;
+                ambiguous = true;
+                sameFile = sameFile || otherFrom % 8 == from % 8;
+                sameRank = sameRank || otherFrom / 8 == from / 8;
+            }
+            if (ambiguous)
+            {
+                if (!sameFile)
+                    san += static_cast<char>('a' + from % 8);
+                else if (!sameRank)
+                    san += static_cast<char>('1' + from / 8);
+                else
+                    san += squareName(from);
+            }
+        }
+        if (capture)
+            san += 'x';
+        san += squareName(to);
+        if (promotion > 0 && promotion <= 4)
+        {
+            san += '=';
+            san += static_cast<char>(std::toupper(PROMOTION_PIECES[promotion]));
+        }
+    }
+
+    // Check and mate markers
+    chessPosition next = *this;
+    next.applyMove(move);
+    if (next.inCheck())
+    {
+        std::vector<uint16_t> replies;
+        next.generateLegalMoves(replies);
+        san += replies.empty() ? '#' : '+';
+    }
+    return san;
+}
+
+// Legal move matching a SAN (or UCI) string
+uint16_t chessPosition::moveFromSan(const std::string& san) const
+{
+    return moveFromSan(san.data(), san.size());
+}
+
+// Legal move matching a SAN (or UCI) token, no allocation
+uint16_t chessPosition::moveFromSan(const char* san, size_t length) const
+{
+    // Drop check marks and annotations (Nf3+, e4!?)
+    while (length > 0 && std::strchr("+#!?", san[length - 1]) != nullptr && san[length - 1] != '\0')
+        length--;
+    if (length < 2 || length > 7)
+        return 0;
+    char text[8];
+    std::memcpy(text, san, length);
+    text[length] = '\0';
+
+    // What the text asks for; castling and UCI name the squares directly
+    char type = 'p';
+    int fromSquare = -1, to = -1, fromFile = -1, fromRank = -1, promotion = 0;
+    bool castle = std::strcmp(text, "O-O") == 0 || std::strcmp(text, "0-0") == 0
+        || std::strcmp(text, "O-O-O") == 0 || std::strcmp(text, "0-0-0") == 0;
+    if (castle)
+    {
+        type = 'k';
+        fromSquare = whiteToMove ? 4 : 60;
+        to = fromSquare + (length == 3 ? 2 : -2);
+    }
+    else if (length >= 4 && squareFromName(text[0], text[1]) >= 0 && squareFromName(text[2], text[3]) >= 0)
+    {
+        // Some suites give moves in UCI notation
+        type = 0;
+        fromSquare = squareFromName(text[0], text[1]);
+        to = squareFromName(text[2], text[3]);
+        const char* found = length == 5 ? std::strchr(PROMOTION_PIECES + 1, std::tolower(text[4])) : nullptr;
+        if (length > 5 || (length == 5 && (found == nullptr || *found == '\0')))
+            return 0;
+        promotion = found != nullptr ? static_cast<int>(found - PROMOTION_PIECES) : 0;
+    }
+    else
+    {
+        // Promotion suffix ("=Q" or "Q")
+        const char* found = std::strchr(PROMOTION_PIECES + 1, std::tolower(text[length - 1]));
+        if (length > 2 && std::isupper(static_cast<unsigned char>(text[length - 1])) && found != nullptr && *found != '\0')
+        {
+            promotion = static_cast<int>(found - PROMOTION_PIECES);
+            length--;
+            if (text[length - 1] == '=')
+                length--;
+        }
+        if (length < 2)
+            return 0;
+
+        // Piece letter, destination square and whatever disambiguates
+        size_t start = 0;
+        if (std::strchr("NBRQK", text[0]) != nullptr)
+        {
+            type = static_cast<char>(std::tolower(text[0]));
+            start = 1;
+        }
+        to = squareFromName(text[length - 2], text[length - 1]);
+        if (to < 0)
+            return 0;
+        for (size_t i = start; i + 2 < length; ++i)
+        {
+            if (text[i] >= 'a' && text[i] <= 'h')
+                fromFile = text[i] - 'a';
+            else if (text[i] >= '1' && text[i] <= '8')
+                fromRank = text[i] - '1';
+        }
+    }
+
+    // Only the candidates that fit the text pay for the legality check
+    uint16_t candidates[MAX_CANDIDATE_MOVES];
+    int count = (fromSquare >= 0) ? generateCandidateMoves(candidates) : generateCandidateMovesTo(type, to, promotion, candidates);
+    for (int i = 0; i < count; ++i)
+    {
+        uint16_t move = candidates[i];
+        int from = move & 0x3F;
+        if (((move >> 6) & 0x3F) != to || ((move >> 12) & 0xF) != promotion
+            || (fromSquare >= 0 && from != fromSquare)
+            || (type != 0 && std::tolower(board[from]) != type)
+            || (fromFile >= 0 && from % 8 != fromFile) || (fromRank >= 0 && from / 8 != fromRank))
+            continue;
+        if (leavesKingSafe(move))
+            return move;
+    }
+    return 0;
+}
+
+// Whether a packed move is legal for the side to move
+bool chessPosition::isLegal(uint16_t move) const
+{
+    uint16_t candidates[MAX_CANDIDATE_MOVES];
+    int count = generateCandidateMoves(candidates);
+    for (int i = 0; i < count; ++i)
+    {
+        if (candidates[i] == move)
+            return leavesKingSafe(move);
+    }
+    return false;
+}
+
+// Generate every legal move of the side to move (packed)
+void chessPosition::generateLegalMoves(std::vector<uint16_t>& moves) const
+{
+    uint16_t candidates[MAX_CANDIDATE_MOVES];
+    int count = generateCandidateMoves(candidates);
+
+    // Keep the moves that do not leave our own king in check. Out of check only
+    // king moves, en passant and pinned pieces can do that; the rest need no trial move
+    bool check = inCheck();
+    uint64_t pinned = pinnedPieces();
+    int kingSquare = -1;
+    for (int square = 0; square < 64 && kingSquare < 0; ++square)
+    {
+        if (board[square] == (whiteToMove ? 'K' : 'k'))
+            kingSquare = square;
+    }
+    moves.clear();
+    for (int i = 0; i < count; ++i)
+    {
+        int from = candidates[i] & 0x3F;
+        int to = (candidates[i] >> 6) & 0x3F;
+        bool safe = !check && kingSquare >= 0 && from != kingSquare && !(pinned & (1ULL << from))
+            && !(to == epSquare && std::tolower(board[from]) == 'p');
+        if (safe || leavesKingSafe(candidates[i]))
+        {
+            moves.push_back(candidates[i]);
+        }
+    }
+}
+
+// Squares of the side to move's pieces that shield the king from an enemy slider
+uint64_t chessPosition::pinnedPieces() const
+{
+    char king = whiteToMove ? 'K' : 'k';
+    int kingSquare = -1;
+    for (int square = 0; square < 64 && kingSquare < 0; ++square)
+    {
+        if (board[square] == king)
+            kingSquare = square;
+    }
+    if (kingSquare < 0)
+    {
+        return 0;
+    }
+
+    uint64_t pinned = 0;
+    for (int i = 0; i < 8; ++i)
+    {
+        bool straight = i < 4;
+        int f = kingSquare % 8 + KING_STEPS[i][0], r = kingSquare / 8 + KING_STEPS[i][1];
+        int shield = -1;
+        while (f >= 0 && f < 8 && r >= 0 && r < 8)
+        {
+            char piece = board[r * 8 + f];
+            if (piece != EMPTY_SQUARE)
+            {
+                if (isWhitePiece(piece) == whiteToMove)
+                {
+                    if (shield >= 0)
+                        break;
+                    shield = r * 8 + f;
+                }
+                else
+                {
+                    char type = static_cast<char>(std::tolower(piece));
+                    if (shield >= 0 && (type == 'q' || type == (straight ? 'r' : 'b')))
+                        pinned |= 1ULL << shield;
+                    break;
+                }
+            }
+            f += KING_STEPS[i][0];
+            r += KING_STEPS[i][1];
+        }
+    }
+    return pinned;
+}
+
+// Whether a candidate move keeps our own king out of check
+bool chessPosition::leavesKingSafe(uint16_t move) const
+{
+    chessPosition next = *this;
+    next.applyMove(move);
+    next.whiteToMove = whiteToMove;
+    return !next.inCheck();
+}
+
+// Moves of one piece type onto a square, own king safety not checked yet
+// (walks outwards from the target like isSquareAttacked, SAN lookups only
+// need the few pieces that can get there)
+int chessPosition::generateCandidateMovesTo(char type, int to, int promotion, uint16_t* candidates) const
+{
+    if (board[to] != EMPTY_SQUARE && isWhitePiece(board[to]) == whiteToMove)
+    {
+        return 0;
+    }
+    int count = 0;
+    auto add = [candidates, &count, to, promotion](int from) {
+        candidates[count++] = static_cast<uint16_t>(from | (to << 6) | (promotion << 12));
+    };
+    char piece = whiteToMove ? static_cast<char>(std::toupper(type)) : type;
+    int file = to % 8, rank = to / 8;
+
+    if (type == 'p')
+    {
+        int forward = whiteToMove ? 1 : -1;
+        int fromRank = rank - forward;
+        if ((rank == (whiteToMove ? 7 : 0)) != (promotion != 0) || fromRank < 1 || fromRank > 6)
+        {
+            return 0;
+        }
+        if (board[to] != EMPTY_SQUARE || to == epSquare)
+        {
+            for (int df = -1; df <= 1; df += 2)
+            {
+                if (file + df >= 0 && file + df < 8 && board[fromRank * 8 + file + df] == piece)
+                    add(fromRank * 8 + file + df);
+            }
+        }
+        else
+        {
+            int from = fromRank * 8 + file;
+            if (board[from] == piece)
+                add(from);
+            else if (board[from] == EMPTY_SQUARE && rank == (whiteToMove ? 3 : 4) && board[from - 8 * forward] == piece)
+                add(from - 8 * forward);
+        }
+        return count;
+    }
+    if (promotion != 0)
+    {
+        return 0;
+    }
+
+    if (type == 'n' || type == 'k')
+    {
+        const int (*steps)[2] = (type == 'n') ? KNIGHT_STEPS : KING_STEPS;
+        for (int i = 0; i < 8; ++i)
+        {
+            int f = file + steps[i][0], r = rank + steps[i][1];
+            if (f >= 0 && f < 8 && r >= 0 && r < 8 && board[r * 8 + f] == piece)
+                add(r * 8 + f);
+        }
+        return count;
+    }
+
+    // Rook uses the straight rays, bishop the diagonal ones, queen all of them
+    int firstRay = (type == 'b') ? 4 : 0;
+    int lastRay = (type == 'r') ? 4 : 8;
+    for (int i = firstRay; i < lastRay; ++i)
+    {
+        int f = file + KING_STEPS[i][0], r = rank + KING_STEPS[i][1];
+        while (f >= 0 && f < 8 && r >= 0 && r < 8)
+        {
+            char found = board[r * 8 + f];
+            if (found != EMPTY_SQUARE)
+            {
+                if (found == piece)
+                    add(r * 8 + f);
+                break;
+            }
+            f += KING_STEPS[i][0];
+            r += KING_STEPS[i][1];
+        }
+    }
+    return count;
+}
+
+// Moves that follow the piece rules, own king safety not checked yet
+int chessPosition::generateCandidateMoves(uint16_t* candidates) const
+{
+    int count = 0;
+    auto add = [candidates, &count](int from, int to, int promotion) {
+        candidates[count++] = static_cast<uint16_t>(from | (to << 6) | (promotion << 12));
+    };
+
+    for (int from = 0; from < 64; ++from)
+    {
+        char piece = board[from];
+        if (piece == EMPTY_SQUARE || isWhitePiece(piece) != whiteToMove)
+        {
+            continue;
+        }
+        int file = from % 8, rank = from / 8;
+        char type = static_cast<char>(std::tolower(piece));
+
+        // Target square is empty or holds an enemy piece
+        auto canLand = [this](int square) {
+            return board[square] == EMPTY_SQUARE || isWhitePiece(board[square]) != whiteToMove;
+        };
+
+        if (type == 'p')
+        {
+            int forward = whiteToMove ? 1 : -1;
+            int lastRank = whiteToMove ? 7 : 0;
+            int startRank = whiteToMove ? 1 : 6;
+            int nextRank = rank + forward;
+            if (nextRank < 0 || nextRank > 7)
+            {
+                continue;
+            }
+
+            auto addPawnMove = [&](int to) {
+                if (nextRank == lastRank)
+                {
+                    for (int promotion = 4; promotion >= 1; --promotion)
+                        add(from, to, promotion);
+                }
+                else
+                {
+                    add(from, to, 0);
+                }
+            };
+
+            int ahead = nextRank * 8 + file;
+            if (board[ahead] == EMPTY_SQUARE)
+            {
+                addPawnMove(ahead);
+                int twoAhead = ahead + 8 * forward;
+                if (rank == startRank && board[twoAhead] == EMPTY_SQUARE)
+                {
+                    add(from, twoAhead, 0);
+                }
+            }
+            for (int df = -1; df <= 1; df += 2)
+            {
+                if (file + df < 0 || file + df > 7)
+                    continue;
+                int to = nextRank * 8 + file + df;
+                if ((board[to] != EMPTY_SQUARE && isWhitePiece(board[to]) != whiteToMove) || to == epSquare)
+                {
+                    addPawnMove(to);
+                }
+            }
+        }
+        else if (type == 'n' || type == 'k')
+        {
+            const int (*steps)[2] = (type == 'n') ? KNIGHT_STEPS : KING_STEPS;
+            for (int i = 0; i < 8; ++i)
+            {
+                int f = file + steps[i][0], r = rank + steps[i][1];
+                if (f >= 0 && f < 8 && r >= 0 && r < 8 && canLand(r * 8 + f))
+                {
+                    add(from, r * 8 + f, 0);
+                }
+            }
+
+            // Castling: rights intact, path empty, king not passing through check
+            if (type == 'k' && (from == 4 || from == 60))
+            {
+                bool enemy = !whiteToMove;
+                uint8_t kingSide = whiteToMove ? CASTLE_WHITE_KING : CASTLE_BLACK_KING;
+                uint8_t queenSide = whiteToMove ? CASTLE_WHITE_QUEEN : CASTLE_BLACK_QUEEN;
+                if ((castling & kingSide) && board[from + 1] == EMPTY_SQUARE && board[from + 2] == EMPTY_SQUARE &&
+                    !isSquareAttacked(from, enemy) && !isSquareAttacked(from + 1, enemy))
+                {
+                    add(from, from + 2, 0);
+                }
+                if ((castling & queenSide) && board[from - 1] == EMPTY_SQUARE && board[from - 2] == EMPTY_SQUARE &&
+                    board[from - 3] == EMPTY_SQUARE && !isSquareAttacked(from, enemy) && !isSquareAttacked(from - 1, enemy))
+                {
+                    add(from, from - 2, 0);
+                }
+            }
+        }
+        else
+        {
+            // Rook uses the straight rays, bishop the diagonal ones, queen all of them
+            int firstRay = (type == 'b') ? 4 : 0;
+            int lastRay = (type == 'r') ? 4 : 8;
+            for (int i = firstRay; i < lastRay; ++i)
+            {
+                int f = file + KING_STEPS[i][0], r = rank + KING_STEPS[i][1];
+                while (f >= 0 && f < 8 && r >= 0 && r < 8)
+                {
+                    int to = r * 8 + f;
+                    if (!canLand(to))
+                        break;
+                    add(from, to, 0);
+                    if (board[to] != EMPTY_SQUARE)
+                        break;
+                    f += KING_STEPS[i][0];
+                    r += KING_STEPS[i][1];
+                }
+            }
+        }
+    }
+    return count;
+}
+
+// Replay a space separated UCI move list from the starting position
+bool chessPosition::setFromMoveList(const std::string& moves)
+{
+    setStartPosition();
+
+    std::istringstream iss(moves);
+    std::string move;
+    while (iss >> move)
+    {
+        if (!applyUciMove(move))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Load a FEN string (move counters optional)
+bool chessPosition::setFromFen(const std::string& fen)
+{
+    std::istringstream iss(fen);
+    std::string placement, side, rights, ep;
+    if (!(iss >> placement >> side >> rights >> ep))
+    {
+        return false;
+    }
+
+    // Piece placement, rank 8 first
+    std::memset(board, EMPTY_SQUARE, sizeof(board));
+    int rank = 7, file = 0;
+    for (char c : placement)
+    {
+        if (c == '/')
+        {
+            if (file != 8 || rank == 0)
+                return false;
+            rank--;
+            file = 0;
+        }
+        else if (c >= '1' && c <= '8')
+        {
+            file += c - '0';
+            if (file > 8)
+                return false;
+        }
+        else if (pieceIndex(c) >= 0 && file < 8)
+        {
+            board[rank * 8 + file] = c;
+            file++;
+        }
+        else
+        {
+            return false;
+        }
+    }
+    if (rank != 0 || file != 8)
+    {
+        return false;
+    }
+
+    if (side != "w" && side != "b")
+    {
+        return false;
+    }
+    whiteToMove = (side == "w");
+
+    castling = 0;
+    for (char c : rights)
+    {
+        switch (c)
+        {
+        case 'K': castling |= CASTLE_WHITE_KING; break;
+        case 'Q': castling |= CASTLE_WHITE_QUEEN; break;
+        case 'k': castling |= CASTLE_BLACK_KING; break;
+        case 'q': castling |= CASTLE_BLACK_QUEEN; break;
+        case '-': break;
+        default: return false;
+        }
+    }
+
+    epSquare = (ep == "-") ? NO_EP_SQUARE : (ep.size() == 2 ? squareFromName(ep[0], ep[1]) : -2);
+    if (epSquare == -2 || (ep != "-" && epSquare < 0))
+    {
+        return false;
+    }
+
+    // Move counters are optional (EPD records omit them)
+    halfMoveClock = 0;
+    fullMoveNumber = 1;
+    int halfMoves = 0, fullMoves = 1;
+    if (iss >> halfMoves)
+    {
+        halfMoveClock = halfMoves;
+        if (iss >> fullMoves && fullMoves > 0)
+        {
+            fullMoveNumber = fullMoves;
+        }
+    }
+    return true;
+}
+
+// Full FEN string of the position
+std::string chessPosition::toFen() const
+{
+    std::string fen;
+    for (int rank = 7; rank >= 0; --rank)
+    {
+        int emptyRun = 0;
+        for (int file = 0; file < 8; ++file)
+        {
+            char piece = board[rank * 8 + file];
+            if (piece == EMPTY_SQUARE)
+            {
+                emptyRun++;
+                continue;
+            }
+            if (emptyRun > 0)
+            {
+                fen += static_cast<char>('0' + emptyRun);
+                emptyRun = 0;
+            }
+            fen += piece;
+        }
+        if (emptyRun > 0)
+        {
+            fen += static_cast<char>('0' + emptyRun);
+        }
+        if (rank > 0)
+        {
+            fen += '/';
+        }
+    }
+
+    fen += whiteToMove ? " w " : " b ";
+    if (castling == 0)
+    {
+        fen += '-';
+    }
+    else
+    {
+        if (castling & CASTLE_WHITE_KING) fen += 'K';
+        if (castling & CASTLE_WHITE_QUEEN) fen += 'Q';
+        if (castling & CASTLE_BLACK_KING) fen += 'k';
+        if (castling & CASTLE_BLACK_QUEEN) fen += 'q';
+    }
+    fen += ' ';
+    fen += (epSquare == NO_EP_SQUARE) ? std::string("-") : squareName(epSquare);
+    fen += ' ' + std::to_string(halfMoveClock) + ' ' + std::to_string(fullMoveNumber);
+    return fen;
+}
+
+// Zobrist hash of the position
+uint64_t chessPosition::zobristKey() const
+{
+    const ZobristTable& table = zobrist();
+    uint64_t key = 0;
+
+    for (int square = 0; square < 64; ++square)
+    {
+        int index = pieceIndex(board[square]);
+        if (index >= 0)
+        {
+            key ^= table.pieces[index][square];
+        }
+    }
+    if (!whiteToMove)
+    {
+        key ^= table.side;
+    }
+    key ^= table.castling[castling & 0xF];
+    // The en passant file only counts when a pawn of the side to move can
+    // really take there; otherwise the position is the same as without it
+    if (epSquare != NO_EP_SQUARE)
+    {
+        char pawn = whiteToMove ? 'P' : 'p';
+        int behind = whiteToMove ? epSquare - 8 : epSquare + 8;
+        int file = epSquare % 8;
+        for (int side = -1; side <= 1; side += 2)
+        {
+            int from = behind + side;
+            if (file + side >= 0 && file + side < 8 && board[from] == pawn
+                && leavesKingSafe(static_cast<uint16_t>(from | (epSquare << 6))))
+            {
+                key ^= table.epFile[file];
+                break;
+            }
+        }
+    }
+    return key;
+}
+
+// Same position with colours swapped and the board mirrored top to bottom
+chessPosition chessPosition::colourFlipped() const
+{
+    chessPosition flipped;
+
+    for (int square = 0; square < 64; ++square)
+    {
+        char piece = board[square ^ 56];
+        if (std::isupper(static_cast<unsigned char>(piece)))
+            flipped.board[square] = static_cast<char>(std::tolower(piece));
+        else if (std::islower(static_cast<unsigned char>(piece)))
+            flipped.board[square] = static_cast<char>(std::toupper(piece));
+        else
+            flipped.board[square] = EMPTY_SQUARE;
+    }
+    flipped.whiteToMove = !whiteToMove;
+    flipped.castling = static_cast<uint8_t>(((castling & 0x3) << 2) | ((castling >> 2) & 0x3));
+    flipped.epSquare = (epSquare == NO_EP_SQUARE) ? NO_EP_SQUARE : (epSquare ^ 56);
+    flipped.halfMoveClock = halfMoveClock;
+    flipped.fullMoveNumber = fullMoveNumber;
+    return flipped;
+}
+
+// Key shared by a position and its colour flipped twin
+uint64_t chessPosition::canonicalKey(bool& flipped) const
+{
+    flipped = !whiteToMove;
+    return flipped ? colourFlipped().zobristKey() : zobristKey();
+}
+
+// Square index from file/rank characters, -1 when off the board
+int chessPosition::squareFromName(char file, char rank)
+{
+    if (file < 'a' || file > 'h' || rank < '1' || rank > '8')
+    {
+        return -1;
+    }
+    return (rank - '1') * 8 + (file - 'a');
+}
+
+// Square name from index
+std::string chessPosition::squareName(int square)
+{
+    std::string name(2, ' ');
+    name[0] = static_cast<char>('a' + square % 8);
+    name[1] = static_cast<char>('1' + square / 8);
+    return name;
+}
+
+// Mirror a UCI move top to bottom
+std::string chessPosition::flipUciMove(const std::string& move)
+{
+    std::string flipped = move;
+    if (flipped.size() >= 4)
+    {
+        flipped[1] = static_cast<char>('1' + ('8' - move[1]));
+        flipped[3] = static_cast<char>('1' + ('8' - move[3]));
+    }
+    return flipped;
+}
+
+// Pack a UCI move into 16 bits, 0 when malformed
+uint16_t chessPosition::packUciMove(const std::string& move)
+{
+    if (move.size() != 4 && move.size() != 5)
+    {
+        return 0;
+    }
+    int from = squareFromName(move[0], move[1]);
+    int to = squareFromName(move[2], move[3]);
+    if (from < 0 || to < 0)
+    {
+        return 0;
+    }
+
+    int promotion = 0;
+    if (move.size() == 5)
+    {
+        const char* found = std::strchr(PROMOTION_PIECES + 1, std::tolower(move[4]));
+        promotion = (found != nullptr && *found != '\0') ? static_cast<int>(found - PROMOTION_PIECES) : 0;
+    }
+    return static_cast<uint16_t>(from | (to << 6) | (promotion << 12));
+}
+
+// Unpack a 16 bit move back to UCI notation
+std::string chessPosition::unpackMove(uint16_t packed)
+{
+    int from = packed & 0x3F;
+    int to = (packed >> 6) & 0x3F;
+    int promotion = (packed >> 12) & 0xF;
+
+    std::string move = squareName(from) + squareName(to);
+    if (promotion > 0 && promotion <= 4)
+    {
+        move += PROMOTION_PIECES[promotion];
+    }
+    return move;
+}
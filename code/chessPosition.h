@@ -0,0 +1,105 @@
+/*
+Author: Botao Huang
+Class: ECE6122 (A)
+Last Date Modified: 10/19/2026
+Description:
+Compact chess position (64 square array) used to key engine analysis.
+Replays UCI move lists and produces Zobrist hash keys
+*/
+
+#ifndef CHESS_POSITION_H
+#define CHESS_POSITION_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// Empty square marker in the board array
+const char EMPTY_SQUARE = 0;
+
+// Castling rights bits
+const uint8_t CASTLE_WHITE_KING = 1;
+const uint8_t CASTLE_WHITE_QUEEN = 2;
+const uint8_t CASTLE_BLACK_KING = 4;
+const uint8_t CASTLE_BLACK_QUEEN = 8;
+
+// No en passant square
+const int NO_EP_SQUARE = -1;
+
+// Room for every pseudo legal move of any position
+const int MAX_CANDIDATE_MOVES = 320;
+
+class chessPosition
+{
+public:
+    // Squares are a1 = 0 ... h8 = 63, pieces use FEN letters
+    // (upper case white, lower case black), EMPTY_SQUARE when empty
+    char board[64];
+    bool whiteToMove;
+    uint8_t castling;
+    int epSquare;
+    int halfMoveClock;
+    int fullMoveNumber;
+
+    chessPosition();
+
+    // Reset to the standard starting position
+    void setStartPosition();
+    // Apply a move in UCI notation (e2e4, e7e8q, e1g1), returns false if malformed
+    bool applyUciMove(const std::string& move);
+    // Apply a packed move (see packUciMove)
+    bool applyMove(uint16_t move);
+    // Replay a space separated UCI move list from the starting position
+    bool setFromMoveList(const std::string& moves);
+    // Load a FEN string (move counters optional), returns false if malformed
+    bool setFromFen(const std::string& fen);
+    // Full FEN string of the position
+    std::string toFen() const;
+
+    // Rules
+    // Every legal move of the side to move, packed
+    void generateLegalMoves(std::vector<uint16_t>& moves) const;
+    // Moves that follow the piece rules (own king may be left in check) in a
+    // fixed order; candidates needs MAX_CANDIDATE_MOVES entries, returns the count
+    int generateCandidateMoves(uint16_t* candidates) const;
+    // Whether a packed move is legal for the side to move
+    bool isLegal(uint16_t move) const;
+    // Whether the side to move is in check
+    bool inCheck() const;
+    // Whether a square is attacked by the given side
+    bool isSquareAttacked(int square, bool byWhite) const;
+    static bool isWhitePiece(char piece);
+    // Neither side has mating material (bare kings, or one minor piece)
+    bool insufficientMaterial() const;
+    // Standard algebraic notation of a legal move (Nf3, exd5, O-O, e8=Q+)
+    std::string toSan(uint16_t move) const;
+    // Legal move matching a SAN (or UCI) string, 0 when there is none
+    uint16_t moveFromSan(const std::string& san) const;
+    uint16_t moveFromSan(const char* san, size_t length) const;
+
+    // Zobrist hash of the position (pieces, side to move, castling, en passant)
+    uint64_t zobristKey() const;
+    // Same position with colours swapped and the board mirrored top to bottom
+    chessPosition colourFlipped() const;
+    // Key shared by a position and its colour flipped twin (always keyed
+    // with white to move), flipped reports whether the twin was used
+    uint64_t canonicalKey(bool& flipped) const;
+
+    // Square helpers
+    static int squareFromName(char file, char rank);
+    static std::string squareName(int square);
+    // Mirror a UCI move top to bottom (e7e5 <-> e2e4)
+    static std::string flipUciMove(const std::string& move);
+    // 16 bit move packing: from (6 bits), to (6 bits), promotion (4 bits)
+    static uint16_t packUciMove(const std::string& move);
+    static std::string unpackMove(uint16_t packed);
+
+private:
+    // Candidate moves of one piece type (SAN letter, lower case) onto a square
+    int generateCandidateMovesTo(char type, int to, int promotion, uint16_t* candidates) const;
+    bool leavesKingSafe(uint16_t move) const;
+    // Bit per square of our pieces pinned to our king
+    uint64_t pinnedPieces() const;
+};
+
+#endif
@@ -0,0 +1,333 @@
+/*
+Author: Botao Huang
+Class: ECE6122 (A)
+Last Date Modified: 10/19/2026
+Description:
+Position index definition file
+*/
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <algorithm>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include "chessPositionIndex.h"
+#include "chessGameArchive.h"
+#include "chessPosition.h"
+
+namespace
+{
+    // Games a worker takes from the archive at a time
+    const uint64_t GAME_BLOCK = 256;
+    // Records read or written per file call while merging
+    const size_t MERGE_BUFFER_ENTRIES = 1 << 16;
+
+    // Index file header: magic, record count, record size, fence count
+    struct PositionIndexHeader
+    {
+        char magic[8];
+        uint64_t entryCount;
+        uint32_t entrySize;
+        uint32_t fenceStride;
+        uint64_t fenceCount;
+    };
+    static_assert(sizeof(PositionIndexHeader) == POSITION_INDEX_HEADER_SIZE, "header is 32 bytes on disk");
+
+    // Sequential reader over one sorted run
+    class RunReader
+    {
+    public:
+        explicit RunReader(const std::string& path) : file(path, std::ios::binary), position(0)
+        {
+            refill();
+        }
+
+        bool done() const { return position >= buffer.size(); }
+        const chessPositionIndexEntry& current() const { return buffer[position]; }
+        void advance()
+        {
+            if (++position >= buffer.size())
+                refill();
+        }
+
+    private:
+        std::ifstream file;
+        std::vector<chessPositionIndexEntry> buffer;
+        size_t position;
+
+        void refill()
+        {
+            buffer.resize(MERGE_BUFFER_ENTRIES);
+            file.read(reinterpret_cast<char*>(buffer.data()), buffer.size() * sizeof(chessPositionIndexEntry));
+            buffer.resize(static_cast<size_t>(file.gcount()) / sizeof(chessPositionIndexEntry));
+            position = 0;
+        }
+    };
+}
+
+// Score for white in percent
+double chessMoveStats::whiteScore() const
+{
+    uint32_t finished = whiteWins + draws + blackWins;
+    return finished == 0 ? 0.0 : 100.0 * (whiteWins + 0.5 * draws) / finished;
+}
+
+// Constructor function
+chessPositionIndexBuilder::chessPositionIndexBuilder()
+    : threads(0), runBytes(256ULL << 20), maxPly(POSITION_MAX_PLY), entries(0), runs(0)
+{
+}
+
+// Index every game of the archive
+bool chessPositionIndexBuilder::build(const std::string& archiveBase, const std::string& indexPath)
+{
+    entries = 0;
+    runs = 0;
+    chessGameArchiveReader archive;
+    if (!archive.open(archiveBase))
+    {
+        return false;
+    }
+    int threadCount = threads > 0 ? threads : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    size_t runEntries = std::max<size_t>(1 << 16, static_cast<size_t>(runBytes / sizeof(chessPositionIndexEntry) / threadCount));
+    uint32_t plyLimit = std::min(maxPly, POSITION_MAX_PLY);
+
+    // Each worker replays blocks of games and spills sorted runs
+    std::atomic<uint64_t> nextGame(0);
+    std::atomic<bool> failed(false);
+    std::mutex runMutex;
+    std::vector<std::string> runPaths;
+    uint64_t total = 0;
+
+    auto writeRun = [&](std::vector<chessPositionIndexEntry>& buffer) {
+        if (buffer.empty())
+            return;
+        std::sort(buffer.begin(), buffer.end());
+        std::string path;
+        {
+            std::lock_guard<std::mutex> lock(runMutex);
+            path = indexPath + ".run" + std::to_string(runPaths.size());
+            runPaths.push_back(path);
+            total += buffer.size();
+        }
+        std::ofstream run(path, std::ios::binary | std::ios::trunc);
+        run.write(reinterpret_cast<const char*>(buffer.data()), buffer.size() * sizeof(chessPositionIndexEntry));
+        if (!run)
+            failed = true;
+        buffer.clear();
+    };
+
+    std::vector<std::thread> workers;
+    for (int i = 0; i < threadCount; ++i)
+    {
+        workers.emplace_back([&]() {
+            std::vector<chessPositionIndexEntry> buffer;
+            buffer.reserve(runEntries);
+            chessGameRecord game;
+            chessPosition position;
+            for (uint64_t block = nextGame.fetch_add(GAME_BLOCK); block < archive.gameCount() && !failed;
+                block = nextGame.fetch_add(GAME_BLOCK))
+            {
+                uint64_t blockEnd = std::min(block + GAME_BLOCK, archive.gameCount());
+                for (uint64_t id = block; id < blockEnd; ++id)
+                {
+                    if (!archive.readGame(id, game))
+                        continue;
+                    if (game.startFen.empty())
+                        position.setStartPosition();
+                    else
+                        position.setFromFen(game.startFen);
+
+                    // One record per position, including the final one
+                    for (size_t ply = 0; ply <= game.size() && ply <= plyLimit; ++ply)
+                    {
+                        chessPositionIndexEntry entry;
+                        entry.key = position.zobristKey();
+                        entry.gameId = static_cast<uint32_t>(id);
+                        entry.nextMove = ply < game.size() ? game.moves[ply] : 0;
+                        entry.plyResult = static_cast<uint16_t>(ply << 2 | (game.result & 3));
+                        buffer.push_back(entry);
+                        if (buffer.size() == runEntries)
+                            writeRun(buffer);
+                        if (ply < game.size())
+                            position.applyMove(game.moves[ply]);
+                    }
+                }
+            }
+            writeRun(buffer);
+        });
+    }
+    for (auto& worker : workers)
+    {
+        worker.join();
+    }
+
+    // Merge the runs into the table, keeping every fence stride-th key
+    PositionIndexHeader header;
+    std::memcpy(header.magic, POSITION_INDEX_MAGIC, sizeof(header.magic));
+    header.entryCount = total;
+    header.entrySize = sizeof(chessPositionIndexEntry);
+    header.fenceStride = static_cast<uint32_t>(POSITION_FENCE_STRIDE);
+    header.fenceCount = (total + POSITION_FENCE_STRIDE - 1) / POSITION_FENCE_STRIDE;
+
+    std::ofstream output(indexPath, std::ios::binary | std::ios::trunc);
+    output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    std::vector<std::unique_ptr<RunReader>> readers;
+    typedef std::pair<chessPositionIndexEntry, size_t> HeapItem;
+    auto later = [](const HeapItem& a, const HeapItem& b) { return b.first < a.first; };
+    std::priority_queue<HeapItem, std::vector<HeapItem>, decltype(later)> heap(later);
+    for (size_t i = 0; i < runPaths.size() && !failed; ++i)
+    {
+        readers.emplace_back(new RunReader(runPaths[i]));
+        if (!readers.back()->done())
+            heap.push(HeapItem(readers.back()->current(), i));
+    }
+
+    std::vector<chessPositionIndexEntry> outBuffer;
+    std::vector<uint64_t> fence;
+    outBuffer.reserve(MERGE_BUFFER_ENTRIES);
+    fence.reserve(static_cast<size_t>(header.fenceCount));
+    uint64_t written = 0;
+    while (!heap.empty())
+    {
+        HeapItem item = heap.top();
+        heap.pop();
+        if (written++ % POSITION_FENCE_STRIDE == 0)
+            fence.push_back(item.first.key);
+        outBuffer.push_back(item.first);
+        if (outBuffer.size() == MERGE_BUFFER_ENTRIES)
+        {
+            output.write(reinterpret_cast<const char*>(outBuffer.data()), outBuffer.size() * sizeof(chessPositionIndexEntry));
+            outBuffer.clear();
+        }
+        RunReader& reader = *readers[item.second];
+        reader.advance();
+        if (!reader.done())
+            heap.push(HeapItem(reader.current(), item.second));
+    }
+    output.write(reinterpret_cast<const char*>(outBuffer.data()), outBuffer.size() * sizeof(chessPositionIndexEntry));
+    output.write(reinterpret_cast<const char*>(fence.data()), fence.size() * sizeof(uint64_t));
+    output.close();
+
+    readers.clear();
+    for (const auto& path : runPaths)
+    {
+        std::remove(path.c_str());
+    }
+    if (failed || !output || written != total)
+    {
+        std::remove(indexPath.c_str());
+        return false;
+    }
+    entries = total;
+    runs = runPaths.size();
+    return true;
+}
+
+// Constructor function
+chessPositionIndex::chessPositionIndex() : table(NULL), entries(0)
+{
+}
+
+bool chessPositionIndex::open(const std::string& path)
+{
+    close();
+    if (!file.openReadOnly(path) || file.size() < POSITION_INDEX_HEADER_SIZE)
+    {
+        close();
+        return false;
+    }
+    PositionIndexHeader header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    uint64_t expectedSize = POSITION_INDEX_HEADER_SIZE + header.entryCount * sizeof(chessPositionIndexEntry)
+        + header.fenceCount * sizeof(uint64_t);
+    if (std::memcmp(header.magic, POSITION_INDEX_MAGIC, sizeof(header.magic)) != 0
+        || header.entrySize != sizeof(chessPositionIndexEntry) || header.fenceStride != POSITION_FENCE_STRIDE
+        || file.size() != expectedSize)
+    {
+        close();
+        return false;
+    }
+
+    // The fence is small and read on every lookup: keep a copy in memory
+    table = reinterpret_cast<const chessPositionIndexEntry*>(file.data() + POSITION_INDEX_HEADER_SIZE);
+    entries = header.entryCount;
+    const uint64_t* fenceKeys = reinterpret_cast<const uint64_t*>(table + entries);
+    fence.assign(fenceKeys, fenceKeys + header.fenceCount);
+    return true;
+}
+
+void chessPositionIndex::close()
+{
+    file.close();
+    table = NULL;
+    entries = 0;
+    fence.clear();
+}
+
+// Records of one position
+bool chessPositionIndex::find(uint64_t key, const chessPositionIndexEntry*& first, const chessPositionIndexEntry*& last) const
+{
+    first = last = table;
+    if (entries == 0)
+    {
+        return false;
+    }
+
+    // The fence narrows the search to the blocks that can hold the key
+    size_t lowBlock = std::lower_bound(fence.begin(), fence.end(), key) - fence.begin();
+    size_t highBlock = std::upper_bound(fence.begin(), fence.end(), key) - fence.begin();
+    const chessPositionIndexEntry* begin = table + (lowBlock == 0 ? 0 : (lowBlock - 1) * POSITION_FENCE_STRIDE);
+    const chessPositionIndexEntry* end = table + std::min<uint64_t>(entries, highBlock * POSITION_FENCE_STRIDE);
+
+    first = std::lower_bound(begin, end, key,
+        [](const chessPositionIndexEntry& entry, uint64_t value) { return entry.key < value; });
+    last = std::upper_bound(first, end, key,
+        [](uint64_t value, const chessPositionIndexEntry& entry) { return value < entry.key; });
+    return first != last;
+}
+
+// Continuations of a range, most played first
+void chessPositionIndex::moveStats(const chessPositionIndexEntry* first, const chessPositionIndexEntry* last,
+    std::vector<chessMoveStats>& stats, uint64_t& games)
+{
+    stats.clear();
+    games = 0;
+    uint32_t previousGame = 0;
+    std::vector<uint16_t> gameMoves;    // Moves already counted for the current game
+    for (const chessPositionIndexEntry* entry = first; entry != last; ++entry)
+    {
+        // Records are sorted by game id within a key
+        if (entry == first || entry->gameId != previousGame)
+        {
+            games++;
+            gameMoves.clear();
+        }
+        previousGame = entry->gameId;
+        if (entry->nextMove == 0)
+            continue;
+        // A game that comes back to the position counts once per move
+        if (std::find(gameMoves.begin(), gameMoves.end(), entry->nextMove) != gameMoves.end())
+            continue;
+        gameMoves.push_back(entry->nextMove);
+
+        auto found = std::find_if(stats.begin(), stats.end(),
+            [entry](const chessMoveStats& move) { return move.move == entry->nextMove; });
+        if (found == stats.end())
+        {
+            chessMoveStats move = { entry->nextMove, 0, 0, 0, 0 };
+            found = stats.insert(stats.end(), move);
+        }
+        found->games++;
+        found->whiteWins += entry->result() == GAME_RESULT_WHITE_WIN;
+        found->draws += entry->result() == GAME_RESULT_DRAW;
+        found->blackWins += entry->result() == GAME_RESULT_BLACK_WIN;
+    }
+    std::sort(stats.begin(), stats.end(),
+        [](const chessMoveStats& a, const chessMoveStats& b) { return a.games > b.games; });
+}
@@ -0,0 +1,108 @@
+/*
+Author: Botao Huang
+Class: ECE6122 (A)
+Last Date Modified: 10/19/2026
+Description:
+Position index over the game archive
+A sorted table of (position key, game id, ply) records answers "which games
+reached this position" with a binary search; a sparse fence of every
+POSITION_FENCE_STRIDE-th key is kept in memory so a lookup touches a few pages
+*/
+
+#ifndef CHESS_POSITION_INDEX_H
+#define CHESS_POSITION_INDEX_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "ECE_MappedFile.h"
+
+// Index file identification (2: keys hash en passant only when a capture is possible)
+const char POSITION_INDEX_MAGIC[8] = { 'E', 'C', 'E', 'P', 'O', 'S', 'I', '2' };
+const uint32_t POSITION_INDEX_HEADER_SIZE = 32;
+// Records between two fence keys
+const uint64_t POSITION_FENCE_STRIDE = 256;
+// Plies past this are not indexed (the ply shares 16 bits with the result)
+const uint32_t POSITION_MAX_PLY = 0x3FFF;
+
+// One position of one game, 16 bytes on disk
+struct chessPositionIndexEntry
+{
+    uint64_t key;           // Zobrist key of the position
+    uint32_t gameId;        // Game id in the archive
+    uint16_t nextMove;      // Packed move played from here, 0 at the end of the game
+    uint16_t plyResult;     // Ply << 2 | game result
+
+    uint32_t ply() const { return plyResult >> 2; }
+    uint8_t result() const { return static_cast<uint8_t>(plyResult & 3); }
+    bool operator<(const chessPositionIndexEntry& other) const
+    {
+        if (key != other.key)
+            return key < other.key;
+        if (gameId != other.gameId)
+            return gameId < other.gameId;
+        return plyResult < other.plyResult;
+    }
+};
+static_assert(sizeof(chessPositionIndexEntry) == 16, "index records are 16 bytes on disk");
+
+// Games that continued with one move, from white's point of view
+struct chessMoveStats
+{
+    uint16_t move;
+    uint32_t games;
+    uint32_t whiteWins;
+    uint32_t draws;
+    uint32_t blackWins;
+
+    // Score for white in percent (unfinished games left out)
+    double whiteScore() const;
+};
+
+// Builds the index: replay in parallel, sorted runs, k-way merge
+class chessPositionIndexBuilder
+{
+public:
+    chessPositionIndexBuilder();
+
+    int threads;            // 0: one per hardware thread
+    uint64_t runBytes;      // Memory for sorted runs, shared by the threads
+    uint32_t maxPly;        // Deepest ply indexed
+
+    // Index every game of the archive into indexPath (runs go next to it)
+    bool build(const std::string& archiveBase, const std::string& indexPath);
+
+    uint64_t entryCount() const { return entries; }
+    size_t runCount() const { return runs; }
+
+private:
+    uint64_t entries;
+    size_t runs;
+};
+
+// Memory mapped, read only index
+class chessPositionIndex
+{
+public:
+    chessPositionIndex();
+
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const { return file.isOpen(); }
+    uint64_t size() const { return entries; }
+
+    // Records of one position as a [first, last) range inside the mapping
+    bool find(uint64_t key, const chessPositionIndexEntry*& first, const chessPositionIndexEntry*& last) const;
+    // Continuations of a range, most played first; games (overall and per move)
+    // counts distinct games
+    static void moveStats(const chessPositionIndexEntry* first, const chessPositionIndexEntry* last,
+        std::vector<chessMoveStats>& stats, uint64_t& games);
+
+private:
+    ECE_MappedFile file;
+    const chessPositionIndexEntry* table;
+    uint64_t entries;
+    std::vector<uint64_t> fence;
+};
+
+#endif
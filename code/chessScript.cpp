@@ -0,0 +1,189 @@
+/*
+Author: Botao Huang
+Class: ECE6122 (A)
+Last Date Modified: 10/19/2026
+Description:
+Command scripts for the headless mode definition file
+*/
+
+#include <cstring>
+#include <cstdlib>
+#include <climits>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <cerrno>
+#include <unistd.h>
+#endif
+#include "chessScript.h"
+
+namespace
+{
+    inline bool isBlank(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\0';
+    }
+
+    // One read on the file's descriptor: whatever is there now, so a pipe hands
+    // each line over as soon as it is written. 0 at the end, -1 on an error
+    long readSome(FILE* file, char* buffer, size_t capacity)
+    {
+#ifdef _WIN32
+        return _read(_fileno(file), buffer, static_cast<unsigned int>(capacity));
+#else
+        ssize_t got;
+        do
+        {
+            got = read(fileno(file), buffer, capacity);
+        } while (got < 0 && errno == EINTR);
+        return static_cast<long>(got);
+#endif
+    }
+}
+
+// Constructor function
+chessCommandTokenizer::chessCommandTokenizer() : tokenCount(0)
+{
+}
+
+// Split a line in place (separators become '\0'), returns the word count
+int chessCommandTokenizer::split(char* line, size_t length)
+{
+    tokenCount = 0;
+    size_t i = 0;
+    while (i < length && tokenCount < COMMAND_MAX_TOKENS)
+    {
+        while (i < length && isBlank(line[i]))
+            line[i++] = '\0';
+        if (i == length)
+            break;
+        size_t start = i;
+        while (i < length && !isBlank(line[i]))
+            ++i;
+        tokens[tokenCount] = line + start;
+        lengths[tokenCount] = i - start;
+        tokenCount++;
+        // The last word may end the buffer: it is terminated by the caller
+        if (i < length)
+            line[i++] = '\0';
+    }
+    return tokenCount;
+}
+
+bool chessCommandTokenizer::is(int i, const char* word) const
+{
+    return i < tokenCount && std::strlen(word) == lengths[i] && std::memcmp(tokens[i], word, lengths[i]) == 0;
+}
+
+bool chessCommandTokenizer::toFloat(int i, float& value) const
+{
+    if (i >= tokenCount)
+        return false;
+    char* stop;
+    value = std::strtof(tokens[i], &stop);
+    return stop == tokens[i] + lengths[i];
+}
+
+bool chessCommandTokenizer::toInt(int i, int& value) const
+{
+    if (i >= tokenCount)
+        return false;
+    char* stop;
+    long parsed = std::strtol(tokens[i], &stop, 10);
+    if (stop != tokens[i] + lengths[i] || parsed < INT_MIN || parsed > INT_MAX)
+        return false;
+    value = static_cast<int>(parsed);
+    return true;
+}
+
+// Constructor function
+chessScriptReader::chessScriptReader()
+    : file(NULL), ownsFile(false), buffer(NULL), begin(0), end(0), endOfFile(false), lines(0)
+{
+}
+
+chessScriptReader::~chessScriptReader()
+{
+    close();
+}
+
+bool chessScriptReader::open(const std::string& path)
+{
+    close();
+    if (path == "-")
+    {
+        file = stdin;
+    }
+    else
+    {
+        file = std::fopen(path.c_str(), "rb");
+        ownsFile = true;
+    }
+    if (file == NULL)
+    {
+        ownsFile = false;
+        return false;
+    }
+    // One spare byte so the last line can always be terminated
+    buffer = new char[SCRIPT_BUFFER_BYTES + 1];
+    return true;
+}
+
+void chessScriptReader::close()
+{
+    if (ownsFile && file != NULL)
+    {
+        std::fclose(file);
+    }
+    file = NULL;
+    ownsFile = false;
+    delete[] buffer;
+    buffer = NULL;
+    begin = end = 0;
+    endOfFile = false;
+    lines = 0;
+}
+
+// Next line without its end of line
+bool chessScriptReader::nextLine(char*& line, size_t& length)
+{
+    if (file == NULL)
+    {
+        return false;
+    }
+    while (true)
+    {
+        char* newline = static_cast<char*>(std::memchr(buffer + begin, '\n', end - begin));
+        if (newline != NULL || endOfFile || (begin == 0 && end == SCRIPT_BUFFER_BYTES))
+        {
+            if (begin == end && endOfFile)
+            {
+                return false;
+            }
+            // A line longer than the buffer comes back in pieces
+            size_t lineEnd = newline != NULL ? static_cast<size_t>(newline - buffer) : end;
+            line = buffer + begin;
+            length = lineEnd - begin;
+            if (length > 0 && line[length - 1] == '\r')
+                length--;
+            line[length] = '\0';
+            begin = newline != NULL ? lineEnd + 1 : lineEnd;
+            lines++;
+            return true;
+        }
+
+        // Move the partial line to the front and read more behind it
+        std::memmove(buffer, buffer + begin, end - begin);
+        end -= begin;
+        begin = 0;
+        long got = readSome(file, buffer + end, SCRIPT_BUFFER_BYTES - end);
+        if (got <= 0)
+        {
+            endOfFile = true;
+        }
+        else
+        {
+            end += static_cast<size_t>(got);
+        }
+    }
+}
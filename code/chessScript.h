@@ -0,0 +1,77 @@
+/*
+Author: Botao Huang
+Class: ECE6122 (A)
+Last Date Modified: 10/19/2026
+Description:
+Command scripts for the headless mode
+A line reader over a file or pipe and a tokenizer that splits command lines
+in place, so neither allocates per command
+*/
+
+#ifndef CHESS_SCRIPT_H
+#define CHESS_SCRIPT_H
+
+#include <cstdio>
+#include <cstddef>
+#include <string>
+
+// Words kept per command line (the rest of a longer line is ignored)
+const int COMMAND_MAX_TOKENS = 8;
+// Read buffer of the script reader (filled by short reads, not waited full);
+// longer lines come back in pieces
+const size_t SCRIPT_BUFFER_BYTES = 1 << 16;
+
+// Splits one command line into blank separated words
+class chessCommandTokenizer
+{
+public:
+    chessCommandTokenizer();
+
+    // Split a line in place (separators become '\0'), returns the word count
+    int split(char* line, size_t length);
+    int count() const { return tokenCount; }
+
+    // Word i, "" past the last one
+    const char* token(int i) const { return i < tokenCount ? tokens[i] : ""; }
+    size_t length(int i) const { return i < tokenCount ? lengths[i] : 0; }
+    bool is(int i, const char* word) const;
+    // Numeric words; false when missing or not entirely a number
+    bool toFloat(int i, float& value) const;
+    bool toInt(int i, int& value) const;
+
+private:
+    const char* tokens[COMMAND_MAX_TOKENS];
+    size_t lengths[COMMAND_MAX_TOKENS];
+    int tokenCount;
+};
+
+// Reads a command script line by line ("-" reads standard input)
+class chessScriptReader
+{
+public:
+    chessScriptReader();
+    ~chessScriptReader();
+
+    bool open(const std::string& path);
+    void close();
+
+    // Next line without its end of line; the text stays valid until the next
+    // call. Returns false at the end of the input
+    bool nextLine(char*& line, size_t& length);
+    // Lines returned so far
+    size_t lineNumber() const { return lines; }
+
+private:
+    FILE* file;
+    bool ownsFile;
+    char* buffer;
+    size_t begin;
+    size_t end;
+    bool endOfFile;
+    size_t lines;
+
+    chessScriptReader(const chessScriptReader&);
+    chessScriptReader& operator=(const chessScriptReader&);
+};
+
+#endif
@@ -0,0 +1,627 @@
+/*
+Author: Botao Huang
+Class: ECE6122 (A)
+Last Date Modified: 10/19/2026
+Description:
+Game session definition file (rules and piece placement moved from the
+main program so several games can run side by side)
+*/
+
+#include <cstdlib>
+#include "chessSession.h"
+#include "chessPosition.h"
+
+namespace {
+    // Report why a move was rejected
+    void reject(std::ostream* out, const char* reason) {
+        if (out != NULL) {
+            *out << reason;
+        }
+    }
+
+    // Camera and light angles share the same limits
+    bool validateAngles(float theta, float phi) {
+        if (theta >= 10 && theta <= 80)
+        {
+            if (phi >= 0 && phi <= 360)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
+// Constructor function
+chessSession::chessSession(uint32_t id) : id(id), feed(NULL) {
+    reset();
+}
+
+// Starting position, default camera and light
+void chessSession::reset() {
+    boardState.clear();
+    models.clear();
+    gameRecord.clear();
+    cTheta = 1.0f;
+    cPhi = 0.0f;
+    cRadius = 40.0f;
+    lTheta = 0.0f;
+    lPhi = 0.0f;
+    lRadius = 15.0f;
+    lightPower = 200.0f;
+    playerCapturedIndex = 0;
+    enemyCapturedIndex = 0;
+    savedBoardState.clear();
+    savedModels.clear();
+    savedPlies = 0;
+    savedPlayerCaptured = 0;
+    savedEnemyCaptured = 0;
+
+    // Add chessboard to the model map
+    models.push_back({ "12951_Stone_Chess_Board",
+                          {1, 0, 0.f, {1, 0, 0}, glm::vec3(CBSCALE), {0.f, 0.f, PHEIGHT}} });
+
+    // Initialize first player's back rank
+    std::vector<std::pair<std::string, std::string>> backRankFirstPlayer = {
+        {"a1", "TORRE3"}, {"b1", "Object3"}, {"c1", "ALFIERE3"}, {"d1", "REGINA2"},
+        {"e1", "RE2"}, {"f1", "ALFIERE3"}, {"g1", "Object3"}, {"h1", "TORRE3"}
+    };
+
+    for (const auto& pair : backRankFirstPlayer) {
+        const std::string& position = pair.first;
+        const std::string& id = pair.second;
+
+        boardState[position] = id;
+        tPosition location = { 1, 0, 90.f, {1, 0, 0}, glm::vec3(CPSCALE),
+                             {-3.5f * CHESS_BOX_SIZE + (position[0] - 'a') * CHESS_BOX_SIZE,
+                              -3.5f * CHESS_BOX_SIZE,
+                              PHEIGHT} };
+        
+        struct ModelData newEle;
+        newEle.id = id;
+        newEle.location = position;
+        newEle.position = location;
+
+        models.push_back(newEle);
+    }
+
+    // Initialize first player's pawns
+    for (char file = 'a'; file <= 'h'; ++file) {
+        std::string position = std::string(1, file) + "2";
+        std::string pawnID = "PEDONE13";
+        boardState[position] = pawnID;
+
+        tPosition location =   {1, 0, 90.f, {1, 0, 0}, glm::vec3(CPSCALE),
+                               {-3.5f * CHESS_BOX_SIZE + (file - 'a') * CHESS_BOX_SIZE,
+                                -2.5f * CHESS_BOX_SIZE,
+                                PHEIGHT}};
+
+        struct ModelData newEle;
+        newEle.id = pawnID;
+        newEle.location = position;
+        newEle.position = location;
+
+        models.push_back(newEle);
+    }
+
+    // Initialize second player's back rank
+    std::vector<std::pair<std::string, std::string>> backRankSecondPlayer = {
+        {"a8", "TORRE02"}, {"b8", "Object02"}, {"c8", "ALFIERE02"}, {"d8", "REGINA01"},
+        {"e8", "RE01"}, {"f8", "ALFIERE02"}, {"g8", "Object02"}, {"h8", "TORRE02"}
+    };
+
+    for (const auto& pair : backRankSecondPlayer) {
+        const std::string& position = pair.first;
+        const std::string& id = pair.second;
+
+        boardState[position] = id;
+        tPosition location = { 1, 0, 90.f, {1, 0, 0}, glm::vec3(CPSCALE),
+                             {-3.5f * CHESS_BOX_SIZE + (position[0] - 'a') * CHESS_BOX_SIZE,
+                              3.5f * CHESS_BOX_SIZE,
+                             PHEIGHT} };
+
+        struct ModelData newEle;
+        newEle.id = id;
+        newEle.location = position;
+        newEle.position = location;
+
+        models.push_back(newEle);
+    }
+
+    // Initialize second player's pawns
+    for (char file = 'a'; file <= 'h'; ++file) {
+        std::string position = std::string(1, file) + "7";
+        std::string pawnID = "PEDONE12";
+        boardState[position] = pawnID;
+
+        tPosition location = { 1, 0, 90.f, {1, 0, 0}, glm::vec3(CPSCALE),
+                               {-3.5f * CHESS_BOX_SIZE + (file - 'a') * CHESS_BOX_SIZE,
+                                2.5f * CHESS_BOX_SIZE,
+                                PHEIGHT} };
+
+        struct ModelData newEle;
+        newEle.id = pawnID;
+        newEle.location = position;
+        newEle.position = location;
+
+        models.push_back(newEle);
+    }
+
+    if (feed != NULL) {
+        feed->publishKeyframe(boardState, models);
+    }
+}
+
+// Publish every move to a feed, starting with a keyframe
+void chessSession::attachFeed(chessBoardFeed* boardFeed) {
+    feed = boardFeed;
+    if (feed != NULL) {
+        feed->publishKeyframe(boardState, models);
+    }
+}
+
+// If camera input is reasonable, then update the angles
+bool chessSession::setCamera(float theta, float phi, float r) {
+    if (r <= 0.0f || !validateAngles(theta, phi)) {
+        return false;
+    }
+    cTheta = theta;
+    cPhi = phi;
+    cRadius = r;
+    return true;
+}
+
+// If light input is reasonable, then update the lights
+bool chessSession::setLight(float theta, float phi, float r) {
+    if (r <= 0.0f || !validateAngles(theta, phi)) {
+        return false;
+    }
+    lTheta = theta;
+    lPhi = phi;
+    lRadius = r;
+    return true;
+}
+
+bool chessSession::setLightPower(float power) {
+    if (power <= 0.0f) {
+        return false;
+    }
+    lightPower = power;
+    return true;
+}
+
+// Play the user's move, keeping what is needed to take it back
+bool chessSession::beginUserMove(const std::string& move, std::ostream& out) {
+    if (gameRecord.size() + 2 > SESSION_MAX_PLIES) {
+        out << "Invalid move: The game is too long.\n";
+        return false;
+    }
+    if (!validateMove(move, true, &out) || !isLegalInRecord(move, out)) {
+        return false;
+    }
+    savedBoardState = boardState;
+    savedModels = models;
+    savedPlies = gameRecord.size();
+    savedPlayerCaptured = playerCapturedIndex;
+    savedEnemyCaptured = enemyCapturedIndex;
+
+    executeMove(move, out);
+    gameRecord.pushUci(move);
+    return true;
+}
+
+// Play the engine's reply (the caller takes the user's move back if it is not valid)
+bool chessSession::finishEngineMove(const std::string& move, std::ostream& out) {
+    if (!validateMove(move, false, &out) || !isLegalInRecord(move, out)) {
+        return false;
+    }
+    gameRecord.pushUci(move);
+    executeMove(move, out);
+    return true;
+}
+
+// The board rules miss checks and promotions; the game record (and its
+// archive) only holds moves legal in the replayed position
+bool chessSession::isLegalInRecord(const std::string& move, std::ostream& out) const {
+    chessPosition position;
+    if (!gameRecord.startFen.empty()) {
+        position.setFromFen(gameRecord.startFen);
+    }
+    for (uint16_t played : gameRecord.moves) {
+        position.applyMove(played);
+    }
+    if (!position.isLegal(chessPosition::packUciMove(move))) {
+        out << "Invalid move: Not legal in this position (king in check, or a promotion without its piece, e.g. e7e8q).\n";
+        return false;
+    }
+    return true;
+}
+
+// Back to the state before the last user move
+void chessSession::undoUserMove() {
+    boardState.swap(savedBoardState);
+    models.swap(savedModels);
+    gameRecord.truncate(savedPlies);
+    playerCapturedIndex = savedPlayerCaptured;
+    enemyCapturedIndex = savedEnemyCaptured;
+    // Spectators resync from a keyframe
+    if (feed != NULL) {
+        feed->publishKeyframe(boardState, models);
+    }
+}
+
+// Check a move against the session's board
+bool chessSession::validateMove(const std::string& move, bool isPlayerTurn, std::ostream* out) const {
+    return validateMoveOn(boardState, move, isPlayerTurn, out);
+}
+
+// Helper function to determine whether a sliding piece can move
+bool chessSession::checkPathClear(char fileSource, char rankSource, char fileDest, char rankDest,
+    const std::map<std::string, std::string>& board) {
+    int fileStep = (fileDest > fileSource) ? 1 : (fileDest < fileSource ? -1 : 0);
+    int rankStep = (rankDest > rankSource) ? 1 : (rankDest < rankSource ? -1 : 0);
+
+    char currentFile = fileSource + fileStep;
+    char currentRank = rankSource + rankStep;
+
+    while (currentFile != fileDest || currentRank != rankDest) {
+        std::string position = std::string(1, currentFile) + std::string(1, currentRank);
+
+        if (board.find(position) != board.end()) {
+            return false; // Path is blocked
+        }
+
+        currentFile += fileStep;
+        currentRank += rankStep;
+    }
+
+    return true; // Path is clear
+}
+
+// Helper function to determine whether a king is under attack
+bool chessSession::isKingUnderAttack(const std::string& kingPosition, const std::map<std::string, std::string>& board,
+    bool isPlayerTurn) {
+    for (const auto& piece : board) {
+        std::string pieceID = piece.second;
+        std::string source = piece.first;
+
+        // Skip if it's the current player's piece
+        if (isPlayerTurn &&
+            (pieceID == "PEDONE13" || pieceID.find("3") != std::string::npos || pieceID == "REGINA2" || pieceID == "RE2"))
+            continue;
+
+        if (!isPlayerTurn &&
+            (pieceID == "PEDONE12" || pieceID.find("02") != std::string::npos || pieceID == "REGINA01" || pieceID == "RE01"))
+            continue;
+
+        // Check if this piece can attack the king's position
+        if (validateMoveOn(board, source + kingPosition, !isPlayerTurn, NULL)) {
+            return true; // King is under attack
+        }
+    }
+
+    return false; // King is safe
+}
+
+// Helper function to determine whether a game is going to over
+bool chessSession::isCheckmate(bool isPlayerTurn) const {
+    // Find the king's position
+    std::string kingID = isPlayerTurn ? "RE2" : "RE01";
+    std::string kingPosition;
+
+    for (const auto& piece : boardState) {
+        if (piece.second == kingID) {
+            kingPosition = piece.first;
+            break;
+        }
+    }
+
+    if (kingPosition.empty()) {
+        std::cerr << "Error: King not found on the board!\n";
+        return false;
+    }
+
+    // Check if the king is under attack
+    if (!isKingUnderAttack(kingPosition, boardState, isPlayerTurn)) {
+        return false; // Not checkmated, as the king is not in check
+    }
+
+    // Try all possible moves for all pieces
+    for (const auto& piece : boardState) {
+        std::string pieceID = piece.second;
+
+        // Ensure the piece belongs to the current player
+        if (isPlayerTurn &&
+            !(pieceID == "PEDONE13" || pieceID.find("3") != std::string::npos || pieceID == "REGINA2" || pieceID == "RE2"))
+            continue;
+
+        if (!isPlayerTurn &&
+            !(pieceID == "PEDONE12" || pieceID.find("02") != std::string::npos || pieceID == "REGINA01" || pieceID == "RE01"))
+            continue;
+
+        std::string source = piece.first;
+
+        // Iterate over all possible destinations on the board
+        for (char file = 'a'; file <= 'h'; ++file) {
+            for (char rank = '1'; rank <= '8'; ++rank) {
+                std::string destination = std::string(1, file) + std::string(1, rank);
+
+                // Skip if the destination is the same as the source
+                if (source == destination) continue;
+
+                // Copy the board state to simulate the move
+                std::map<std::string, std::string> simulatedBoard = boardState;
+
+                // Check if the move is valid and simulate it (on the board only, the models stay put)
+                if (validateMoveOn(simulatedBoard, source + destination, isPlayerTurn, NULL)) {
+                    // Simulate the move
+                    simulatedBoard[destination] = simulatedBoard[source];
+                    simulatedBoard.erase(source);
+
+                    // Check if the king is still under attack
+                    if (!isKingUnderAttack(piece.second == kingID ? destination : kingPosition, simulatedBoard, isPlayerTurn)) {
+                        return false; // Found a valid move to escape check, not checkmate
+                    }
+                }
+            }
+        }
+    }
+
+    return true; // No valid moves found to escape check, checkmate
+}
+
+// Check whether a move command is reasonable
+bool chessSession::validateMoveOn(const std::map<std::string, std::string>& boardState, const std::string& move,
+    bool isPlayerTurn, std::ostream* out) {
+    // Four characters, five for a promotion (e7e8q)
+    if (move.size() != 4 && move.size() != 5) {
+        return false;
+    }
+
+    std::string source = move.substr(0, 2);
+    std::string destination = move.substr(2, 2);
+
+    if (boardState.find(source) == boardState.end()) {
+        reject(out, "Invalid move: Source position does not exist or is empty.\n");
+        return false;
+    }
+
+    std::string pieceID = boardState.at(source);
+
+    // Check if player controls the piece
+    if (isPlayerTurn && pieceID.find("PEDONE13") == std::string::npos &&
+        pieceID.find("TORRE3") == std::string::npos &&
+        pieceID.find("Object3") == std::string::npos &&
+        pieceID.find("ALFIERE3") == std::string::npos &&
+        pieceID.find("REGINA2") == std::string::npos &&
+        pieceID.find("RE2") == std::string::npos) {
+        reject(out, "Invalid move: Player cannot move this piece.\n");
+        return false;
+    }
+
+    // Validate destination bounds
+    char fileSource = source[0], rankSource = source[1];
+    char fileDest = destination[0], rankDest = destination[1];
+
+    if (fileSource < 'a' || fileSource > 'h' || rankSource < '1' || rankSource > '8' ||
+        fileDest < 'a' || fileDest > 'h' || rankDest < '1' || rankDest > '8') {
+        reject(out, "Invalid move: Destination is out of bounds.\n");
+        return false;
+    }
+
+    // Allow capturing enemy pieces
+    if (boardState.find(destination) != boardState.end()) {
+        std::string targetID = boardState.at(destination);
+
+        // Determine if the target piece is an enemy
+        bool isEnemyPiece = (isPlayerTurn &&
+            (targetID.find("TORRE02") != std::string::npos ||
+                targetID.find("Object02") != std::string::npos ||
+                targetID.find("ALFIERE02") != std::string::npos ||
+                targetID.find("REGINA01") != std::string::npos ||
+                targetID.find("RE01") != std::string::npos ||
+                targetID == "PEDONE12")) ||
+            (!isPlayerTurn &&
+                (targetID.find("TORRE3") != std::string::npos ||
+                    targetID.find("Object3") != std::string::npos ||
+                    targetID.find("ALFIERE3") != std::string::npos ||
+                    targetID.find("REGINA2") != std::string::npos ||
+                    targetID.find("RE2") != std::string::npos ||
+                    targetID == "PEDONE13"));
+
+        if (!isEnemyPiece) {
+            reject(out, "Invalid move: Destination is occupied by a friendly piece.\n");
+            return false;
+        }
+    }
+
+    // Validate move based on piece type
+    char fileDiff = std::abs(fileDest - fileSource);
+    char rankDiff = std::abs(rankDest - rankSource);
+
+    if (pieceID.find("TORRE") != std::string::npos) { // Rook
+        if (fileDiff != 0 && rankDiff != 0) {
+            reject(out, "Invalid move: Rook can only move horizontally or vertically.\n");
+            return false;
+        }
+        if (!checkPathClear(fileSource, rankSource, fileDest, rankDest, boardState)) {
+            reject(out, "Invalid move: Path is blocked for the Rook.\n");
+            return false;
+        }
+    }
+    else if (pieceID.find("ALFIERE") != std::string::npos) { // Bishop
+        if (fileDiff != rankDiff) {
+            reject(out, "Invalid move: Bishop can only move diagonally.\n");
+            return false;
+        }
+        if (!checkPathClear(fileSource, rankSource, fileDest, rankDest, boardState)) {
+            reject(out, "Invalid move: Path is blocked for the Bishop.\n");
+            return false;
+        }
+    }
+    else if (pieceID.find("REGINA") != std::string::npos) { // Queen
+        if (fileDiff != rankDiff && fileDiff != 0 && rankDiff != 0) {
+            reject(out, "Invalid move: Queen must move like a rook or bishop.\n");
+            return false;
+        }
+        if (!checkPathClear(fileSource, rankSource, fileDest, rankDest, boardState)) {
+            reject(out, "Invalid move: Path is blocked for the Queen.\n");
+            return false;
+        }
+    }
+    else if (pieceID.find("Object") != std::string::npos) { // Knight
+        if (!(fileDiff == 2 && rankDiff == 1) && !(fileDiff == 1 && rankDiff == 2)) {
+            reject(out, "Invalid move: Knight must move in an L-shape.\n");
+            return false;
+        }
+    }
+    else if (pieceID.find("RE") != std::string::npos) { // King
+        if (fileDiff > 1 || rankDiff > 1) {
+            reject(out, "Invalid move: King can only move one square in any direction.\n");
+            return false;
+        }
+    }
+    else if (pieceID == "PEDONE13" || pieceID == "PEDONE12") { // Pawn
+        if (fileDiff > 1 || rankDiff == 0 || rankDiff > 2) {
+            reject(out, "Invalid move: Pawn can only move forward or capture diagonally.\n");
+            return false;
+        }
+        if (fileDiff == 1 && boardState.find(destination) == boardState.end()) {
+            reject(out, "Invalid move: Pawn can only capture diagonally.\n");
+            return false;
+        }
+        if (fileDiff == 0 && rankDiff == 2 && rankSource != '2' && rankSource != '7') {
+            reject(out, "Invalid move: Pawn can only move two squares forward from its starting rank.\n");
+            return false;
+        }
+    }
+
+    // Only a pawn reaching the last rank promotes, to a queen, rook, bishop or knight
+    if (move.size() == 5) {
+        bool lastRank = (pieceID == "PEDONE13" && rankDest == '8') || (pieceID == "PEDONE12" && rankDest == '1');
+        if (!lastRank || std::string("qrbn").find(move[4]) == std::string::npos) {
+            reject(out, "Invalid move: Only a pawn reaching the last rank promotes, to q, r, b or n.\n");
+            return false;
+        }
+    }
+
+    return true; // Move is valid
+}
+
+// Execute a move if it's reasonable
+void chessSession::executeMove(const std::string& move, std::ostream& out) {
+
+    std::string source = move.substr(0, 2);
+    std::string destination = move.substr(2, 2);
+    char promotionPiece = (move.length() == 5) ? move[4] : '\0'; // Check for promotion character
+
+    auto pieceIt = boardState.find(source);
+    if (pieceIt == boardState.end()) {
+        out << "Error: No piece found at source position " << source << "\n";
+        return;
+    }
+
+    std::string pieceID = pieceIt->second;
+    chessBoardDelta delta = { feedLocation(source), feedLocation(destination), FEED_NO_LOCATION, 0 };
+
+    // Handle capturing an enemy piece
+    if (boardState.find(destination) != boardState.end()) {
+        std::string capturedPieceID = boardState[destination];
+        boardState.erase(destination);
+
+        // Determine if the captured piece is an enemy piece
+        bool isEnemyPiece =
+            capturedPieceID == "PEDONE12" ||
+            capturedPieceID == "TORRE02" || capturedPieceID == "Object02" ||
+            capturedPieceID == "ALFIERE02" || capturedPieceID == "REGINA01" ||
+            capturedPieceID == "RE01";
+
+        // If it's an enemy piece, relocate it
+        if (isEnemyPiece) {
+            // Find the captured piece in models
+            for (auto& entry : models) {
+                if (entry.id == capturedPieceID && entry.location == destination) {
+                    char capturedFile = 'a' + (enemyCapturedIndex % 8); // Cycle through a-h
+                    float capturedRank = 0.0f; // Rank 0 for enemy pieces
+                    enemyCapturedIndex++;
+
+                    std::string capturedPosition = std::string(1, capturedFile) + std::to_string(static_cast<int>(capturedRank));
+                    entry.location = capturedPosition;
+                    delta.capturedTo = feedLocation(capturedPosition);
+
+                    // Update the 3D position
+                    entry.position.tPos.x = (capturedFile - 'a') * CHESS_BOX_SIZE - 3.5f * CHESS_BOX_SIZE;
+                    entry.position.tPos.y = (capturedRank - 1) * CHESS_BOX_SIZE - 3.5f * CHESS_BOX_SIZE;
+
+                    break;
+                }
+            }
+        }
+        else {
+            // Relocate player's piece if captured
+            char capturedFile = 'a' + (playerCapturedIndex % 8); // Cycle through a-h
+            float capturedRank = 9.0f; // Rank 9 for player's pieces
+            playerCapturedIndex++;
+
+            // Find the player's captured piece in models
+            for (auto& entry : models) {
+                if (entry.id == capturedPieceID && entry.location == destination) {
+                    std::string capturedPosition = std::string(1, capturedFile) + std::to_string(static_cast<int>(capturedRank));
+                    entry.location = capturedPosition;
+                    delta.capturedTo = feedLocation(capturedPosition);
+
+                    // Update the 3D position
+                    entry.position.tPos.x = (capturedFile - 'a') * CHESS_BOX_SIZE - 3.5f * CHESS_BOX_SIZE;
+                    entry.position.tPos.y = (capturedRank - 1) * CHESS_BOX_SIZE - 3.5f * CHESS_BOX_SIZE;
+
+                    break;
+                }
+            }
+        }
+
+        // Debug: Piece captured
+        out << "Captured piece: " << capturedPieceID << " relocated to edge of the board.\n";
+    }
+
+    // Update board state
+    if (promotionPiece != '\0') {
+        // Handle promotion (update the piece ID, the engine's pawns become its pieces)
+        bool enemyPawn = pieceID == "PEDONE12";
+        std::string promotedID;
+        switch (promotionPiece) {
+        case 'q': promotedID = enemyPawn ? "REGINA01" : "REGINA2"; break; // Queen
+        case 'r': promotedID = enemyPawn ? "TORRE02" : "TORRE3"; break;   // Rook
+        case 'b': promotedID = enemyPawn ? "ALFIERE02" : "ALFIERE3"; break; // Bishop
+        case 'n': promotedID = enemyPawn ? "Object02" : "Object3"; break;  // Knight
+        default:
+            out << "Invalid promotion piece: " << promotionPiece << "\n";
+            // A capture may already have happened
+            if (feed != NULL) {
+                feed->publishKeyframe(boardState, models);
+            }
+            return;
+        }
+        boardState[destination] = promotedID;
+        delta.promotion = feedPieceCode(promotedID);
+        out << "Pawn promoted to " << promotedID << " at " << destination << "\n";
+    }
+    else {
+        boardState[destination] = pieceID;
+    }
+    boardState.erase(source);
+
+
+    // Update the piece's position in models
+    for (auto& entry : models) {
+        if (entry.location == source) {
+            entry.location = destination;
+            entry.position.tPos.x = (destination[0] - 'a') * CHESS_BOX_SIZE - 3.5f * CHESS_BOX_SIZE;
+            entry.position.tPos.y = (destination[1] - '1') * CHESS_BOX_SIZE - 3.5f * CHESS_BOX_SIZE;
+            break;
+        }
+    }
+
+    if (feed != NULL) {
+        feed->publishDelta(delta, boardState, models);
+    }
+}
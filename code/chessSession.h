@@ -0,0 +1,88 @@
+/*
+Author: Botao Huang
+Class: ECE6122 (A)
+Last Date Modified: 10/19/2026
+Description:
+State of one game: board, piece models, move record, camera and light.
+The window plays one session; the game server hosts many
+*/
+
+#ifndef CHESS_SESSION_H
+#define CHESS_SESSION_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <iostream>
+#include <cstdint>
+#include "chessCommon.h"
+#include "chessGameRecord.h"
+#include "chessBoardFeed.h"
+
+// Longest game a session keeps (bounds the memory of a session)
+const size_t SESSION_MAX_PLIES = 1024;
+
+class chessSession
+{
+public:
+    explicit chessSession(uint32_t id = 0);
+
+    // Starting position, default camera and light
+    void reset();
+
+    uint32_t id;
+    // Square ("e2") to piece id
+    std::map<std::string, std::string> boardState;
+    // Piece models and where they are drawn
+    tModelMap models;
+    chessGameRecord gameRecord;
+    // Camera and light locations
+    float cTheta, cPhi, cRadius;
+    float lTheta, lPhi, lRadius;
+    float lightPower;
+
+    // Rules; reasons for a rejected move go to out unless it is NULL
+    bool validateMove(const std::string& move, bool isPlayerTurn, std::ostream* out) const;
+    void executeMove(const std::string& move, std::ostream& out);
+    // Whether the side has no move that gets its king out of check
+    bool isCheckmate(bool isPlayerTurn) const;
+
+    // View changes, false (and nothing changed) when out of range
+    bool setCamera(float theta, float phi, float r);
+    bool setLight(float theta, float phi, float r);
+    bool setLightPower(float power);
+
+    // A user move is played first; the engine's reply then completes the pair,
+    // or undoUserMove takes the user move back
+    bool beginUserMove(const std::string& move, std::ostream& out);
+    bool finishEngineMove(const std::string& move, std::ostream& out);
+    void undoUserMove();
+
+    // Publish every move to a feed (a keyframe goes out right away); NULL stops
+    void attachFeed(chessBoardFeed* boardFeed);
+
+private:
+    chessBoardFeed* feed;
+
+    // Captured pieces are lined up beside the board (a0, b0, ... and a9, b9, ...)
+    int playerCapturedIndex;
+    int enemyCapturedIndex;
+
+    // State before the last user move
+    std::map<std::string, std::string> savedBoardState;
+    tModelMap savedModels;
+    size_t savedPlies;
+    int savedPlayerCaptured;
+    int savedEnemyCaptured;
+
+    // Whether the move is legal after the moves of the game record (reason to out)
+    bool isLegalInRecord(const std::string& move, std::ostream& out) const;
+    static bool validateMoveOn(const std::map<std::string, std::string>& board, const std::string& move,
+        bool isPlayerTurn, std::ostream* out);
+    static bool checkPathClear(char fileSource, char rankSource, char fileDest, char rankDest,
+        const std::map<std::string, std::string>& board);
+    static bool isKingUnderAttack(const std::string& kingPosition, const std::map<std::string, std::string>& board,
+        bool isPlayerTurn);
+};
+
+#endif
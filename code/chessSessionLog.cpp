@@ -0,0 +1,129 @@
+/*
+Author: Botao Huang
+Class: ECE6122 (A)
+Last Date Modified: 10/19/2026
+Description:
+Session log for record and replay definition file
+*/
+
+#include <cstring>
+#include "chessSessionLog.h"
+
+namespace
+{
+    // Log file header
+    void makeHeader(char header[SESSION_LOG_HEADER_SIZE])
+    {
+        std::memset(header, 0, SESSION_LOG_HEADER_SIZE);
+        std::memcpy(header, SESSION_LOG_MAGIC, sizeof(SESSION_LOG_MAGIC));
+        uint32_t version = SESSION_LOG_VERSION;
+        std::memcpy(header + 8, &version, sizeof(version));
+    }
+}
+
+// Create (or truncate) the log
+bool chessSessionLogWriter::open(const std::string& path)
+{
+    close();
+    file.open(path, std::ios::binary | std::ios::trunc);
+    if (!file)
+    {
+        return false;
+    }
+    char header[SESSION_LOG_HEADER_SIZE];
+    makeHeader(header);
+    file.write(header, sizeof(header));
+    start = std::chrono::steady_clock::now();
+    return static_cast<bool>(file);
+}
+
+void chessSessionLogWriter::close()
+{
+    if (file.is_open())
+    {
+        file.close();
+    }
+    file.clear();
+}
+
+void chessSessionLogWriter::writeCommand(const std::string& line)
+{
+    write(SESSION_LOG_COMMAND, line.data(), line.size());
+}
+
+void chessSessionLogWriter::writeEngineReply(const std::string& move)
+{
+    write(SESSION_LOG_ENGINE_REPLY, move.data(), move.size());
+}
+
+void chessSessionLogWriter::writeState(const chessSessionLogState& state)
+{
+    write(SESSION_LOG_STATE, &state, sizeof(state));
+}
+
+void chessSessionLogWriter::flush()
+{
+    file.flush();
+}
+
+void chessSessionLogWriter::write(uint8_t type, const void* data, size_t length)
+{
+    chessSessionLogRecord record;
+    std::memset(&record, 0, sizeof(record));
+    record.timeUs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count());
+    record.length = static_cast<uint32_t>(length);
+    record.type = type;
+    file.write(reinterpret_cast<const char*>(&record), sizeof(record));
+    file.write(static_cast<const char*>(data), static_cast<std::streamsize>(length));
+}
+
+// Constructor function
+chessSessionLogReader::chessSessionLogReader() : offset(0)
+{
+}
+
+bool chessSessionLogReader::open(const std::string& path)
+{
+    close();
+    if (!logFile.openReadOnly(path))
+    {
+        return false;
+    }
+    char expected[SESSION_LOG_HEADER_SIZE];
+    makeHeader(expected);
+    if (logFile.size() < SESSION_LOG_HEADER_SIZE || std::memcmp(logFile.data(), expected, sizeof(expected)) != 0)
+    {
+        close();
+        return false;
+    }
+    offset = SESSION_LOG_HEADER_SIZE;
+    return true;
+}
+
+void chessSessionLogReader::close()
+{
+    logFile.close();
+    offset = 0;
+}
+
+// Next record, false at the end (a log cut short by a crash ends at its last whole record)
+bool chessSessionLogReader::next(chessSessionLogEntry& entry)
+{
+    if (!logFile.isOpen() || logFile.size() - offset < sizeof(chessSessionLogRecord))
+    {
+        return false;
+    }
+    chessSessionLogRecord record;
+    std::memcpy(&record, logFile.data() + offset, sizeof(record));
+    if (logFile.size() - offset - sizeof(record) < record.length)
+    {
+        return false;
+    }
+    entry.type = record.type;
+    entry.timeUs = record.timeUs;
+    entry.data = reinterpret_cast<const char*>(logFile.data() + offset + sizeof(record));
+    entry.length = record.length;
+    offset += sizeof(record) + record.length;
+    return true;
+}
@@ -0,0 +1,97 @@
+/*
+Author: Botao Huang
+Class: ECE6122 (A)
+Last Date Modified: 10/19/2026
+Description:
+Session log for record and replay
+A binary log of every command, every engine reply and the board state after
+each command, with timestamps, so a session can be replayed against a new build
+*/
+
+#ifndef CHESS_SESSION_LOG_H
+#define CHESS_SESSION_LOG_H
+
+#include <string>
+#include <fstream>
+#include <chrono>
+#include <cstdint>
+#include "ECE_MappedFile.h"
+
+// Log file identification
+const char SESSION_LOG_MAGIC[8] = { 'E', 'C', 'E', 'S', 'L', 'O', 'G', '1' };
+const uint32_t SESSION_LOG_VERSION = 1;
+const uint32_t SESSION_LOG_HEADER_SIZE = 16;
+
+// Record types
+const uint8_t SESSION_LOG_COMMAND = 'C';        // Command line (words joined by one blank)
+const uint8_t SESSION_LOG_ENGINE_REPLY = 'E';   // Engine's move, empty when it gave none
+const uint8_t SESSION_LOG_STATE = 'S';          // chessSessionLogState after the command
+
+// Header in front of every record's payload
+struct chessSessionLogRecord
+{
+    uint64_t timeUs;        // Since the log was opened
+    uint32_t length;        // Payload bytes
+    uint8_t type;
+    uint8_t reserved[3];
+};
+static_assert(sizeof(chessSessionLogRecord) == 16, "log record headers are 16 bytes on disk");
+
+// Board after a command, to find where a replay diverges
+struct chessSessionLogState
+{
+    uint32_t boardHash;     // feedBoardHash of the board
+    uint32_t plies;         // Moves in the game record
+    uint64_t latencyUs;     // Time the command took when it was recorded
+};
+static_assert(sizeof(chessSessionLogState) == 16, "log states are 16 bytes on disk");
+
+// One record read back
+struct chessSessionLogEntry
+{
+    uint8_t type;
+    uint64_t timeUs;
+    const char* data;
+    size_t length;
+};
+
+// Records a session (one log per process)
+class chessSessionLogWriter
+{
+private:
+    std::ofstream file;
+    std::chrono::steady_clock::time_point start;
+
+public:
+    // Create (or truncate) the log
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const { return file.is_open(); }
+
+    void writeCommand(const std::string& line);
+    void writeEngineReply(const std::string& move);
+    void writeState(const chessSessionLogState& state);
+    void flush();
+
+private:
+    void write(uint8_t type, const void* data, size_t length);
+};
+
+// Memory mapped, sequential reader
+class chessSessionLogReader
+{
+private:
+    ECE_MappedFile logFile;
+    uint64_t offset;
+
+public:
+    chessSessionLogReader();
+
+    bool open(const std::string& path);
+    void close();
+
+    // Next record, false at the end (or at a truncated record)
+    bool next(chessSessionLogEntry& entry);
+};
+
+#endif
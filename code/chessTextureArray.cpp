@@ -0,0 +1,116 @@
+/*
+Author: Botao Huang
+Class: ECE6122 (A)
+Last Date Modified: 10/19/2026
+Description:
+Component texture array definition file
+*/
+
+#include <algorithm>
+#include "chessTextureArray.h"
+// Load BMP function support
+#include <common/texture.hpp>
+
+// Constructor function
+chessTextureArray::chessTextureArray() : missing(false)
+{
+}
+
+// Destructor function
+chessTextureArray::~chessTextureArray()
+{
+    for (sizeBucket& bucket : buckets)
+    {
+        for (unsigned char* pixels : bucket.layers)
+        {
+            delete [] pixels;
+        }
+    }
+    deleteGLBuffers();
+}
+
+// Read a BMP file (once per file) and give its array texture and layer
+void chessTextureArray::addLayer(const std::string& textureFile, GLuint& texture, int& layer)
+{
+    std::vector<std::string>::const_iterator it = std::find(layerFiles.begin(), layerFiles.end(), textureFile);
+    if (it != layerFiles.end())
+    {
+        size_t file = static_cast<size_t>(it - layerFiles.begin());
+        texture = buckets[layerBuckets[file]].texture;
+        layer = layerIndices[file];
+        return;
+    }
+
+    unsigned int width = 0;
+    unsigned int height = 0;
+    unsigned char* pixels = loadBMP_pixels(textureFile.c_str(), width, height);
+    if (pixels == NULL)
+    { // Missing texture: one plain grey texel (a row padded to 4 bytes)
+        width = 1;
+        height = 1;
+        pixels = new unsigned char[4];
+        std::fill(pixels, pixels + 4, 128);
+        missing = true;
+    }
+
+    // The array of images this size
+    size_t bucket = 0;
+    while (bucket < buckets.size() && (buckets[bucket].width != width || buckets[bucket].height != height))
+    {
+        ++bucket;
+    }
+    if (bucket == buckets.size())
+    {
+        sizeBucket created;
+        created.width = width;
+        created.height = height;
+        glGenTextures(1, &created.texture);
+        buckets.push_back(created);
+    }
+
+    layerFiles.push_back(textureFile);
+    layerBuckets.push_back(bucket);
+    layerIndices.push_back(static_cast<int>(buckets[bucket].layers.size()));
+    buckets[bucket].layers.push_back(pixels);
+    texture = buckets[bucket].texture;
+    layer = layerIndices.back();
+}
+
+// Upload every array, with mipmaps
+bool chessTextureArray::build()
+{
+    for (sizeBucket& bucket : buckets)
+    {
+        glBindTexture(GL_TEXTURE_2D_ARRAY, bucket.texture);
+        glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGB8, bucket.width, bucket.height,
+            static_cast<GLsizei>(bucket.layers.size()), 0, GL_BGR, GL_UNSIGNED_BYTE, NULL);
+        // BMP rows are padded to 4 bytes, the default unpack alignment
+        for (size_t i = 0; i < bucket.layers.size(); ++i)
+        {
+            glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, static_cast<GLint>(i), bucket.width, bucket.height, 1,
+                GL_BGR, GL_UNSIGNED_BYTE, bucket.layers[i]);
+            delete [] bucket.layers[i];
+        }
+        bucket.layers.clear();
+
+        // Same trilinear filtering as loadBMP_custom
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+    }
+    return !missing;
+}
+
+void chessTextureArray::deleteGLBuffers()
+{
+    for (sizeBucket& bucket : buckets)
+    {
+        if (bucket.texture != 0)
+        {
+            glDeleteTextures(1, &bucket.texture);
+            bucket.texture = 0;
+        }
+    }
+}
@@ -0,0 +1,53 @@
+/*
+Author: Botao Huang
+Class: ECE6122 (A)
+Last Date Modified: 10/19/2026
+Description:
+Component textures in 2D array textures, one array per image size
+BMPs of the same size become layers of one array at their own resolution (no
+resampling); draws pick their layer per instance and a frame binds each array
+once
+*/
+
+#ifndef CHESS_TEXTURE_ARRAY_H
+#define CHESS_TEXTURE_ARRAY_H
+
+#include <string>
+#include <vector>
+// Include GLEW
+#include <GL/glew.h>
+
+class chessTextureArray
+{
+private:
+    // One array texture: every image of one size
+    struct sizeBucket
+    {
+        unsigned int width;
+        unsigned int height;
+        GLuint texture;
+        std::vector<unsigned char*> layers;     // Pixels until build (BMP rows)
+    };
+    std::vector<sizeBucket> buckets;
+    // Files added so far, with their bucket and layer
+    std::vector<std::string> layerFiles;
+    std::vector<size_t> layerBuckets;
+    std::vector<int> layerIndices;
+    bool missing;               // A file could not be read
+
+public:
+    chessTextureArray();
+    ~chessTextureArray();
+
+    // Read a BMP file (once per file) and give its array texture and layer;
+    // the texture name exists from the call, the pixels are uploaded by build
+    void addLayer(const std::string& textureFile, GLuint& texture, int& layer);
+    // Upload every array, with mipmaps; false if a file was missing (drawn plain grey)
+    bool build();
+    void deleteGLBuffers();
+
+    size_t getArrayCount() const { return buckets.size(); }
+    size_t getLayerCount() const { return layerFiles.size(); }
+};
+
+#endif
@@ -1,7 +1,7 @@
 /*
 Author: Botao Huang
 Class: ECE6122 (A)
-Last Date Modified: 12/3/2024
+Last Date Modified: 10/19/2026
 Description:
 Main program of the project, accept commands, do operations and renderings
 */
@@ -9,11 +9,18 @@ Main program of the project, accept commands, do operations and renderings
 // Include standard headers
 #include <stdio.h>
 #include <stdlib.h>
+#include <time.h>
 #include <vector>
 #include <iostream>
-#include <sstream>
 #include <string>
 #include <map>
+#include <chrono>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <string.h>
 
 // Include GLEW
 #include <GL/glew.h>
@@ -33,45 +40,84 @@ using namespace glm;
 #include <common/vboindexer.hpp>
 // Specific chess class
 #include "chessComponent.h"
+#include "chessDrawList.h"
+#include "chessMeshArena.h"
+#include "chessTextureArray.h"
+#include "chessFrameUniforms.h"
 #include "chessCommon.h"
 // Chess Engine Class
 #include "ECE_ChessEngine.h"
+#include "ECE_AnalysisCache.h"
+#include "ECE_EnginePool.h"
+#include "ECE_Speculator.h"
+#include "ECE_LiveAnalysis.h"
+#include "chessGameRecord.h"
+#include "chessSession.h"
+#include "chessGameArchive.h"
+#include "chessPositionIndex.h"
+#include "chessPosition.h"
+#include "chessScript.h"
+#include "chessSessionLog.h"
+#include "chessBoardFeed.h"
+#include "ECE_ReplayEngine.h"
+#include "ECE_RingBuffer.h"
+#include "ECE_TripleBuffer.h"
 
 // Sets up the chess board
-void setupChessGame(tModelMap& cTModelMap, std::map<std::string, std::string>& boardState);
-// Process the command user input
-void processCommand(const std::string& command, ECE_ChessEngine& engine);
-
-// Validate whether a move command is ok
-bool validatemove(const std::string& move, const std::map<std::string, std::string>& boardState, bool isPlayerTurn);
-// Validate whether a move command is ok, but with no cout
-bool validatemoveNoPrint(const std::string& move, const std::map<std::string, std::string>& boardState, bool isPlayerTurn);
-// Execute the move
-void executemove(const std::string& move, std::map<std::string, std::string>& boardState,
-    tModelMap& cTModelMap, std::vector<chessComponent>& gchessComponents);
+void setupChessGame();
+// Process the command user input, returns false for an invalid command or move
+bool processCommand(const chessCommandTokenizer& tokens, ECE_ChessEngine& engine);
+// Process a command, recording it in the session log (--record)
+bool runCommand(const chessCommandTokenizer& tokens, ECE_ChessEngine& engine);
+// Run a command script without a window, reporting commands per second
+int runCommandScript(const std::string& scriptPath, ECE_ChessEngine& engine);
+// Replay a recorded session, reporting latencies and divergent board states
+int runReplay(const std::string& logPath, bool paced);
+// Append the current game to the game archive
+void archiveCurrentGame();
+// Print the archived games that reached the current position
+void printPositionGames(int listed);
+// Show the live analysis lines in the window title
+void updateAnalysisTitle(GLFWwindow* window, const LiveSnapshot& snapshot);
+// Window mode threads: stdin reader and game logic (commands and engine waits)
+void inputLoop();
+void gameLogicLoop(ECE_ChessEngine& engine);
+// Publish the current game for the render loop
+void publishScene();
 
 // Global variables
-// Camera locations
-float cTheta = 1.0f;
-float cPhi = 0.0f;
-float cRadius = 40.0f;
-// Light locations
-float lTheta = 0.0f;
-float lPhi = 0.0f;
-float lRadius = 15.0f;
-// Light Power
-float LightPower = 200.0f;
-// My eaten piece index
-int myEatenIndex = 0;
-// Enemy's eaten piece index
-int enemyEatenIndex = 0;
-
 std::vector<chessComponent> gchessComponents;
-// Setup the Chess board locations
-tModelMap cTModelMap;
-// Setup the Chess board state
-std::map<std::string, std::string> boardState;
-std::vector<std::string> moveHistory; // Stores all moves made in the game
+// Component ID -> index in gchessComponents, filled once the models are loaded
+std::map<std::string, int> gcomponentIndex;
+// The game in the window: board, piece models, moves, camera and light
+chessSession gameSession;
+// Finished games are appended to games.idx / games.mov
+const char* GAME_ARCHIVE_BASE = "games";
+// Archived games and their position index (built by ECE_PositionIndex)
+chessGameArchiveReader gameArchive;
+chessPositionIndex positionIndex;
+const char* POSITION_INDEX_FILE = "games.pos";
+// Persistent engine analysis cache (shared with other game processes)
+ECE_AnalysisCache analysisCache;
+const char* ANALYSIS_CACHE_FILE = "analysis.cache";
+const uint64_t ANALYSIS_CACHE_SLOTS = 1ULL << 20;
+// Spare engines analysing the user's likely replies ahead of time
+ECE_EnginePool speculationPool;
+ECE_Speculator* speculator = NULL;
+const int SPECULATION_CLIENT_ID = 1;
+// Live MultiPV analysis shown in the window title
+ECE_LiveAnalysis liveAnalysis;
+LiveSnapshot liveSnapshot;
+int liveMultiPv = 1;
+const char* WINDOW_TITLE = "Game Of Chess 3D";
+// Engine executable (--engine)
+std::string enginePath = "komodo.exe";
+// Session log of every command and engine reply (--record)
+chessSessionLogWriter sessionLog;
+// Set while a session log is replayed: no engine processes are started
+bool replaying = false;
+// Divergent commands printed by a replay (the rest are only counted)
+const uint64_t REPLAY_MAX_REPORTED = 10;
 
 // Define structs
 struct ChessPiece {
@@ -79,9 +125,153 @@ struct ChessPiece {
     tPosition positionData; // Contains position, rotation, etc.
 };
 
+// One command line read from stdin (plain data, copied through the ring)
+const size_t GAME_COMMAND_CHARS = 256;
+struct GameCommand {
+    char text[GAME_COMMAND_CHARS];
+    size_t length;
+};
+
+// One model to draw: its component and where
+struct ScenePiece {
+    int component;          // Index in gchessComponents
+    tPosition position;
+};
+
+// Everything the render loop needs from the game, published after every command
+struct SceneSnapshot {
+    std::vector<ScenePiece> pieces;
+    float cTheta, cPhi, cRadius;
+    float lTheta, lPhi, lRadius;
+    float lightPower;
+    bool analysisShown;     // Live analysis lines belong in the window title
+};
+
+// Input thread -> game thread
+ECE_RingBuffer<GameCommand, 64> commandQueue;
+std::mutex commandMutex;                // Only for sleeping on an empty queue
+std::condition_variable commandReady;
+// Game thread -> render loop
+ECE_TripleBuffer<SceneSnapshot> sceneBuffer;
+// Set by the quit command, ends the render loop
+std::atomic<bool> quitRequested(false);
+std::atomic<bool> stopGameLogic(false);
+// Live analysis shown in the title (game thread)
+bool analysisShown = false;
+
 // Main Entry Point
-int main(void)
+int main(int argc, char* argv[])
 {
+    // Command line options
+    int speculationEngines = 2;
+    std::string metricsFile;
+    int metricsPeriod = 10;
+    bool headless = false;
+    std::string scriptPath;
+    std::string recordPath;
+    std::string replayPath;
+    bool replayPaced = false;
+    bool renderStats = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string option = argv[i];
+        if (option == "--engine" && i + 1 < argc)
+        {
+            enginePath = argv[++i];
+        }
+        else if (option == "--speculate" && i + 1 < argc)
+        {
+            speculationEngines = atoi(argv[++i]);
+        }
+        else if (option == "--metrics-file" && i + 1 < argc)
+        {
+            metricsFile = argv[++i];
+        }
+        else if (option == "--metrics-period" && i + 1 < argc)
+        {
+            metricsPeriod = atoi(argv[++i]);
+        }
+        else if (option == "--headless")
+        {
+            headless = true;
+        }
+        else if (option == "--script" && i + 1 < argc)
+        {
+            scriptPath = argv[++i];
+        }
+        else if (option == "--record" && i + 1 < argc)
+        {
+            recordPath = argv[++i];
+        }
+        else if (option == "--replay" && i + 1 < argc)
+        {
+            replayPath = argv[++i];
+        }
+        else if (option == "--paced")
+        {
+            replayPaced = true;
+        }
+        else if (option == "--render-stats")
+        {
+            renderStats = true;
+        }
+    }
+    if (headless && scriptPath.empty())
+    {
+        fprintf(stderr, "--headless needs --script <file> (- reads standard input)\n");
+        return -1;
+    }
+    if (headless || !replayPath.empty())
+    {
+        // The transcript goes out in large blocks instead of a flush per line
+        setvbuf(stdout, NULL, _IOFBF, SCRIPT_BUFFER_BYTES);
+        std::cin.tie(NULL);
+    }
+    // A replay needs no window, engine or caches
+    if (!replayPath.empty())
+    {
+        setupChessGame();
+        return runReplay(replayPath, replayPaced);
+    }
+    if (!recordPath.empty() && !sessionLog.open(recordPath))
+    {
+        fprintf(stderr, "Cannot create the session log %s\n", recordPath.c_str());
+        return -1;
+    }
+
+    ECE_ChessEngine engine;
+    engine.InitializeEngine(enginePath);
+    // Periodic engine I/O metrics report
+    ECE_MetricsDumper metricsDumper;
+    if (!metricsFile.empty()) {
+        metricsDumper.start(&engine.getMetrics(), metricsFile, metricsPeriod);
+    }
+    if (analysisCache.open(ANALYSIS_CACHE_FILE, ANALYSIS_CACHE_SLOTS)) {
+        engine.attachAnalysisCache(&analysisCache);
+    }
+    if (positionIndex.open(POSITION_INDEX_FILE)) {
+        gameArchive.open(GAME_ARCHIVE_BASE);
+    }
+    // Speculation is optional, the game plays the same without it
+    std::vector<std::pair<std::string, std::string>> speculationOptions;
+    speculationOptions.push_back(std::make_pair("Threads", "1"));
+    if (speculationEngines > 0 && speculationPool.start(enginePath, speculationEngines, speculationOptions)) {
+        speculator = new ECE_Speculator(speculationPool, SPECULATION_CLIENT_ID, speculationEngines,
+            "go depth " + std::to_string(engine.getSearchDepth()));
+        if (analysisCache.isOpen()) {
+            speculator->attachAnalysisCache(&analysisCache);
+        }
+    }
+
+    // No GLFW/GLEW and no meshes: only the board state is set up
+    if (headless)
+    {
+        setupChessGame();
+        int status = runCommandScript(scriptPath, engine);
+        archiveCurrentGame();
+        return status;
+    }
+
     // Initialize GLFW
     if (!glfwInit())
     {
@@ -97,7 +287,7 @@ int main(void)
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
     // Open a window and create its OpenGL context
-    window = glfwCreateWindow(1024, 768, "Game Of Chess 3D", NULL, NULL);
+    window = glfwCreateWindow(1024, 768, WINDOW_TITLE, NULL, NULL);
     if (window == NULL) {
         fprintf(stderr, "Failed to open GLFW window. If you have an Intel GPU, they are not 3.3 compatible. Try the 2.1 version.\n");
         getchar();
@@ -128,23 +318,22 @@ int main(void)
 
     glEnable(GL_CULL_FACE);
 
-    GLuint VertexArrayID;
-    glGenVertexArrays(1, &VertexArrayID);
-    glBindVertexArray(VertexArrayID);
-
     // Create and compile our GLSL program from the shaders
     GLuint programID = LoadShaders("StandardShading.vertexshader", "StandardShading.fragmentshader");
 
-    // Get a handle for our "MVP" uniform
-    GLuint MatrixID = glGetUniformLocation(programID, "MVP");
-    GLuint ViewMatrixID = glGetUniformLocation(programID, "V");
-    GLuint ModelMatrixID = glGetUniformLocation(programID, "M");
-
     GLuint TextureID = glGetUniformLocation(programID, "myTextureSampler");
 
-    GLuint LightSwitchID = glGetUniformLocation(programID, "lightSwitch");
-
-    GLuint LightPowerID = glGetUniformLocation(programID, "LightPower");
+    // Camera and lighting: one uniform buffer, uploaded once per frame
+    GLuint FrameBlockID = glGetUniformBlockIndex(programID, FRAME_UNIFORMS_BLOCK);
+    glUniformBlockBinding(programID, FrameBlockID, FRAME_UNIFORMS_BINDING);
+    GLuint FrameUniformBuffer;
+    glGenBuffers(1, &FrameUniformBuffer);
+    glBindBuffer(GL_UNIFORM_BUFFER, FrameUniformBuffer);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(chessFrameUniforms), NULL, GL_DYNAMIC_DRAW);
+    glBindBufferBase(GL_UNIFORM_BUFFER, FRAME_UNIFORMS_BINDING, FrameUniformBuffer);
+    chessFrameUniforms frameUniforms;
+    frameUniforms.frame = 0;
+    frameUniforms.padding = 0;
 
     // Load the OBJ files
     bool cBoard = loadAssImpLab3("objFiles/Stone_Chess_Board/12951_Stone_Chess_Board_v1_L3.obj", gchessComponents);
@@ -157,797 +346,626 @@ int main(void)
         return -1;
     }
 
-    setupChessGame(cTModelMap, boardState);
+    setupChessGame();
 
+    // Every texture a layer of an array texture, one array per image size
+    chessTextureArray textureArray;
     for (auto cit = gchessComponents.begin(); cit != gchessComponents.end(); cit++)
     {
-        // Setup VBO buffers
-        cit->setupGLBuffers();
-        // Setup Texture
-        cit->setupTextureBuffers();
+        // Setup the mesh (buffers are shared, in the mesh arena)
+        cit->setupMesh();
+        // Setup Texture (its layer)
+        cit->setupTextureBuffers(textureArray);
+        // First component of a name wins, as the lookup by name did
+        gcomponentIndex.insert(std::make_pair(cit->getComponentID(), static_cast<int>(cit - gchessComponents.begin())));
+    }
+
+    // Every mesh in one vertex and index buffer
+    chessMeshArena meshArena;
+    meshArena.build(gchessComponents);
+    if (!textureArray.build())
+    {
+        std::cout << "Some textures could not be loaded, drawn plain grey" << std::endl;
     }
 
     glUseProgram(programID);
 
-    GLuint LightID = glGetUniformLocation(programID, "LightPosition_worldspace");
+    // Textures are bound in Texture Unit 0
+    glActiveTexture(GL_TEXTURE0);
+    glUniform1i(TextureID, 0);
 
     double lastTime = glfwGetTime();
     int nbFrames = 0;
-
-    std::string command;
-    bool firstTime = true;
-
-    ECE_ChessEngine engine;
-    engine.InitializeEngine();
+    size_t culledInstances = 0;
+
+    // Commands are read and played on their own threads; the window keeps
+    // drawing the last published scene while they wait for stdin or the engine
+    publishScene();
+    std::cin.tie(NULL);
+    std::thread gameThread(gameLogicLoop, std::ref(engine));
+    std::thread inputThread(inputLoop);
+    // Blocked in getline until the next line: not joined
+    inputThread.detach();
+    glfwSwapInterval(1);
+    bool analysisTitle = false;
+    // Rebuilt when a new scene is published, not every frame
+    chessDrawList drawList;
+    // GLEW 1.13 misses extensions on core profiles: the version counts too
+    drawList.setIndirect(GLEW_VERSION_4_3 || (GLEW_ARB_multi_draw_indirect && GLEW_ARB_base_instance));
 
     do {
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-        // Compute the VP matrix from keyboard and mouse input
-        computeMatricesFromInputsFinalProject(cTheta, cPhi, cRadius);
-        glm::mat4 ProjectionMatrix = getProjectionMatrix();
-        glm::mat4 ViewMatrix = getViewMatrix();
+        // Newest scene published by the game thread
+        if (sceneBuffer.update()) {
+            const SceneSnapshot& scene = sceneBuffer.front();
+            drawList.clear();
+            for (std::vector<ScenePiece>::const_iterator it = scene.pieces.begin(); it != scene.pieces.end(); ++it) {
+                drawList.add(gchessComponents, it->component, it->position);
+            }
+            drawList.build(gchessComponents);
+        }
+        const SceneSnapshot& scene = sceneBuffer.front();
 
+        // Compute the VP matrix from keyboard and mouse input
+        computeMatricesFromInputsFinalProject(scene.cTheta, scene.cPhi, scene.cRadius);
+        frameUniforms.projection = getProjectionMatrix();
+        frameUniforms.view = getViewMatrix();
+        frameUniforms.viewProjection = frameUniforms.projection * frameUniforms.view;
+
+        float lTheta = scene.lTheta;
+        float lPhi = scene.lPhi;
+        float lRadius = scene.lRadius;
         float lightPosX = lRadius * sin(glm::radians(lTheta)) * cos(glm::radians(lPhi));
         float lightPosY = lRadius * sin(glm::radians(lTheta)) * sin(glm::radians(lPhi));
         float lightPosZ = lRadius * cos(glm::radians(lTheta));
+        frameUniforms.lightPosition = glm::vec3(lightPosX, lightPosY, lightPosZ);
+        frameUniforms.lightPower = scene.lightPower;
+        frameUniforms.lightSwitch = 1;
+        frameUniforms.time = static_cast<float>(glfwGetTime());
+        ++frameUniforms.frame;
+
+        // Same for every draw: one upload per frame
+        glBindBuffer(GL_UNIFORM_BUFFER, FrameUniformBuffer);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(frameUniforms), &frameUniforms);
+
+        // Render loop (what is outside the view is not drawn)
+        drawList.cull(frameUniforms.viewProjection);
+        drawList.render(gchessComponents, meshArena);
+
+        // Drawn and culled instances, averaged over a second
+        if (renderStats) {
+            nbFrames++;
+            culledInstances += drawList.getCulledCount();
+            double currentTime = glfwGetTime();
+            if (currentTime - lastTime >= 1.0) {
+                fprintf(stderr, "render: %.2f ms/frame, %zu instances, %.1f culled\n",
+                    1000.0 * (currentTime - lastTime) / nbFrames, drawList.getVisibleCount() + drawList.getCulledCount(),
+                    static_cast<double>(culledInstances) / nbFrames);
+                nbFrames = 0;
+                culledInstances = 0;
+                lastTime = currentTime;
+            }
+        }
 
-        // Render loop
-        for (tModelMap::const_iterator it = cTModelMap.begin(); it != cTModelMap.end(); ++it) {
-            const std::string& id = it->id;
-            const tPosition& cTPosition = it->position;
-
-            auto componentIt = std::find_if(gchessComponents.begin(), gchessComponents.end(),
-                [&id](const chessComponent& comp) { return comp.getComponentID() == id; });
-
-            if (componentIt != gchessComponents.end()) {
-                for (unsigned int pit = 0; pit < cTPosition.rCnt; ++pit) {
-                    tPosition cTPositionMorph = cTPosition;
-                    cTPositionMorph.tPos.x += pit * cTPosition.rDis * CHESS_BOX_SIZE;
-
-                    glm::mat4 ModelMatrix = componentIt->genModelMatrix(cTPositionMorph);
-                    glm::mat4 MVP = ProjectionMatrix * ViewMatrix * ModelMatrix;
-
-                    glUniformMatrix4fv(MatrixID, 1, GL_FALSE, &MVP[0][0]);
-                    glUniformMatrix4fv(ModelMatrixID, 1, GL_FALSE, &ModelMatrix[0][0]);
-                    glUniformMatrix4fv(ViewMatrixID, 1, GL_FALSE, &ViewMatrix[0][0]);
-
-                    glUniform3f(LightID, lightPosX, lightPosY, lightPosZ);
-
-                    glUniform1f(LightPowerID, static_cast<float>(LightPower));
-                    glUniform1i(LightSwitchID, static_cast<int>(true));
-
-                    componentIt->setupTexture(TextureID);
-                    componentIt->renderMesh();
-                }
+        // Latest live analysis lines
+        if (scene.analysisShown) {
+            if (liveAnalysis.isStarted() && liveAnalysis.drain(liveSnapshot)) {
+                updateAnalysisTitle(window, liveSnapshot);
+                analysisTitle = true;
             }
         }
+        else if (analysisTitle) {
+            glfwSetWindowTitle(window, WINDOW_TITLE);
+            analysisTitle = false;
+        }
 
         // Swap buffers
         glfwSwapBuffers(window);
         glfwPollEvents();
 
-        std::getline(std::cin, command);
-        processCommand(command, engine);
-
     } while (glfwGetKey(window, GLFW_KEY_ESCAPE) != GLFW_PRESS &&
-        glfwWindowShouldClose(window) == 0);
+        glfwWindowShouldClose(window) == 0 && !quitRequested);
 
-    glDeleteProgram(programID);
-    glDeleteVertexArrays(1, &VertexArrayID);
-
-    glfwTerminate();
-    return 0;
-}
-
-// Validate whether camera input is reasonable
-bool validateCameraInput(float theta, float phi) {
-    if (theta >= 10 && theta <= 80)
+    // The game thread finishes the command it is on (an engine search included)
+    stopGameLogic = true;
     {
-        if (phi >= 0 && phi <= 360)
-        {
-            return true;
-        }
+        std::lock_guard<std::mutex> lock(commandMutex);
+        commandReady.notify_one();
     }
-    return false;
-}
+    gameThread.join();
 
-// If camera input is reasonable, then update the angles
-void adjustCamera(float theta, float phi, float r)
-{
-    cTheta = theta;
-    cPhi = phi;
-    cRadius = r;
-}
-
-// Validate whether light input is reasonable
-bool validateLightInput(float theta, float phi) {
-    if (theta >= 10 && theta <= 80)
-    {
-        if (phi >= 0 && phi <= 360)
-        {
-            return true;
-        }
-    }
-    return false;
-}
+    drawList.deleteGLBuffers();
+    meshArena.deleteGLBuffers();
+    textureArray.deleteGLBuffers();
+    glDeleteBuffers(1, &FrameUniformBuffer);
+    glDeleteProgram(programID);
 
-// If light input is reasonable, then update the lights
-void adjustLight(float theta, float phi, float r)
-{
-    lTheta = theta;
-    lPhi = phi;
-    lRadius = r;
+    archiveCurrentGame();
+    sessionLog.close();
+    glfwTerminate();
+    return 0;
 }
 
-// Helper function to determine whether a sliding piece can move
-bool checkPathClear(char fileSource, char rankSource, char fileDest, char rankDest,
-    const std::map<std::string, std::string>& boardState) {
-    int fileStep = (fileDest > fileSource) ? 1 : (fileDest < fileSource ? -1 : 0);
-    int rankStep = (rankDest > rankSource) ? 1 : (rankDest < rankSource ? -1 : 0);
-
-    char currentFile = fileSource + fileStep;
-    char currentRank = rankSource + rankStep;
-
-    while (currentFile != fileDest || currentRank != rankDest) {
-        std::string position = std::string(1, currentFile) + std::string(1, currentRank);
-
-        if (boardState.find(position) != boardState.end()) {
-            return false; // Path is blocked
-        }
-
-        currentFile += fileStep;
-        currentRank += rankStep;
-    }
+// Match the input words with the operations needed to be done
+bool processCommand(const chessCommandTokenizer& tokens, ECE_ChessEngine& engine) {
+    if (tokens.is(0, "move")) {
+        std::string move(tokens.token(1), tokens.length(1));
+        std::string previousMoves = gameSession.gameRecord.uciMoves();
 
-    return true; // Path is clear
-}
+        // Validate and execute the user's move (added to the move history)
+        if (gameSession.beginUserMove(move, std::cout)) {
+            if (speculator != NULL) {
+                speculator->recordUserMove(previousMoves, move);
+            }
+            const std::string& moveHistoryStr = gameSession.gameRecord.uciMoves();
 
-// Helper function to determine whether a king is under attack
-bool isKingUnderAttack(const std::string& kingPosition, const std::map<std::string, std::string>& boardState, bool isPlayerTurn) {
-    for (const auto& piece : boardState) {
-        std::string pieceID = piece.second;
-        std::string source = piece.first;
+            // Use the reply analysed while the user was thinking, otherwise ask the engine now
+            std::string engineMove;
+            bool haveReply = speculator != NULL && speculator->takeReply(moveHistoryStr, engineMove);
+            if (!haveReply) {
+                // Send the move to the chess engine
+                engine.sendMove(moveHistoryStr);
 
-        // Skip if it's the current player's piece
-        if (isPlayerTurn &&
-            (pieceID == "PEDONE13" || pieceID.find("3") != std::string::npos || pieceID == "REGINA2" || pieceID == "RE2"))
-            continue;
+                // Get the engine's response
+                haveReply = engine.getResponseMove(engineMove);
+            }
+            if (sessionLog.isOpen()) {
+                sessionLog.writeEngineReply(haveReply ? engineMove : std::string());
+            }
 
-        if (!isPlayerTurn &&
-            (pieceID == "PEDONE12" || pieceID.find("02") != std::string::npos || pieceID == "REGINA01" || pieceID == "RE01"))
-            continue;
+            // Validate and execute the engine's move
+            bool valid = haveReply && gameSession.finishEngineMove(engineMove, std::cout);
+            if (valid) {
+                // Start on the user's likely replies while they think
+                if (speculator != NULL) {
+                    speculator->speculate(gameSession.gameRecord.uciMoves());
+                }
+            }
+            else {
+                // Revert the board state and the piece models
+                std::cerr << "Invalid command or move!!\n";
+                gameSession.undoUserMove();
+            }
 
-        // Check if this piece can attack the king's position
-        if (validatemoveNoPrint(source + kingPosition, boardState, !isPlayerTurn)) {
-            return true; // King is under attack
+            // Follow the game with the live analysis
+            if (liveAnalysis.isSearching()) {
+                liveAnalysis.analyse(gameSession.gameRecord.uciMoves(), liveMultiPv);
+            }
+            return valid;
         }
     }
-
-    return false; // King is safe
-}
-
-// Helper function to determine whether a game is going to over
-bool isCheckmate(const std::map<std::string, std::string>& boardState, bool isPlayerTurn) {
-    // Find the king's position
-    std::string kingID = isPlayerTurn ? "RE2" : "RE01";
-    std::string kingPosition;
-
-    for (const auto& piece : boardState) {
-        if (piece.second == kingID) {
-            kingPosition = piece.first;
-            break;
+    else if (tokens.is(0, "camera")) {
+        float theta, phi, r;
+        if (tokens.toFloat(1, theta) && tokens.toFloat(2, phi) && tokens.toFloat(3, r)
+            && gameSession.setCamera(theta, phi, r)) {
+            return true;
         }
     }
-
-    if (kingPosition.empty()) {
-        std::cout << "Error: King not found on the board!\n";
-        return false;
-    }
-
-    // Check if the king is under attack
-    if (!isKingUnderAttack(kingPosition, boardState, isPlayerTurn)) {
-        return false; // Not checkmated, as the king is not in check
-    }
-
-    // Try all possible moves for all pieces
-    for (const auto& piece : boardState) {
-        std::string pieceID = piece.second;
-
-        // Ensure the piece belongs to the current player
-        if (isPlayerTurn &&
-            !(pieceID == "PEDONE13" || pieceID.find("3") != std::string::npos || pieceID == "REGINA2" || pieceID == "RE2"))
-            continue;
-
-        if (!isPlayerTurn &&
-            !(pieceID == "PEDONE12" || pieceID.find("02") != std::string::npos || pieceID == "REGINA01" || pieceID == "RE01"))
-            continue;
-
-        std::string source = piece.first;
-
-        // Iterate over all possible destinations on the board
-        for (char file = 'a'; file <= 'h'; ++file) {
-            for (char rank = '1'; rank <= '8'; ++rank) {
-                std::string destination = std::string(1, file) + std::string(1, rank);
-
-                // Skip if the destination is the same as the source
-                if (source == destination) continue;
-
-                // Copy the board state to simulate the move
-                std::map<std::string, std::string> simulatedBoard = boardState;
-
-                // Check if the move is valid and simulate it
-                if (validatemoveNoPrint(source + destination, simulatedBoard, isPlayerTurn)) {
-                    // Simulate the move
-                    executemove(source + destination, simulatedBoard, cTModelMap, gchessComponents);
-
-                    // Check if the king is still under attack
-                    if (!isKingUnderAttack(kingPosition, simulatedBoard, isPlayerTurn)) {
-                        return false; // Found a valid move to escape check, not checkmate
-                    }
-                }
-            }
+    else if (tokens.is(0, "light")) {
+        float theta, phi, r;
+        if (tokens.toFloat(1, theta) && tokens.toFloat(2, phi) && tokens.toFloat(3, r)
+            && gameSession.setLight(theta, phi, r)) {
+            return true;
         }
     }
-
-    return true; // No valid moves found to escape check, checkmate
-}
-
-
-// Validate whether a move is reasonable without cout
-bool validatemoveNoPrint(const std::string& move, const std::map<std::string, std::string>& boardState, bool isPlayerTurn) {
-    if (move.size() != 4) {
-        return false;
-    }
-
-    std::string source = move.substr(0, 2);
-    std::string destination = move.substr(2, 2);
-
-    if (boardState.find(source) == boardState.end()) {
-        return false;
-    }
-
-    std::string pieceID = boardState.at(source);
-
-    // Check if player controls the piece
-    if (isPlayerTurn && pieceID.find("PEDONE13") == std::string::npos &&
-        pieceID.find("TORRE3") == std::string::npos &&
-        pieceID.find("Object3") == std::string::npos &&
-        pieceID.find("ALFIERE3") == std::string::npos &&
-        pieceID.find("REGINA2") == std::string::npos &&
-        pieceID.find("RE2") == std::string::npos) {
-        return false;
-    }
-
-    // Validate destination bounds
-    char fileSource = source[0], rankSource = source[1];
-    char fileDest = destination[0], rankDest = destination[1];
-
-    if (fileSource < 'a' || fileSource > 'h' || rankSource < '1' || rankSource > '8' ||
-        fileDest < 'a' || fileDest > 'h' || rankDest < '1' || rankDest > '8') {
-        return false;
-    }
-
-    // Allow capturing enemy pieces
-    if (boardState.find(destination) != boardState.end()) {
-        std::string targetID = boardState.at(destination);
-
-        // Determine if the target piece is an enemy
-        bool isEnemyPiece = (isPlayerTurn &&
-            (targetID.find("TORRE02") != std::string::npos ||
-                targetID.find("Object02") != std::string::npos ||
-                targetID.find("ALFIERE02") != std::string::npos ||
-                targetID.find("REGINA01") != std::string::npos ||
-                targetID.find("RE01") != std::string::npos ||
-                targetID == "PEDONE12")) ||
-            (!isPlayerTurn &&
-                (targetID.find("TORRE3") != std::string::npos ||
-                    targetID.find("Object3") != std::string::npos ||
-                    targetID.find("ALFIERE3") != std::string::npos ||
-                    targetID.find("REGINA2") != std::string::npos ||
-                    targetID.find("RE2") != std::string::npos ||
-                    targetID == "PEDONE13"));
-
-        if (!isEnemyPiece) {
-            return false;
+    else if (tokens.is(0, "power")) {
+        float power;
+        if (tokens.toFloat(1, power) && gameSession.setLightPower(power)) {
+            return true;
         }
     }
-
-    // Validate move based on piece type
-    char fileDiff = std::abs(fileDest - fileSource);
-    char rankDiff = std::abs(rankDest - rankSource);
-
-    if (pieceID.find("TORRE") != std::string::npos) { // Rook
-        if (fileDiff != 0 && rankDiff != 0) {
-            return false;
+    else if (tokens.is(0, "metrics")) {
+        if (tokens.is(1, "reset")) {
+            engine.getMetrics().reset();
         }
-        if (!checkPathClear(fileSource, rankSource, fileDest, rankDest, boardState)) {
-            return false;
+        else {
+            engine.getMetrics().print(std::cout);
         }
+        return true;
     }
-    else if (pieceID.find("ALFIERE") != std::string::npos) { // Bishop
-        if (fileDiff != rankDiff) {
-            return false;
-        }
-        if (!checkPathClear(fileSource, rankSource, fileDest, rankDest, boardState)) {
-            return false;
-        }
+    else if (tokens.is(0, "cache")) {
+        analysisCache.printStats(std::cout);
+        return true;
     }
-    else if (pieceID.find("REGINA") != std::string::npos) { // Queen
-        if (fileDiff != rankDiff && fileDiff != 0 && rankDiff != 0) {
-            return false;
-        }
-        if (!checkPathClear(fileSource, rankSource, fileDest, rankDest, boardState)) {
-            return false;
+    else if (tokens.is(0, "games")) {
+        int listed = 5;
+        if (tokens.count() > 1 && !tokens.toInt(1, listed)) {
+            listed = 0;
         }
+        printPositionGames(listed);
+        return true;
     }
-    else if (pieceID.find("Object") != std::string::npos) { // Knight
-        if (!(fileDiff == 2 && rankDiff == 1) && !(fileDiff == 1 && rankDiff == 2)) {
-            return false;
+    else if (tokens.is(0, "analyze")) {
+        int k = atoi(tokens.token(1));
+        if (replaying) {
+            // Live analysis does not change the game
+            return true;
         }
-    }
-    else if (pieceID.find("RE") != std::string::npos) { // King
-        if (fileDiff > 1 || rankDiff > 1) {
-            return false;
+        if (tokens.is(1, "off")) {
+            // The render loop puts the plain title back
+            liveAnalysis.stop();
+            analysisShown = false;
+            return true;
         }
-    }
-    else if (pieceID == "PEDONE13" || pieceID == "PEDONE12") { // Pawn
-        if (fileDiff > 1 || rankDiff == 0 || rankDiff > 2) {
-            return false;
+        else if (k > 0 && k <= LIVE_MAX_MULTIPV && liveAnalysis.start(enginePath)) {
+            liveMultiPv = k;
+            analysisShown = true;
+            liveAnalysis.analyse(gameSession.gameRecord.uciMoves(), liveMultiPv);
+            return true;
         }
-        if (fileDiff == 1 && boardState.find(destination) == boardState.end()) {
-            return false;
+    }
+    else if (tokens.is(0, "speculation")) {
+        if (speculator != NULL) {
+            speculator->printStats(std::cout);
         }
-        if (fileDiff == 0 && rankDiff == 2 && rankSource != '2' && rankSource != '7') {
-            return false;
+        else {
+            std::cout << "Speculation is disabled\n";
         }
+        return true;
     }
-
-    return true; // Move is valid
-}
-
-// Check whether a move command is reasonable
-bool validatemove(const std::string& move, const std::map<std::string, std::string>& boardState, bool isPlayerTurn) {
-    if (move.size() != 4) {
-        return false;
+    else if (tokens.is(0, "quit")) {
+        // The render loop ends and main saves the game
+        std::cout << "Thanks for playing!" << std::endl;
+        quitRequested = true;
+        return true;
     }
 
-    std::string source = move.substr(0, 2);
-    std::string destination = move.substr(2, 2);
+    // Not flushed: interactive input flushes std::cout before the next read
+    std::cout << "Invalid command or move!!\n";
+    return false;
+}
 
-    if (boardState.find(source) == boardState.end()) {
-        std::cout << "Invalid move: Source position does not exist or is empty.\n";
-        return false;
+// Run a command script without a window (--headless --script)
+int runCommandScript(const std::string& scriptPath, ECE_ChessEngine& engine) {
+    chessScriptReader script;
+    if (!script.open(scriptPath)) {
+        std::cerr << "Cannot open script " << scriptPath << std::endl;
+        return -1;
     }
 
-    std::string pieceID = boardState.at(source);
-
-    // Check if player controls the piece
-    if (isPlayerTurn && pieceID.find("PEDONE13") == std::string::npos &&
-        pieceID.find("TORRE3") == std::string::npos &&
-        pieceID.find("Object3") == std::string::npos &&
-        pieceID.find("ALFIERE3") == std::string::npos &&
-        pieceID.find("REGINA2") == std::string::npos &&
-        pieceID.find("RE2") == std::string::npos) {
-        std::cout << "Invalid move: Player cannot move this piece.\n";
-        return false;
+    chessCommandTokenizer tokens;
+    char* line;
+    size_t length;
+    uint64_t commands = 0, invalid = 0;
+    auto start = std::chrono::steady_clock::now();
+    while (script.nextLine(line, length)) {
+        // Blank lines and # comments are skipped, quit ends the script
+        if (tokens.split(line, length) == 0 || tokens.token(0)[0] == '#') {
+            continue;
+        }
+        if (tokens.is(0, "quit")) {
+            break;
+        }
+        commands++;
+        if (!runCommand(tokens, engine)) {
+            invalid++;
+        }
     }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout.flush();
 
-    // Validate destination bounds
-    char fileSource = source[0], rankSource = source[1];
-    char fileDest = destination[0], rankDest = destination[1];
+    // Report on stderr so the transcript on stdout can be compared between runs
+    std::cerr << "Script " << scriptPath << ": " << commands << " commands (" << invalid << " invalid) in "
+        << seconds << " s, " << (seconds > 0.0 ? commands / seconds : 0.0) << " commands/s" << std::endl;
+    return 0;
+}
 
-    if (fileSource < 'a' || fileSource > 'h' || rankSource < '1' || rankSource > '8' ||
-        fileDest < 'a' || fileDest > 'h' || rankDest < '1' || rankDest > '8') {
-        std::cout << "Invalid move: Destination is out of bounds.\n";
-        return false;
+// Input thread: queue every stdin line for the game thread
+void inputLoop() {
+    std::string line;
+    GameCommand command;
+    while (std::getline(std::cin, line)) {
+        // Longer lines are cut (no command is that long)
+        command.length = std::min(line.size(), GAME_COMMAND_CHARS - 1);
+        memcpy(command.text, line.data(), command.length);
+        command.text[command.length] = '\0';
+        while (!commandQueue.push(command)) {
+            // Full: the game thread is behind (an engine search), wait for room
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        std::lock_guard<std::mutex> lock(commandMutex);
+        commandReady.notify_one();
     }
+}
 
-    // Allow capturing enemy pieces
-    if (boardState.find(destination) != boardState.end()) {
-        std::string targetID = boardState.at(destination);
-
-        // Determine if the target piece is an enemy
-        bool isEnemyPiece = (isPlayerTurn &&
-            (targetID.find("TORRE02") != std::string::npos ||
-                targetID.find("Object02") != std::string::npos ||
-                targetID.find("ALFIERE02") != std::string::npos ||
-                targetID.find("REGINA01") != std::string::npos ||
-                targetID.find("RE01") != std::string::npos ||
-                targetID == "PEDONE12")) ||
-            (!isPlayerTurn &&
-                (targetID.find("TORRE3") != std::string::npos ||
-                    targetID.find("Object3") != std::string::npos ||
-                    targetID.find("ALFIERE3") != std::string::npos ||
-                    targetID.find("REGINA2") != std::string::npos ||
-                    targetID.find("RE2") != std::string::npos ||
-                    targetID == "PEDONE13"));
-
-        if (!isEnemyPiece) {
-            std::cout << "Invalid move: Destination is occupied by a friendly piece.\n";
-            return false;
+// Game thread: play queued commands, then publish the scene they produced
+void gameLogicLoop(ECE_ChessEngine& engine) {
+    GameCommand command;
+    chessCommandTokenizer tokens;
+    while (!stopGameLogic && !quitRequested) {
+        if (!commandQueue.pop(command)) {
+            std::unique_lock<std::mutex> lock(commandMutex);
+            commandReady.wait_for(lock, std::chrono::milliseconds(100), []() {
+                return commandQueue.size() > 0 || stopGameLogic;
+            });
+            continue;
         }
+        tokens.split(command.text, command.length);
+        runCommand(tokens, engine);
+        // Replies are visible before the next line is typed
+        std::cout.flush();
+        publishScene();
     }
+}
 
-    // Validate move based on piece type
-    char fileDiff = std::abs(fileDest - fileSource);
-    char rankDiff = std::abs(rankDest - rankSource);
+// Copy what the render loop draws into the scene buffer
+void publishScene() {
+    SceneSnapshot& scene = sceneBuffer.back();
+    // The slot keeps its capacity: no allocation once the game is under way
+    scene.pieces.clear();
+    for (const ModelData& model : gameSession.models) {
+        std::map<std::string, int>::const_iterator componentIt = gcomponentIndex.find(model.id);
+        if (componentIt != gcomponentIndex.end()) {
+            ScenePiece piece;
+            piece.component = componentIt->second;
+            piece.position = model.position;
+            scene.pieces.push_back(piece);
+        }
+    }
+    scene.cTheta = gameSession.cTheta;
+    scene.cPhi = gameSession.cPhi;
+    scene.cRadius = gameSession.cRadius;
+    scene.lTheta = gameSession.lTheta;
+    scene.lPhi = gameSession.lPhi;
+    scene.lRadius = gameSession.lRadius;
+    scene.lightPower = gameSession.lightPower;
+    scene.analysisShown = analysisShown;
+    sceneBuffer.publish();
+}
 
-    if (pieceID.find("TORRE") != std::string::npos) { // Rook
-        if (fileDiff != 0 && rankDiff != 0) {
-            std::cout << "Invalid move: Rook can only move horizontally or vertically.\n";
-            return false;
-        }
-        if (!checkPathClear(fileSource, rankSource, fileDest, rankDest, boardState)) {
-            std::cout << "Invalid move: Path is blocked for the Rook.\n";
-            return false;
-        }
-    }
-    else if (pieceID.find("ALFIERE") != std::string::npos) { // Bishop
-        if (fileDiff != rankDiff) {
-            std::cout << "Invalid move: Bishop can only move diagonally.\n";
-            return false;
-        }
-        if (!checkPathClear(fileSource, rankSource, fileDest, rankDest, boardState)) {
-            std::cout << "Invalid move: Path is blocked for the Bishop.\n";
-            return false;
-        }
-    }
-    else if (pieceID.find("REGINA") != std::string::npos) { // Queen
-        if (fileDiff != rankDiff && fileDiff != 0 && rankDiff != 0) {
-            std::cout << "Invalid move: Queen must move like a rook or bishop.\n";
-            return false;
-        }
-        if (!checkPathClear(fileSource, rankSource, fileDest, rankDest, boardState)) {
-            std::cout << "Invalid move: Path is blocked for the Queen.\n";
-            return false;
-        }
-    }
-    else if (pieceID.find("Object") != std::string::npos) { // Knight
-        if (!(fileDiff == 2 && rankDiff == 1) && !(fileDiff == 1 && rankDiff == 2)) {
-            std::cout << "Invalid move: Knight must move in an L-shape.\n";
-            return false;
+// Command words joined by one blank
+std::string commandText(const chessCommandTokenizer& tokens) {
+    std::string text;
+    for (int i = 0; i < tokens.count(); ++i) {
+        if (i > 0) {
+            text += ' ';
         }
+        text.append(tokens.token(i), tokens.length(i));
     }
-    else if (pieceID.find("RE") != std::string::npos) { // King
-        if (fileDiff > 1 || rankDiff > 1) {
-            std::cout << "Invalid move: King can only move one square in any direction.\n";
-            return false;
-        }
-    }
-    else if (pieceID == "PEDONE13" || pieceID == "PEDONE12") { // Pawn
-        if (fileDiff > 1 || rankDiff == 0 || rankDiff > 2) {
-            std::cout << "Invalid move: Pawn can only move forward or capture diagonally.\n";
-            return false;
-        }
-        if (fileDiff == 1 && boardState.find(destination) == boardState.end()) {
-            std::cout << "Invalid move: Pawn can only capture diagonally.\n";
-            return false;
-        }
-        if (fileDiff == 0 && rankDiff == 2 && rankSource != '2' && rankSource != '7') {
-            std::cout << "Invalid move: Pawn can only move two squares forward from its starting rank.\n";
-            return false;
-        }
-    }
-
-    return true; // Move is valid
+    return text;
 }
 
-// Execute a move if it's reasonable
-void executemove(const std::string& move, std::map<std::string, std::string>& boardState,
-    tModelMap& cTModelMap, std::vector<chessComponent>& gchessComponents) {
-    static int playerCapturedIndex = 0; // Tracks captured player pieces (a0, b0, c0, ...)
-    static int enemyCapturedIndex = 0;  // Tracks captured enemy pieces (a9, b9, c9, ...)
+// Board of the session as the log records it
+chessSessionLogState currentLogState(uint64_t latencyUs) {
+    chessSessionLogState state;
+    state.boardHash = feedBoardHash(gameSession.boardState);
+    state.plies = static_cast<uint32_t>(gameSession.gameRecord.size());
+    state.latencyUs = latencyUs;
+    return state;
+}
 
-    std::string source = move.substr(0, 2);
-    std::string destination = move.substr(2, 2);
-    char promotionPiece = (move.length() == 5) ? move[4] : '\0'; // Check for promotion character
+// Process a command; with --record the command, the engine's reply and the
+// board after it go to the session log
+bool runCommand(const chessCommandTokenizer& tokens, ECE_ChessEngine& engine) {
+    if (!sessionLog.isOpen()) {
+        return processCommand(tokens, engine);
+    }
+    sessionLog.writeCommand(commandText(tokens));
+    auto start = std::chrono::steady_clock::now();
+    bool valid = processCommand(tokens, engine);
+    uint64_t latencyUs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count());
+    sessionLog.writeState(currentLogState(latencyUs));
+    return valid;
+}
 
-    auto pieceIt = boardState.find(source);
-    if (pieceIt == boardState.end()) {
-        std::cerr << "Error: No piece found at source position " << source << "\n";
-        return;
+// Replay a session log (--replay): every command goes through processCommand
+// again, the engine's replies come from the log. Commands run back to back, or
+// at their recorded times with --paced
+int runReplay(const std::string& logPath, bool paced) {
+    chessSessionLogReader log;
+    if (!log.open(logPath)) {
+        std::cerr << "Cannot open the session log " << logPath << std::endl;
+        return -1;
     }
+    replaying = true;
+    ECE_ReplayEngine engine;
+    engine.setPaced(paced);
+
+    ECE_Histogram replayUs;
+    ECE_Histogram recordedUs;
+    chessCommandTokenizer tokens;
+    std::string line;
+    bool started = false;
+    bool pending = false;
+    bool stopped = false;
+    uint64_t pendingUs = 0;
+    uint64_t firstUs = 0;
+    uint64_t commands = 0, invalid = 0, divergent = 0, firstDivergent = 0, unusedReplies = 0;
+    auto origin = std::chrono::steady_clock::now();
+    // Recorded time on this run's clock
+    auto replayTime = [&](uint64_t timeUs) {
+        return origin + std::chrono::microseconds(timeUs - firstUs);
+    };
 
-    std::string pieceID = pieceIt->second;
-
-    // Handle capturing an enemy piece
-    if (boardState.find(destination) != boardState.end()) {
-        std::string capturedPieceID = boardState[destination];
-        boardState.erase(destination);
-
-        // Determine if the captured piece is an enemy piece
-        bool isEnemyPiece =
-            capturedPieceID == "PEDONE12" ||
-            capturedPieceID == "TORRE02" || capturedPieceID == "Object02" ||
-            capturedPieceID == "ALFIERE02" || capturedPieceID == "REGINA01" ||
-            capturedPieceID == "RE01";
-
-        // If it's an enemy piece, relocate it
-        if (isEnemyPiece) {
-            // Find the captured piece in cTModelMap
-            for (auto& entry : cTModelMap) {
-                if (entry.id == capturedPieceID && entry.location == destination) {
-                    char capturedFile = 'a' + (enemyCapturedIndex % 8); // Cycle through a-h
-                    float capturedRank = 0.0f; // Rank 0 for enemy pieces
-                    enemyCapturedIndex++;
-
-                    std::string capturedPosition = std::string(1, capturedFile) + std::to_string(static_cast<int>(capturedRank));
-                    entry.location = capturedPosition;
-
-                    // Update the 3D position
-                    entry.position.tPos.x = (capturedFile - 'a') * CHESS_BOX_SIZE - 3.5f * CHESS_BOX_SIZE;
-                    entry.position.tPos.y = (capturedRank - 1) * CHESS_BOX_SIZE - 3.5f * CHESS_BOX_SIZE;
-
-                    break;
-                }
+    // Run the pending command and compare the board with the recorded one
+    auto replayCommand = [&](const chessSessionLogState* expected) {
+        pending = false;
+        tokens.split(&line[0], line.size());
+        if (tokens.is(0, "quit")) {
+            stopped = true;
+            return;
+        }
+        if (paced) {
+            std::this_thread::sleep_until(replayTime(pendingUs));
+        }
+        auto start = std::chrono::steady_clock::now();
+        if (!processCommand(tokens, engine)) {
+            invalid++;
+        }
+        uint64_t latencyUs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count());
+        replayUs.record(latencyUs);
+        commands++;
+        unusedReplies += engine.discardUnusedReplies();
+        if (expected == NULL) {
+            return;
+        }
+        recordedUs.record(expected->latencyUs);
+        chessSessionLogState state = currentLogState(latencyUs);
+        if (state.boardHash != expected->boardHash || state.plies != expected->plies) {
+            if (divergent++ == 0) {
+                firstDivergent = commands;
+            }
+            if (divergent <= REPLAY_MAX_REPORTED) {
+                std::cerr << "Divergent board after command " << commands << " (" << commandText(tokens) << "): "
+                    << state.plies << " plies, recorded " << expected->plies << " plies"
+                    << (state.boardHash != expected->boardHash ? ", different pieces" : "") << "\n";
             }
         }
-        else {
-            // Relocate player's piece if captured
-            char capturedFile = 'a' + (playerCapturedIndex % 8); // Cycle through a-h
-            float capturedRank = 9.0f; // Rank 9 for player's pieces
-            playerCapturedIndex++;
-
-            // Find the player's captured piece in cTModelMap
-            for (auto& entry : cTModelMap) {
-                if (entry.id == capturedPieceID && entry.location == destination) {
-                    std::string capturedPosition = std::string(1, capturedFile) + std::to_string(static_cast<int>(capturedRank));
-                    entry.location = capturedPosition;
-
-                    // Update the 3D position
-                    entry.position.tPos.x = (capturedFile - 'a') * CHESS_BOX_SIZE - 3.5f * CHESS_BOX_SIZE;
-                    entry.position.tPos.y = (capturedRank - 1) * CHESS_BOX_SIZE - 3.5f * CHESS_BOX_SIZE;
+    };
 
+    chessSessionLogEntry entry;
+    while (!stopped && log.next(entry)) {
+        if (entry.type == SESSION_LOG_COMMAND) {
+            if (pending) {
+                // No state recorded (the recording ended inside the command)
+                replayCommand(NULL);
+                if (stopped) {
                     break;
                 }
             }
-        }
+            if (!started) {
+                firstUs = entry.timeUs;
+                started = true;
+            }
+            line.assign(entry.data, entry.length);
+            pendingUs = entry.timeUs;
+            pending = true;
+        }
+        else if (entry.type == SESSION_LOG_ENGINE_REPLY && pending) {
+            engine.queueReply(std::string(entry.data, entry.length), replayTime(entry.timeUs));
+        }
+        else if (entry.type == SESSION_LOG_STATE && pending && entry.length == sizeof(chessSessionLogState)) {
+            chessSessionLogState expected;
+            memcpy(&expected, entry.data, sizeof(expected));
+            replayCommand(&expected);
+        }
+    }
+    if (pending && !stopped) {
+        replayCommand(NULL);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - origin).count();
+    std::cout.flush();
+
+    // Report on stderr, next to the transcript on stdout
+    std::cerr << "Replay " << logPath << ": " << commands << " commands (" << invalid << " invalid) in "
+        << seconds << " s, " << (seconds > 0.0 ? commands / seconds : 0.0) << " commands/s\n"
+        << "Engine: " << engine.getSearches() << " searches, " << engine.getMissingReplies()
+        << " without a recorded reply, " << unusedReplies << " recorded replies unused\n"
+        << "Divergent boards: " << divergent;
+    if (divergent > 0) {
+        std::cerr << " (first after command " << firstDivergent << ")";
+    }
+    std::cerr << "\nLatency (us)   p50      p90      p99      max\n";
+    const ECE_Histogram* histograms[] = { &replayUs, &recordedUs };
+    const char* names[] = { "  replay  ", "  recorded" };
+    for (int i = 0; i < 2; ++i) {
+        char row[128];
+        snprintf(row, sizeof(row), "%s %8llu %8llu %8llu %8llu\n", names[i],
+            static_cast<unsigned long long>(histograms[i]->percentile(0.50)),
+            static_cast<unsigned long long>(histograms[i]->percentile(0.90)),
+            static_cast<unsigned long long>(histograms[i]->percentile(0.99)),
+            static_cast<unsigned long long>(histograms[i]->getMax()));
+        std::cerr << row;
+    }
+    std::cerr.flush();
+    return divergent == 0 ? 0 : 1;
+}
 
-        // Debug: Piece captured
-        std::cout << "Captured piece: " << capturedPieceID << " relocated to edge of the board.\n";
+// Append the current game to the game archive
+void archiveCurrentGame() {
+    chessGameRecord& gameRecord = gameSession.gameRecord;
+    if (gameRecord.size() == 0) {
+        return;
     }
-
-    // Update board state
-    if (promotionPiece != '\0') {
-        // Handle promotion (update the piece ID)
-        std::string promotedID;
-        switch (promotionPiece) {
-        case 'q': promotedID = "REGINA2"; break; // Queen
-        case 'r': promotedID = "TORRE3"; break;  // Rook
-        case 'b': promotedID = "ALFIERE3"; break; // Bishop
-        case 'n': promotedID = "Object3"; break;  // Knight
-        default: std::cerr << "Invalid promotion piece: " << promotionPiece << "\n"; return;
-        }
-        boardState[destination] = promotedID;
-        std::cout << "Pawn promoted to " << promotedID << " at " << destination << "\n";
+    // The writer appends to the files the reader maps
+    gameArchive.close();
+    chessGameArchiveWriter archive;
+    uint64_t gameId;
+    gameRecord.endTime = static_cast<uint32_t>(time(NULL));
+    if (archive.open(GAME_ARCHIVE_BASE) && archive.append(gameRecord, gameId)) {
+        std::cout << "Game saved as #" << gameId << std::endl;
     }
     else {
-        boardState[destination] = pieceID;
-    }
-    boardState.erase(source);
-
-
-    // Update the piece's position in cTModelMap
-    for (auto& entry : cTModelMap) {
-        if (entry.location == source) {
-            entry.location = destination;
-            entry.position.tPos.x = (destination[0] - 'a') * CHESS_BOX_SIZE - 3.5f * CHESS_BOX_SIZE;
-            entry.position.tPos.y = (destination[1] - '1') * CHESS_BOX_SIZE - 3.5f * CHESS_BOX_SIZE;
-            break;
-        }
-    }
-
-    // Update the position in gchessComponents
-    for (auto& component : gchessComponents) {
-        if (component.getComponentID() == pieceID) {
-            tPosition newPos = {
-                1, 0, 90.f, {1, 0, 0}, glm::vec3(CPSCALE),
-                {(destination[0] - 'a') * CHESS_BOX_SIZE - 3.5f * CHESS_BOX_SIZE,
-                 (destination[1] - '1') * CHESS_BOX_SIZE - 3.5f * CHESS_BOX_SIZE, PHEIGHT} };
-            component.storePosition(newPos);
-            break;
-        }
+        std::cerr << "Cannot save the game to " << GAME_ARCHIVE_BASE << std::endl;
     }
 }
 
-// Match the input string with the operations needed to be done
-void processCommand(const std::string& command, ECE_ChessEngine& engine) {
-    std::istringstream iss(command);
-    std::string action;
-    iss >> action;
-
-    if (action == "move") {
-        std::string move;
-        iss >> move;
-
-        // Save current board state in case we need to revert
-        auto previousBoardState = boardState;
-        auto previousCTModelMap = cTModelMap;
-        auto previousMoveHistory = moveHistory;
-
-        // Validate and execute the user's move
-        if (validatemove(move, boardState, true)) {
-            executemove(move, boardState, cTModelMap, gchessComponents);
-
-            // Add the user's move to the move history
-            moveHistory.push_back(move);
-
-            // Construct the full move history string
-            std::string moveHistoryStr = "";
-            for (const auto& pastMove : moveHistory) {
-                if (moveHistoryStr == "")
-                    moveHistoryStr += pastMove;
-                else
-                    moveHistoryStr += (" " + pastMove);
-            }
-
-            // Send the move to the chess engine
-            engine.sendMove(moveHistoryStr);
-
-            // Get the engine's response
-            std::string engineMove;
-            if (engine.getResponseMove(engineMove)) {
-
-                // Validate the engine's move
-                if (validatemove(engineMove, boardState, false)) {
-                    moveHistory.push_back(engineMove);
-                    executemove(engineMove, boardState, cTModelMap, gchessComponents);
-                }
-                else {
-                    // Revert the board state and cTModelMap
-                    std::cerr << "Invalid command or move!!\n";
-                    boardState = previousBoardState;
-                    cTModelMap = previousCTModelMap;
-                    moveHistory = previousMoveHistory;
-                }
-            }
-            else {
-                // Revert the board state and cTModelMap
-                std::cerr << "Invalid command or move!!\n";
-                boardState = previousBoardState;
-                cTModelMap = previousCTModelMap;
-                moveHistory = previousMoveHistory;
-            }
-        }
-        else {
-            std::cout << "Invalid command or move!!" << std::endl;
-        }
-    }
-    else if (action == "camera") {
-        float theta, phi, r;
-        iss >> theta >> phi >> r;
-        if (r > 0.0f && validateCameraInput(theta, phi)) {
-            adjustCamera(theta, phi, r);
-        }
-        else {
-            std::cout << "Invalid command or move!!" << std::endl;
-        }
+// Print the archived games that reached the current position
+void printPositionGames(int listed) {
+    if (!positionIndex.isOpen()) {
+        std::cout << "No position index (" << POSITION_INDEX_FILE << "), build it with ECE_PositionIndex\n";
+        return;
     }
-    else if (action == "light") {
-        float theta, phi, r;
-        iss >> theta >> phi >> r;
-        if (r > 0.0f && validateLightInput(theta, phi)) {
-            adjustLight(theta, phi, r);
+    chessPosition position;
+    position.setFromMoveList(gameSession.gameRecord.uciMoves());
+
+    auto start = std::chrono::steady_clock::now();
+    const chessPositionIndexEntry* first;
+    const chessPositionIndexEntry* last;
+    positionIndex.find(position.zobristKey(), first, last);
+    std::vector<chessMoveStats> stats;
+    uint64_t games;
+    chessPositionIndex::moveStats(first, last, stats, games);
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "Position reached in " << games << " games (" << ms << " ms)\n";
+    for (const auto& move : stats) {
+        std::cout << "  " << position.toSan(move.move) << "\t" << move.games << " games\t+" << move.whiteWins
+            << " =" << move.draws << " -" << move.blackWins << "\t" << move.whiteScore() << "%\n";
+    }
+
+    // A few of the games themselves
+    uint32_t previousGame = 0;
+    for (const chessPositionIndexEntry* entry = first; entry != last && listed > 0; ++entry) {
+        const chessGameIndexEntry* game = gameArchive.entry(entry->gameId);
+        if ((entry != first && entry->gameId == previousGame) || game == NULL) {
+            continue;
         }
-        else {
-            std::cout << "Invalid command or move!!" << std::endl;
+        previousGame = entry->gameId;
+        listed--;
+        char date[16] = "?";
+        time_t startTime = game->startTime;
+        if (startTime != 0) {
+            strftime(date, sizeof(date), "%Y.%m.%d", gmtime(&startTime));
         }
+        std::cout << "  #" << entry->gameId << "  " << date << "  ply " << entry->ply() << " of " << game->plyCount
+            << "  " << chessGameRecord::resultText(game->result) << "\n";
     }
-    else if (action == "power") {
-        float power;
-        iss >> power;
-        if (power > 0.0f) {
-            LightPower = power;
+}
+
+// Show the live analysis lines in the window title (no allocation per frame)
+void updateAnalysisTitle(GLFWwindow* window, const LiveSnapshot& snapshot) {
+    static char title[1024];
+    int length = snprintf(title, sizeof(title), "%s", WINDOW_TITLE);
+    if (snapshot.lineCount > 0) {
+        length += snprintf(title + length, sizeof(title) - length, " | depth %d, %llu knps",
+            snapshot.lines[0].depth, static_cast<unsigned long long>(snapshot.lines[0].nps / 1000));
+    }
+    for (int i = 0; i < snapshot.lineCount && length < static_cast<int>(sizeof(title)); ++i) {
+        const LiveInfoLine& line = snapshot.lines[i];
+        // First five moves of each line, score from the side to move
+        if (line.isMate) {
+            length += snprintf(title + length, sizeof(title) - length, " | %d) #%d %.29s",
+                i + 1, line.score, line.pv);
         }
         else {
-            std::cout << "Invalid command or move!!" << std::endl;
+            length += snprintf(title + length, sizeof(title) - length, " | %d) %+.2f %.29s",
+                i + 1, line.score / 100.0, line.pv);
         }
     }
-    else if (action == "quit") {
-        std::cout << "Thanks for playing!" << std::endl;
-        exit(0);
-    }
-    else {
-        std::cout << "Invalid command or move!!" << std::endl;
-    }
+    glfwSetWindowTitle(window, title);
 }
 
 // Initialize chess pieces and chessboard
-void setupChessGame(tModelMap& cTModelMap, std::map<std::string, std::string>& boardState) {
-    // Add chessboard to the model map
-    cTModelMap.push_back({ "12951_Stone_Chess_Board",
-                          {1, 0, 0.f, {1, 0, 0}, glm::vec3(CBSCALE), {0.f, 0.f, PHEIGHT}} });
-
-    // Initialize first player's back rank
-    std::vector<std::pair<std::string, std::string>> backRankFirstPlayer = {
-        {"a1", "TORRE3"}, {"b1", "Object3"}, {"c1", "ALFIERE3"}, {"d1", "REGINA2"},
-        {"e1", "RE2"}, {"f1", "ALFIERE3"}, {"g1", "Object3"}, {"h1", "TORRE3"}
-    };
-
-    for (const auto& pair : backRankFirstPlayer) {
-        const std::string& position = pair.first;
-        const std::string& id = pair.second;
-
-        boardState[position] = id;
-        tPosition location = { 1, 0, 90.f, {1, 0, 0}, glm::vec3(CPSCALE),
-                             {-3.5f * CHESS_BOX_SIZE + (position[0] - 'a') * CHESS_BOX_SIZE,
-                              -3.5f * CHESS_BOX_SIZE,
-                              PHEIGHT} };
-        
-        struct ModelData newEle;
-        newEle.id = id;
-        newEle.location = position;
-        newEle.position = location;
-
-        cTModelMap.push_back(newEle);
-    }
-
-    // Initialize first player's pawns
-    for (char file = 'a'; file <= 'h'; ++file) {
-        std::string position = std::string(1, file) + "2";
-        std::string pawnID = "PEDONE13";
-        boardState[position] = pawnID;
-
-        tPosition location =   {1, 0, 90.f, {1, 0, 0}, glm::vec3(CPSCALE),
-                               {-3.5f * CHESS_BOX_SIZE + (file - 'a') * CHESS_BOX_SIZE,
-                                -2.5f * CHESS_BOX_SIZE,
-                                PHEIGHT}};
-
-        struct ModelData newEle;
-        newEle.id = pawnID;
-        newEle.location = position;
-        newEle.position = location;
-
-        cTModelMap.push_back(newEle);
-    }
-
-    // Initialize second player's back rank
-    std::vector<std::pair<std::string, std::string>> backRankSecondPlayer = {
-        {"a8", "TORRE02"}, {"b8", "Object02"}, {"c8", "ALFIERE02"}, {"d8", "REGINA01"},
-        {"e8", "RE01"}, {"f8", "ALFIERE02"}, {"g8", "Object02"}, {"h8", "TORRE02"}
-    };
-
-    for (const auto& pair : backRankSecondPlayer) {
-        const std::string& position = pair.first;
-        const std::string& id = pair.second;
-
-        boardState[position] = id;
-        tPosition location = { 1, 0, 90.f, {1, 0, 0}, glm::vec3(CPSCALE),
-                             {-3.5f * CHESS_BOX_SIZE + (position[0] - 'a') * CHESS_BOX_SIZE,
-                              3.5f * CHESS_BOX_SIZE,
-                             PHEIGHT} };
-
-        struct ModelData newEle;
-        newEle.id = id;
-        newEle.location = position;
-        newEle.position = location;
-
-        cTModelMap.push_back(newEle);
-    }
-
-    // Initialize second player's pawns
-    for (char file = 'a'; file <= 'h'; ++file) {
-        std::string position = std::string(1, file) + "7";
-        std::string pawnID = "PEDONE12";
-        boardState[position] = pawnID;
-
-        tPosition location = { 1, 0, 90.f, {1, 0, 0}, glm::vec3(CPSCALE),
-                               {-3.5f * CHESS_BOX_SIZE + (file - 'a') * CHESS_BOX_SIZE,
-                                2.5f * CHESS_BOX_SIZE,
-                                PHEIGHT} };
-
-        struct ModelData newEle;
-        newEle.id = pawnID;
-        newEle.location = position;
-        newEle.position = location;
-
-        cTModelMap.push_back(newEle);
-    }
+void setupChessGame() {
+    gameSession.reset();
 
     // Debug output for initialized pieces
     std::cout << "Initialized pieces in tModelMap:\n";
-    for (const auto& pair : cTModelMap) {
+    for (const auto& pair : gameSession.models) {
         const std::string& id = pair.id;
         const tPosition& data = pair.position;
 
@@ -7,7 +7,7 @@
 #include <GLFW/glfw3.h>
 
 
-GLuint loadBMP_custom(const char * imagepath){
+unsigned char * loadBMP_pixels(const char * imagepath, unsigned int & width, unsigned int & height){
 
 	printf("Reading image %s\n", imagepath);
 
@@ -15,7 +15,6 @@ GLuint loadBMP_custom(const char * imagepath){
 	unsigned char header[54];
 	unsigned int dataPos;
 	unsigned int imageSize;
-	unsigned int width, height;
 	// Actual RGB data
 	unsigned char * data;
 
@@ -24,7 +23,7 @@ GLuint loadBMP_custom(const char * imagepath){
 	if (!file){
 		printf("%s could not be opened. Are you in the right directory ? Don't forget to read the FAQ !\n", imagepath);
 		getchar();
-		return 0;
+		return NULL;
 	}
 
 	// Read the header, i.e. the 54 first bytes
@@ -33,17 +32,17 @@ GLuint loadBMP_custom(const char * imagepath){
 	if ( fread(header, 1, 54, file)!=54 ){ 
 		printf("Not a correct BMP file\n");
 		fclose(file);
-		return 0;
+		return NULL;
 	}
 	// A BMP files always begins with "BM"
 	if ( header[0]!='B' || header[1]!='M' ){
 		printf("Not a correct BMP file\n");
 		fclose(file);
-		return 0;
+		return NULL;
 	}
 	// Make sure this is a 24bpp file
-	if ( *(int*)&(header[0x1E])!=0  )         {printf("Not a correct BMP file\n");    fclose(file); return 0;}
-	if ( *(int*)&(header[0x1C])!=24 )         {printf("Not a correct BMP file\n");    fclose(file); return 0;}
+	if ( *(int*)&(header[0x1E])!=0  )         {printf("Not a correct BMP file\n");    fclose(file); return NULL;}
+	if ( *(int*)&(header[0x1C])!=24 )         {printf("Not a correct BMP file\n");    fclose(file); return NULL;}
 
 	// Read the information about the image
 	dataPos    = *(int*)&(header[0x0A]);
@@ -52,18 +51,32 @@ GLuint loadBMP_custom(const char * imagepath){
 	height     = *(int*)&(header[0x16]);
 
 	// Some BMP files are misformatted, guess missing information
-	if (imageSize==0)    imageSize=width*height*3; // 3 : one byte for each Red, Green and Blue component
+	// (rows are padded to 4 bytes)
+	if (imageSize==0)    imageSize=((width*3+3)&~3u)*height; // 3 : one byte for each Red, Green and Blue component
 	if (dataPos==0)      dataPos=54; // The BMP header is done that way
 
 	// Create a buffer
 	data = new unsigned char [imageSize];
 
 	// Read the actual data from the file into the buffer
+	fseek(file, dataPos, SEEK_SET);
 	fread(data,1,imageSize,file);
 
 	// Everything is in memory now, the file can be closed.
 	fclose (file);
 
+	return data;
+}
+
+GLuint loadBMP_custom(const char * imagepath){
+
+	unsigned int width, height;
+	// Actual RGB data
+	unsigned char * data = loadBMP_pixels(imagepath, width, height);
+	if (data == NULL){
+		return 0;
+	}
+
 	// Create one OpenGL texture
 	GLuint textureID;
 	glGenTextures(1, &textureID);
@@ -3,6 +3,9 @@
 
 // Load a .BMP file using our custom loader
 GLuint loadBMP_custom(const char * imagepath);
+// Read a 24bpp .BMP file's pixels (BGR, bottom row first, rows padded to 4 bytes),
+// NULL on failure; delete [] the result
+unsigned char * loadBMP_pixels(const char * imagepath, unsigned int & width, unsigned int & height);
 
 //// Since GLFW 3, glfwLoadTexture2D() has been removed. You have to use another texture loading library, 
 //// or do it yourself (just like loadBMP_custom and loadDDS)